@@ -0,0 +1,86 @@
+#include "BenchBase.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string_view>
+
+namespace {
+
+    constexpr auto minRunTime = std::chrono::milliseconds(200);
+    constexpr size_t maxIterations = size_t(1) << 34;
+
+    void divider(int len = 100, char c = '-')
+    {
+        std::cout << std::setw(len) << std::setfill(c) << "" << std::setfill(' ') << std::endl;
+    }
+
+    // runs the bench with growing iterations until the run is long enough, returns ns per iteration
+    double measure(BaseBench& bench, BenchState& result)
+    {
+        // warm up, this also lets benches set up their data before anything is timed
+        BenchState warmUp(1);
+        bench.run(warmUp);
+
+        size_t iterations = 1;
+        while (true)
+        {
+            BenchState state(iterations);
+            auto start = std::chrono::steady_clock::now();
+            bench.run(state);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            if (elapsed >= minRunTime || iterations >= maxIterations)
+            {
+                result = state;
+                return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+            }
+            // aim a bit above the minimal time so the next run is most likely the last one
+            auto ns = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            auto target = std::chrono::duration_cast<std::chrono::nanoseconds>(minRunTime).count() * 1.2;
+            iterations = std::min<size_t>(maxIterations, std::max<size_t>(iterations * 2, iterations * target / ns));
+        }
+    }
+}
+
+// usage: wal-bench [filter] [--name value ...], filter matches a substring of "suite.name"
+int main(int argc, char** argv)
+{
+    static const std::string prefix{"[~]"};
+    std::string_view filter;
+    for (int i=1; i<argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--") && i + 1 < argc) { BenchArgs::values[std::string(arg.substr(2))] = argv[++i]; }
+        else { filter = arg; }
+    }
+
+    for (const auto& [suite, benches] : BenchCollection::suites)
+    {
+        bool printedSuite = false;
+        for (const auto& bench : benches)
+        {
+            std::string fullname = suite + "." + bench->getName();
+            if (!filter.empty() && fullname.find(filter) == std::string::npos) { continue; }
+            if (!printedSuite) { divider(); printedSuite = true; }
+
+            BenchState state(0);
+            double ns = 0;
+            try { ns = measure(*bench, state); }
+            catch (std::exception& e)
+            {
+                std::cout << prefix << fullname << " failed: " << e.what() << std::endl;
+                return 1;
+            }
+
+            std::cout << prefix << std::left << std::setw(50) << fullname << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(12) << ns << " ns/op";
+            if (state.frames() > 0) { std::cout << std::setw(12) << (state.frames() * 1e6 / ns) << " k frames/s"; }
+            if (state.rows() > 0) { std::cout << std::setw(12) << (state.rows() * 1e6 / ns) << " k rows/s"; }
+            if (state.items() > 0) { std::cout << std::setw(12) << (state.items() * 1e3 / ns) << " M items/s"; }
+            if (state.bytes() > 0) { std::cout << std::setw(12) << (state.bytes() * 1e3 / ns) << " MB/s"; }
+            std::cout << std::endl;
+        }
+    }
+    divider(100,'=');
+    return 0;
+}
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////////
+// a poor man version of micro benchmarks in the style of the tests (TestBase.h)
+// every BENCH body gets a state to loop on, it's called with a growing amount
+// of iterations until it runs long enough to be measured
+/////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////// Define macros ///////////////////////////////////////////
+
+#define BENCH_CLS_NAME(suite,name) B_##suite##_##name
+
+#define BENCH(suite,name) class BENCH_CLS_NAME(suite,name) : public BaseBench \
+{\
+    public:\
+        std::string getSuite() const override {return #suite;}\
+        std::string getName() const override {return #name;}\
+        void run(BenchState& state) override;\
+    private:\
+        static BaseBench* ref;\
+};\
+\
+BaseBench* BENCH_CLS_NAME(suite,name)::ref = registerBench(new BENCH_CLS_NAME(suite,name)());\
+\
+void BENCH_CLS_NAME(suite,name)::run(BenchState& state)
+
+////////////////////// Base classes //////////////////////////////////////////////
+
+// keeps the compiler from dropping a computation which result is never used
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchState
+{
+    public:
+        explicit BenchState(size_t iterations): _iterations(iterations) {}
+
+        size_t iterations() const { return _iterations; }
+
+        // what one iteration processed, used to print the rates
+        void setItemsPerIteration(size_t items) { _items = items; }
+        void setBytesPerIteration(size_t bytes) { _bytes = bytes; }
+        void setFramesPerIteration(size_t frames) { _frames = frames; }
+        void setRowsPerIteration(size_t rows) { _rows = rows; }
+
+        size_t items() const { return _items; }
+        size_t bytes() const { return _bytes; }
+        size_t frames() const { return _frames; }
+        size_t rows() const { return _rows; }
+
+    private:
+        size_t _iterations;
+        size_t _items = 0;
+        size_t _bytes = 0;
+        size_t _frames = 0;
+        size_t _rows = 0;
+};
+
+// the --name value options given to wal-bench, for benches that can be configured
+struct BenchArgs
+{
+    public:
+        static inline std::map<std::string, std::string> values{};
+
+        static std::string get(const std::string& name, const std::string& defaultValue)
+        {
+            auto it = values.find(name);
+            return it == values.end() ? defaultValue : it->second;
+        }
+};
+
+struct BaseBench
+{
+    public:
+        BaseBench() = default;
+        virtual ~BaseBench() = default;
+        virtual std::string getSuite() const = 0;
+        virtual std::string getName() const = 0;
+        virtual void run(BenchState& state) = 0;
+};
+
+struct BenchCollection {
+    public:
+        using Suites = std::map<std::string, std::vector< std::unique_ptr<BaseBench> > >;
+        static inline Suites suites{};
+};
+
+inline BaseBench* registerBench(BaseBench* bench)
+{
+    BenchCollection::suites[bench->getSuite()].emplace_back(bench);
+    return bench;
+}
@@ -0,0 +1,123 @@
+#include "BenchBase.h"
+#include "Converters/Endian.h"
+#include "Utils/FixedRuntimeArray.h"
+#include <array>
+#include <string>
+#include <stdexcept>
+
+// compares the byteswap based loads against the shift table / byte loop conversion
+// the converters used before, both decode the same page sized buffer value by value
+
+namespace {
+
+    constexpr size_t bufferSize = 4096;
+
+    const std::array<uint8_t, bufferSize>& buffer()
+    {
+        static const auto data = []{
+            std::array<uint8_t, bufferSize> data{};
+            uint32_t seed = 0x9e3779b9;
+            for (auto& b : data) { seed = seed * 1664525 + 1013904223; b = static_cast<uint8_t>(seed >> 24); }
+            return data;
+        }();
+        return data;
+    }
+
+    // the previous implementation, copied here as the baseline
+    namespace legacy {
+
+        template<typename TYPE, std::array<int,sizeof(TYPE)> MV_ARRAY>
+        TYPE fromBig(const TYPE& value)
+        {
+            TYPE ret = 0;
+            TYPE mask = ret | 0xFF;
+            for (size_t i=0; i<MV_ARRAY.size(); ++i)
+            {
+                ret |= (MV_ARRAY[i] > 0 ? (mask & value) << MV_ARRAY[i] : (mask & value) >> (MV_ARRAY[i]*-1));
+                mask = mask << 8;
+            }
+            return ret;
+        }
+
+        template<size_t SIZE, typename RET>
+        RET toThis(const wal::FixedRuntimeArray<uint8_t>& data)
+        {
+            if (data.size() < SIZE )
+            {
+                std::string message = "Unable to convert data vector, not enough data";
+                message += " from " + std::to_string(data.size()) + " bytes";
+                throw std::runtime_error(message);
+            }
+
+            RET v = 0;
+            for (size_t i=0; i < SIZE; ++i)
+            {
+                RET c = data[i];
+                v |= c << i*8;
+            }
+            return v;
+        }
+
+        template<typename TYPE, size_t SIZE>
+        TYPE load(const uint8_t* data)
+        {
+            // the old readers copied every value out before converting it
+            wal::FixedRuntimeArray<uint8_t> copy(SIZE);
+            for (size_t i=0; i<SIZE; ++i) { copy[i] = data[i]; }
+            auto v = toThis<SIZE, TYPE>(copy);
+            if constexpr (sizeof(TYPE) == 2) { return fromBig<TYPE, {8,-8}>(v); }
+            if constexpr (sizeof(TYPE) == 4) { return fromBig<TYPE, {24,8,-8,-24}>(v); }
+            if constexpr (sizeof(TYPE) == 8) { return fromBig<TYPE, {56,40,24,8,-8,-24,-40,-56}>(v); }
+        }
+    }
+
+    template<typename TYPE, size_t SIZE, bool LEGACY>
+    void decodeAll(BenchState& state)
+    {
+        const uint8_t* data = buffer().data();
+        constexpr size_t count = bufferSize / SIZE;
+        state.setItemsPerIteration(count);
+        state.setBytesPerIteration(count * SIZE);
+
+        for (size_t it=0; it<state.iterations(); ++it)
+        {
+            TYPE sum = 0;
+            for (size_t i=0; i<count; ++i)
+            {
+                if constexpr (LEGACY) { sum += legacy::load<TYPE, SIZE>(data + i*SIZE); }
+                else { sum += wal::converters::Endian::loadBig<TYPE, SIZE>(data + i*SIZE); }
+            }
+            doNotOptimize(sum);
+        }
+    }
+}
+
+BENCH(Converters, Legacy16) { decodeAll<uint16_t, 2, true>(state); }
+BENCH(Converters, LoadBig16) { decodeAll<uint16_t, 2, false>(state); }
+
+BENCH(Converters, Legacy24) { decodeAll<uint32_t, 3, true>(state); }
+BENCH(Converters, LoadBig24) { decodeAll<uint32_t, 3, false>(state); }
+
+BENCH(Converters, Legacy32) { decodeAll<uint32_t, 4, true>(state); }
+BENCH(Converters, LoadBig32) { decodeAll<uint32_t, 4, false>(state); }
+
+BENCH(Converters, Legacy48) { decodeAll<uint64_t, 6, true>(state); }
+BENCH(Converters, LoadBig48) { decodeAll<uint64_t, 6, false>(state); }
+
+BENCH(Converters, Legacy64) { decodeAll<uint64_t, 8, true>(state); }
+BENCH(Converters, LoadBig64) { decodeAll<uint64_t, 8, false>(state); }
+
+BENCH(Converters, LoadBigFloat64)
+{
+    const uint8_t* data = buffer().data();
+    constexpr size_t count = bufferSize / sizeof(double);
+    state.setItemsPerIteration(count);
+    state.setBytesPerIteration(count * sizeof(double));
+
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        double sum = 0;
+        for (size_t i=0; i<count; ++i) { sum += wal::converters::Endian::loadBigFloat64(data + i*sizeof(double)); }
+        doNotOptimize(sum);
+    }
+}
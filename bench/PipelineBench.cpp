@@ -0,0 +1,285 @@
+#include "BenchBase.h"
+#include "WalGenerator.h"
+#include "Utils/Log.h"
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/BTreeReader.h"
+#include "Readers/FreeSpaceCarver.h"
+#include "Readers/RecordHeaderReader.h"
+#include "Formatters/Factory.h"
+#include "Formatters/CSVFormatter.h"
+#include "Formatters/SchemaFormatter.h"
+#include "Formatters/Input/StringInput.h"
+#include "Pipeline/FrameDecoder.h"
+#include "Writers/OutputWriter.h"
+#include <iostream>
+#include <unistd.h>
+
+// throughput of every stage of the pipeline on a generated WAL. the generator is configured with
+//   --page-size N --frames N --index-ratio R --columns itrbn --string-length MIN:MAX
+//   --invalid-salt-ratio R --seed N
+// and --write-wal PATH keeps the generated file (to run wal-parser on it)
+
+namespace {
+
+    using namespace wal;
+
+    // a writer that only counts, so the formatting benches don't measure the output
+    class CountingWriter : public writers::OutputWriter
+    {
+        public:
+            void write(std::string&& row) override { _rows++; _bytes += row.size(); }
+            void flush() override {}
+
+            size_t rows() const { return _rows; }
+
+        private:
+            size_t _rows = 0;
+            size_t _bytes = 0;
+    };
+
+    struct GeneratedWal
+    {
+        bench::WalGenerator generator;
+        std::filesystem::path path;
+        bool keep;
+        std::unique_ptr<MappedFile> file;
+        std::unique_ptr<readers::WalFrameReader> reader;
+        std::vector<readers::RecordHeaderReader::RecordData> tableRecords; // views into the mapping
+
+        static GeneratedWal& get()
+        {
+            static GeneratedWal instance(config());
+            return instance;
+        }
+
+        ~GeneratedWal()
+        {
+            reader.reset();
+            file.reset();
+            if (!keep) { std::filesystem::remove(path); }
+        }
+
+    private:
+        explicit GeneratedWal(const bench::WalGenerator::Config& config):
+            generator(config),
+            keep(!BenchArgs::get("write-wal", "").empty())
+        {
+            Log::get().setLogLevel(Log::ReportLevel::None);
+
+            path = keep ? std::filesystem::path(BenchArgs::get("write-wal", "")) :
+                          std::filesystem::temp_directory_path() / ("wal-bench-" + std::to_string(::getpid()) + ".db-wal");
+            generator.writeTo(path);
+
+            const auto& stats = generator.stats();
+            std::cout << "[~]generated " << stats.frames << " frames, " << stats.tableRows << " table rows, "
+                      << stats.indexRows << " index rows, " << stats.invalidFrames << " invalid frames" << std::endl;
+
+            file = std::make_unique<MappedFile>(path, MappedFile::AccessHint::Sequential);
+            reader = std::make_unique<readers::WalFrameReader>(*file);
+            if (!reader->readHeader()) { throw std::runtime_error("generated WAL header is invalid"); }
+
+            // the records of all table pages, for the formatting benches
+            forEachCell([this](readers::RecordHeaderReader& record) { tableRecords.push_back(record.headerData()); }, false);
+        }
+
+        static bench::WalGenerator::Config config()
+        {
+            bench::WalGenerator::Config config;
+            config.pageSize = static_cast<uint32_t>(std::stoul(BenchArgs::get("page-size", std::to_string(config.pageSize))));
+            config.frames = std::stoul(BenchArgs::get("frames", std::to_string(config.frames)));
+            config.indexRatio = std::stod(BenchArgs::get("index-ratio", std::to_string(config.indexRatio)));
+            config.invalidSaltRatio = std::stod(BenchArgs::get("invalid-salt-ratio", std::to_string(config.invalidSaltRatio)));
+            config.seed = std::stoull(BenchArgs::get("seed", std::to_string(config.seed)));
+
+            auto columns = BenchArgs::get("columns", "");
+            if (!columns.empty()) { config.columns = bench::WalGenerator::parseColumns(columns); }
+
+            auto lengths = BenchArgs::get("string-length", "");
+            if (!lengths.empty())
+            {
+                auto colon = lengths.find(':');
+                config.minStringLength = std::stoul(lengths.substr(0, colon));
+                config.maxStringLength = colon == std::string::npos ? config.minStringLength : std::stoul(lengths.substr(colon + 1));
+            }
+            return config;
+        }
+
+    public:
+        // decode every cell of the leaf pages, of both types when bothTypes is set and only the table ones otherwise
+        template<typename F>
+        void forEachCell(F&& onRecord, bool bothTypes) const
+        {
+            for (size_t i=0; i<reader->frameCount(); ++i)
+            {
+                auto frame = reader->frameAt(i);
+                auto it = frame.data;
+                readers::BTreeReader btree;
+                btree.readHeader(it);
+                btree.readPointerArray(it);
+                if (!bothTypes && btree.getBTreeNodeType() != types::BTreeNodePageType::leafTable) { continue; }
+
+                readers::RecordHeaderReader record(btree.getBTreeNodeType());
+                for (auto pointer : btree.getPointerArray())
+                {
+                    auto cell = frame.data + pointer;
+                    record.read(cell);
+                    onRecord(record);
+                }
+            }
+        }
+
+        size_t bytes() const { return file->size(); }
+    };
+
+    void formatAll(BenchState& state, formatters::Formatter& formatter)
+    {
+        auto& wal = GeneratedWal::get();
+        formatter.lenientMode();
+        formatter.prepare();
+        state.setRowsPerIteration(wal.tableRecords.size());
+
+        CountingWriter out;
+        std::string row;
+        for (size_t it=0; it<state.iterations(); ++it)
+        {
+            for (const auto& record : wal.tableRecords)
+            {
+                formatter.generateOutput(record, row);
+                out.write(std::move(row));
+            }
+        }
+        doNotOptimize(out.rows());
+    }
+
+    formatters::Formatter& formatter(int id, std::string input)
+    {
+        auto* formatter = formatters::Factory::instance().getFormatter(id);
+        formatter->setInput(std::make_unique<formatters::inputs::StringInput>(input));
+        return *formatter;
+    }
+}
+
+BENCH(Pipeline, FrameRead)
+{
+    auto& wal = GeneratedWal::get();
+    const size_t frames = wal.reader->frameCount();
+    state.setFramesPerIteration(frames); // only the frame headers are read, bytes/s would be meaningless
+
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        uint64_t sum = 0;
+        for (size_t i=0; i<frames; ++i)
+        {
+            auto frame = wal.reader->frameAt(i);
+            sum += frame.header.pageNumber() + frame.header.salt1() + *frame.data;
+        }
+        doNotOptimize(sum);
+    }
+}
+
+BENCH(Pipeline, FrameChecksum)
+{
+    auto& wal = GeneratedWal::get();
+    // the chain stops at the first frame with other salts
+    const size_t frames = wal.reader->validFrameCount();
+    state.setFramesPerIteration(frames);
+    state.setBytesPerIteration(frames * wal.reader->frameSize());
+
+    for (size_t it=0; it<state.iterations(); ++it) { doNotOptimize(wal.reader->validFrameCount()); }
+}
+
+BENCH(Pipeline, BTreeHeaderParse)
+{
+    auto& wal = GeneratedWal::get();
+    const size_t frames = wal.reader->frameCount();
+    state.setFramesPerIteration(frames);
+    state.setBytesPerIteration(wal.bytes());
+
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        size_t cells = 0;
+        for (size_t i=0; i<frames; ++i)
+        {
+            auto frame = wal.reader->frameAt(i);
+            auto data = frame.data;
+            readers::BTreeReader btree;
+            btree.readHeader(data);
+            btree.readPointerArray(data);
+            cells += btree.getPointerArray().size();
+        }
+        doNotOptimize(cells);
+    }
+}
+
+// the generated pages have no deleted cells, this is the cost of scanning the free space of every page
+BENCH(Pipeline, FreeSpaceCarve)
+{
+    auto& wal = GeneratedWal::get();
+    const size_t frames = wal.reader->frameCount();
+    state.setFramesPerIteration(frames);
+    state.setBytesPerIteration(wal.bytes());
+
+    std::vector<readers::FreeSpaceCarver::Candidate> found;
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        found.clear();
+        for (size_t i=0; i<frames; ++i)
+        {
+            auto frame = wal.reader->frameAt(i);
+            auto data = frame.data;
+            readers::BTreeReader btree;
+            btree.readHeader(data);
+            btree.readPointerArray(data);
+            readers::FreeSpaceCarver carver(btree.getBTreeNodeType());
+            carver.carve(frame.data.ptr(), frame.data.remaining(), 0, btree, found);
+        }
+        doNotOptimize(found.size());
+    }
+}
+
+BENCH(Pipeline, RecordDecode)
+{
+    auto& wal = GeneratedWal::get();
+    const auto& stats = wal.generator.stats();
+    state.setFramesPerIteration(wal.reader->frameCount());
+    state.setRowsPerIteration(stats.tableRows + stats.indexRows);
+    state.setBytesPerIteration(wal.bytes());
+
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        size_t columns = 0;
+        wal.forEachCell([&columns](readers::RecordHeaderReader& record) { columns += record.headerData().headerData.size(); }, true);
+        doNotOptimize(columns);
+    }
+}
+
+BENCH(Pipeline, CsvFormat)
+{
+    formatAll(state, formatter(formatters::CSVFormatter::id, GeneratedWal::get().generator.csvColumns()));
+}
+
+BENCH(Pipeline, SqlFormat)
+{
+    formatAll(state, formatter(formatters::SchemaFormatter::id, GeneratedWal::get().generator.schema()));
+}
+
+// everything together on a single thread, like wal-parser -j 1 --sql
+BENCH(Pipeline, DecodeToSql)
+{
+    auto& wal = GeneratedWal::get();
+    auto& sql = formatter(formatters::SchemaFormatter::id, wal.generator.schema());
+    sql.lenientMode();
+    sql.prepare();
+    pipeline::FrameDecoder decoder(*wal.reader, sql, {});
+    state.setFramesPerIteration(wal.reader->frameCount());
+    state.setRowsPerIteration(wal.generator.stats().tableRows);
+    state.setBytesPerIteration(wal.bytes());
+
+    for (size_t it=0; it<state.iterations(); ++it)
+    {
+        CountingWriter out;
+        for (size_t i=0; i<wal.reader->frameCount(); ++i) { decoder.decode(i, out); }
+        doNotOptimize(out.rows());
+    }
+}
@@ -0,0 +1,61 @@
+#include "BenchBase.h"
+#include "Converters/VarInt.h"
+#include <vector>
+
+// decoding the serial types of a record header one varint at a time vs the batch decoder
+
+namespace {
+
+    // a header like the ones of a wide table: mostly small ints and short strings (single bytes)
+    // with an occasional long text / blob column that needs a two byte serial type
+    std::vector<uint8_t> makeHeader(size_t columns)
+    {
+        std::vector<uint8_t> header;
+        for (size_t i=0; i<columns; ++i)
+        {
+            if (i % 13 == 12) { header.insert(header.end(), {0x83, 0x21}); }
+            else { header.push_back(static_cast<uint8_t>(i % 2 == 0 ? 1 + i % 6 : 13 + 2 * (i % 50))); }
+        }
+        return header;
+    }
+
+    void scalar(BenchState& state, size_t columns)
+    {
+        const auto header = makeHeader(columns);
+        state.setItemsPerIteration(columns);
+        state.setBytesPerIteration(header.size());
+
+        std::vector<uint64_t> values;
+        for (size_t it=0; it<state.iterations(); ++it)
+        {
+            values.clear();
+            for (size_t pos=0; pos<header.size();)
+            {
+                uint64_t value = 0;
+                pos += wal::converters::VarInt::readVarInt(header.data() + pos, header.size() - pos, value);
+                values.push_back(value);
+            }
+            doNotOptimize(values.data());
+        }
+    }
+
+    void batch(BenchState& state, size_t columns)
+    {
+        const auto header = makeHeader(columns);
+        state.setItemsPerIteration(columns);
+        state.setBytesPerIteration(header.size());
+
+        std::vector<uint64_t> values;
+        for (size_t it=0; it<state.iterations(); ++it)
+        {
+            wal::converters::VarInt::readVarInts(header.data(), header.size(), values);
+            doNotOptimize(values.data());
+        }
+    }
+}
+
+BENCH(VarInt, Scalar8Columns) { scalar(state, 8); }
+BENCH(VarInt, Batch8Columns) { batch(state, 8); }
+
+BENCH(VarInt, Scalar64Columns) { scalar(state, 64); }
+BENCH(VarInt, Batch64Columns) { batch(state, 64); }
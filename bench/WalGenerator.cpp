@@ -0,0 +1,311 @@
+#include "WalGenerator.h"
+#include "Readers/WalChecksum.h"
+#include "Readers/WalFrameReader.h"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace wal::bench;
+
+namespace {
+
+    constexpr size_t walHeaderSize = 32;
+    constexpr size_t frameHeaderSize = 24;
+    constexpr size_t btreeLeafHeaderSize = 8;
+    constexpr uint32_t walVersion = 3007000;
+    constexpr uint32_t firstPage = 2; // page 1 has the database header in front of it's btree header
+
+    void storeBig32(uint8_t* data, uint32_t value)
+    {
+        data[0] = value >> 24; data[1] = value >> 16; data[2] = value >> 8; data[3] = value;
+    }
+
+    void storeBig16(uint8_t* data, uint16_t value)
+    {
+        data[0] = value >> 8; data[1] = value;
+    }
+
+    void appendBig(std::vector<uint8_t>& out, uint64_t value, size_t bytes)
+    {
+        for (size_t i=bytes; i>0; --i) { out.push_back(static_cast<uint8_t>(value >> (8 * (i - 1)))); }
+    }
+
+    void appendVarInt(std::vector<uint8_t>& out, uint64_t value)
+    {
+        if (value > 0x00ffffffffffffffull)
+        {
+            // 8 bytes of 7 bits and a full last byte
+            uint64_t high = value >> 8;
+            for (int i=7; i>=0; --i) { out.push_back(static_cast<uint8_t>(0x80 | ((high >> (7 * i)) & 0x7f))); }
+            out.push_back(static_cast<uint8_t>(value));
+            return;
+        }
+        uint8_t buffer[9];
+        int n = 0;
+        do { buffer[n++] = value & 0x7f; value >>= 7; } while (value != 0);
+        while (n > 1) { out.push_back(buffer[--n] | 0x80); }
+        out.push_back(buffer[0]);
+    }
+
+    size_t varIntSize(uint64_t value)
+    {
+        std::vector<uint8_t> tmp;
+        appendVarInt(tmp, value);
+        return tmp.size();
+    }
+
+    // serial type and size of an integer, the smallest one that holds it like sqlite does
+    std::pair<uint64_t, size_t> integerType(int64_t value)
+    {
+        if (value == 0) { return {8, 0}; }
+        if (value == 1) { return {9, 0}; }
+        uint64_t u = value < 0 ? ~static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        if (u <= 0x7f) { return {1, 1}; }
+        if (u <= 0x7fff) { return {2, 2}; }
+        if (u <= 0x7fffff) { return {3, 3}; }
+        if (u <= 0x7fffffff) { return {4, 4}; }
+        if (u <= 0x7fffffffffffull) { return {5, 6}; }
+        return {6, 8};
+    }
+}
+
+WalGenerator::WalGenerator(const Config& config):
+    _config(config)
+{
+    if (_config.pageSize < 512 || _config.pageSize > 65536 || !std::has_single_bit(_config.pageSize))
+    {
+        throw std::invalid_argument("page size must be a power of 2 between 512 and 65536");
+    }
+    if (_config.columns.empty()) { throw std::invalid_argument("at least one column is needed"); }
+    if (_config.minStringLength > _config.maxStringLength) { throw std::invalid_argument("min string length is above the max"); }
+
+    // every record has to fit in a page without overflow pages (max local payload of an index cell is the lowest)
+    const size_t maxLocal = ((_config.pageSize - 12) * 64 / 255) - 23;
+    size_t worstRecord = 9 + 9 * (_config.columns.size() + 1) + 9;
+    for (auto column : _config.columns)
+    {
+        worstRecord += (column == Column::Text || column == Column::Blob) ? _config.maxStringLength : 8;
+    }
+    if (worstRecord > maxLocal)
+    {
+        throw std::invalid_argument("records don't fit in a page, lower the string length or the column count");
+    }
+    if (_config.framesPerCommit == 0) { _config.framesPerCommit = 1; }
+}
+
+uint64_t WalGenerator::next()
+{
+    // splitmix64, deterministic everywhere unlike the std distributions
+    uint64_t z = (_state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+size_t WalGenerator::nextInRange(size_t min, size_t max)
+{
+    return min + next() % (max - min + 1);
+}
+
+bool WalGenerator::chance(double ratio)
+{
+    return static_cast<double>(next() >> 11) * 0x1.0p-53 < ratio;
+}
+
+std::vector<uint8_t> WalGenerator::generate()
+{
+    _state = _config.seed;
+    _rowid = 0;
+    _stats = {};
+
+    const bool bigEndian = std::endian::native == std::endian::big;
+    const size_t frameSize = frameHeaderSize + _config.pageSize;
+    std::vector<uint8_t> wal(walHeaderSize + _config.frames * frameSize, 0);
+
+    const uint32_t salt1 = static_cast<uint32_t>(next());
+    const uint32_t salt2 = static_cast<uint32_t>(next());
+
+    // the magic's low bit is the byte order of the checksums, sqlite uses the native one
+    storeBig32(wal.data(), readers::WalFrameReader::magicLittleEndian | (bigEndian ? 1 : 0));
+    storeBig32(wal.data() + 4, walVersion);
+    storeBig32(wal.data() + 8, _config.pageSize);
+    storeBig32(wal.data() + 12, 0);
+    storeBig32(wal.data() + 16, salt1);
+    storeBig32(wal.data() + 20, salt2);
+    auto checksum = readers::WalChecksum::compute(wal.data(), 24, bigEndian, {});
+    storeBig32(wal.data() + 24, checksum.s1);
+    storeBig32(wal.data() + 28, checksum.s2);
+
+    // the database grows by a page every few frames, so pages get rewritten like in a real WAL
+    uint32_t databaseSize = firstPage;
+    for (size_t i=0; i<_config.frames; ++i)
+    {
+        uint8_t* frame = wal.data() + walHeaderSize + i * frameSize;
+        uint8_t* page = frame + frameHeaderSize;
+
+        if (i % 3 == 0) { ++databaseSize; }
+        const uint32_t pageNumber = static_cast<uint32_t>(nextInRange(firstPage, databaseSize));
+        const bool commit = (i + 1) % _config.framesPerCommit == 0 || i + 1 == _config.frames;
+
+        buildPage(page, chance(_config.indexRatio));
+
+        const bool invalid = chance(_config.invalidSaltRatio);
+        if (invalid) { ++_stats.invalidFrames; }
+
+        storeBig32(frame, pageNumber);
+        storeBig32(frame + 4, commit ? databaseSize : 0);
+        storeBig32(frame + 8, invalid ? salt1 ^ 0x5a5a5a5a : salt1);
+        storeBig32(frame + 12, salt2);
+        checksum = readers::WalChecksum::compute(frame, 8, bigEndian, checksum);
+        checksum = readers::WalChecksum::compute(page, _config.pageSize, bigEndian, checksum);
+        storeBig32(frame + 16, checksum.s1);
+        storeBig32(frame + 20, checksum.s2);
+        ++_stats.frames;
+    }
+    return wal;
+}
+
+void WalGenerator::buildPage(uint8_t* page, bool index)
+{
+    // cells are written from the end of the page backwards, the pointer array grows after the header
+    size_t contentStart = _config.pageSize;
+    uint16_t cellCount = 0;
+    while (true)
+    {
+        _cell.clear();
+        appendRecord(_cell, index);
+        const size_t pointersEnd = btreeLeafHeaderSize + (cellCount + 1) * sizeof(uint16_t);
+        if (contentStart < _cell.size() || contentStart - _cell.size() < pointersEnd) { break; }
+
+        contentStart -= _cell.size();
+        std::memcpy(page + contentStart, _cell.data(), _cell.size());
+        storeBig16(page + btreeLeafHeaderSize + cellCount * sizeof(uint16_t), static_cast<uint16_t>(contentStart));
+        ++cellCount;
+        ++(index ? _stats.indexRows : _stats.tableRows);
+    }
+
+    page[0] = index ? 0x0a : 0x0d;
+    storeBig16(page + 1, 0); // no free blocks
+    storeBig16(page + 3, cellCount);
+    storeBig16(page + 5, static_cast<uint16_t>(contentStart)); // 65536 wraps to 0 like in sqlite
+    page[7] = 0;
+}
+
+void WalGenerator::appendRecord(std::vector<uint8_t>& cell, bool index)
+{
+    std::vector<uint8_t> types;
+    std::vector<uint8_t> body;
+    const uint64_t rowid = ++_rowid;
+
+    auto addInteger = [&](int64_t value)
+    {
+        auto [type, size] = integerType(value);
+        appendVarInt(types, type);
+        appendBig(body, static_cast<uint64_t>(value), size);
+    };
+
+    // index records hold the first column and the rowid of the row they point to
+    const size_t columns = index ? 1 : _config.columns.size();
+    for (size_t c=0; c<columns; ++c)
+    {
+        switch (_config.columns[c])
+        {
+            case Column::Integer:
+            {
+                // spread over all the integer sizes
+                const int bits = static_cast<int>(nextInRange(0, 47));
+                addInteger(static_cast<int64_t>(next() >> (63 - bits)));
+            }
+            break;
+            case Column::Real:
+            {
+                double value = static_cast<double>(next() % 1000000) / 64.0;
+                appendVarInt(types, 7);
+                appendBig(body, std::bit_cast<uint64_t>(value), 8);
+            }
+            break;
+            case Column::Text:
+            case Column::Blob:
+            {
+                const bool text = Column::Text == _config.columns[c];
+                const size_t length = nextInRange(_config.minStringLength, _config.maxStringLength);
+                appendVarInt(types, (text ? 13 : 12) + 2 * length);
+                for (size_t i=0; i<length; ++i)
+                {
+                    body.push_back(static_cast<uint8_t>(text ? 'a' + next() % 26 : next()));
+                }
+            }
+            break;
+            case Column::Null:
+                appendVarInt(types, 0);
+            break;
+        }
+    }
+    if (index) { addInteger(static_cast<int64_t>(rowid)); }
+
+    // the header size counts itself
+    size_t headerSize = types.size() + 1;
+    while (types.size() + varIntSize(headerSize) != headerSize) { headerSize = types.size() + varIntSize(headerSize); }
+
+    const uint64_t payloadSize = headerSize + body.size();
+    appendVarInt(cell, payloadSize);
+    if (!index) { appendVarInt(cell, rowid); }
+    appendVarInt(cell, headerSize);
+    cell.insert(cell.end(), types.begin(), types.end());
+    cell.insert(cell.end(), body.begin(), body.end());
+}
+
+void WalGenerator::writeTo(const std::filesystem::path& path)
+{
+    auto wal = generate();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(wal.data()), wal.size()))
+    {
+        throw std::runtime_error("Failed to write generated WAL to " + path.string());
+    }
+}
+
+std::string WalGenerator::schema() const
+{
+    std::string schema = "CREATE TABLE bench (";
+    for (size_t c=0; c<_config.columns.size(); ++c)
+    {
+        if (c > 0) { schema += ", "; }
+        schema += "c" + std::to_string(c) + " ";
+        switch (_config.columns[c])
+        {
+            case Column::Integer: schema += "INTEGER"; break;
+            case Column::Real: schema += "REAL"; break;
+            case Column::Text: schema += "TEXT"; break;
+            case Column::Blob: schema += "BLOB"; break;
+            case Column::Null: schema += "INTEGER"; break;
+        }
+    }
+    return schema + ");";
+}
+
+std::string WalGenerator::csvColumns() const
+{
+    std::string columns;
+    for (size_t c=0; c<_config.columns.size(); ++c)
+    {
+        if (c > 0) { columns += ","; }
+        columns += "c" + std::to_string(c);
+    }
+    return columns;
+}
+
+std::vector<WalGenerator::Column> WalGenerator::parseColumns(const std::string& columns)
+{
+    std::vector<Column> result;
+    for (char c : columns)
+    {
+        switch (c)
+        {
+            case 'i': case 'r': case 't': case 'b': case 'n': result.push_back(static_cast<Column>(c)); break;
+            default: throw std::invalid_argument(std::string("unknown column type '") + c + "', expected one of i,r,t,b,n");
+        }
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <filesystem>
+#pragma once
+
+namespace wal::bench {
+
+    // builds a synthetic but well formed WAL file: a valid header, frames with a valid checksum chain
+    // and leaf table / leaf index pages filled with records of the configured column types.
+    // the output only depends on the config (and it's seed), so runs can be compared with each other
+    class WalGenerator
+    {
+        public:
+            enum class Column : char
+            {
+                Integer = 'i',
+                Real = 'r',
+                Text = 't',
+                Blob = 'b',
+                Null = 'n'
+            };
+
+            struct Config
+            {
+                uint32_t pageSize = 4096;
+                size_t frames = 2000;
+                double indexRatio = 0.2;        // part of the pages that are leaf index pages
+                std::vector<Column> columns = { Column::Integer, Column::Text, Column::Integer, Column::Real, Column::Blob };
+                size_t minStringLength = 4;     // length of text & blob columns
+                size_t maxStringLength = 32;
+                double invalidSaltRatio = 0.0;  // part of the frames that get salts of another WAL generation
+                size_t framesPerCommit = 10;
+                uint64_t seed = 1;
+            };
+
+            struct Stats
+            {
+                size_t frames = 0;
+                size_t tableRows = 0;
+                size_t indexRows = 0;
+                size_t invalidFrames = 0;
+            };
+
+            explicit WalGenerator(const Config& config);
+            ~WalGenerator() = default;
+
+            // generate the whole file in memory
+            std::vector<uint8_t> generate();
+
+            void writeTo(const std::filesystem::path& path);
+
+            // counts of the last generate()
+            const Stats& stats() const { return _stats; }
+
+            // a create table statement matching the columns, for the sql formatter
+            std::string schema() const;
+
+            // column names for the csv formatter
+            std::string csvColumns() const;
+
+            // parse a column list like "itrbn" (see Column)
+            static std::vector<Column> parseColumns(const std::string& columns);
+
+        private:
+            void buildPage(uint8_t* page, bool index);
+            void appendRecord(std::vector<uint8_t>& cell, bool index);
+            uint64_t next();
+            size_t nextInRange(size_t min, size_t max);
+            bool chance(double ratio);
+
+            Config _config;
+            Stats _stats;
+            uint64_t _state = 0;
+            uint64_t _rowid = 0;
+            std::vector<uint8_t> _cell;
+    };
+}
@@ -1,23 +1,52 @@
 #include <iostream>
-#include <fstream>
 #include <filesystem>
 #include <functional>
 #include <unordered_map>
 #include <vector>
-#include <set>
 #include <optional>
+#include <numeric>
+#include <sstream>
+#include <cctype>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <csignal>
+#include <thread>
 #include "Converters/Endian.h"
 #include "Utils/Log.h"
 #include "Utils/FixedRuntimeArray.h"
+#include "Utils/MappedFile.h"
+#include "Utils/FileWatcher.h"
+#include "Utils/Stats.h"
+#include "Utils/Trace.h"
 #include "Readers/RecordHeaderReader.h"
 #include "Readers/BTreeReader.h"
 #include "Readers/WalHeaderReader.h"
 #include "Readers/FrameHeader.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/WalFollower.h"
+#include "Readers/WalPageMap.h"
+#include "Readers/PageSource.h"
+#include "Readers/TableMap.h"
+#include "Readers/FrameIndex.h"
 #include "Formatters/Factory.h"
 #include "Formatters/SchemaFormatter.h"
 #include "Formatters/CSVFormatter.h"
+#include "Formatters/DatabaseFormatter.h"
+#include "Formatters/TableFormatters.h"
+#include "Formatters/utils/Tokenizers.h"
 #include "Formatters/Input/FileInput.h"
 #include "Formatters/Input/StringInput.h"
+#include "Filters/WhereFilter.h"
+#include "Pipeline/FrameDecoder.h"
+#include "Pipeline/FramePipeline.h"
+#include "Pipeline/BatchRunner.h"
+#include "Writers/SortedWriter.h"
+#include "Writers/StreamWriter.h"
+#include "Writers/BatchInsertWriter.h"
+#ifdef WAL_HAS_SQLITE
+#include "Writers/DatabaseWriter.h"
+#endif
 #include "ArgParsing/ArgsParsing.h"
 
 #define EXIT_OK 0
@@ -26,13 +55,7 @@
 #define READ_ERR 3
 #define HEAD_READ_ERR 4
 #define MISSING_OPT_ERR 5
-
-inline bool isFrameWeakValid(const wal::readers::WalHeaderReader& header,
-                             const wal::readers::FrameHeader& frameHeader)
-{
-    return header.salt1() == frameHeader.salt1() &&
-           header.salt2() == frameHeader.salt2();
-}
+#define FORMAT_ERR 6
 
 inline void printWalHeader(const wal::readers::WalHeaderReader& header)
 {
@@ -44,10 +67,182 @@ inline void printWalHeader(const wal::readers::WalHeaderReader& header)
     wal::Log::get().debug() << "salt2: " << header.salt2();
 }
 
-inline void printFrameHeader(const wal::readers::FrameHeader& header)
+// parse the value of a numeric argument, value is kept as is if the argument wasn't given.
+// returns false if the value isn't a positive number
+inline bool getCountArg(wal::arg_parsing::ArgsParsing& args, const std::string& name, size_t& value)
+{
+    if ( !args.argExists(name) ) { return true; }
+    auto str = args.getArgValue<std::string>(name).value_or("");
+    size_t parsed = 0;
+    if ( !str.empty() && std::isdigit(str.front()) )
+    {
+        try { parsed = std::stoul(str); }
+        catch(const std::exception&) { parsed = 0; }
+    }
+    if ( parsed == 0 )
+    {
+        wal::Log::get().err() << "invalid value for " << name << ": " << str;
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// parse "A:B" (either side can be left out) or a single value when single is set, bounds are kept as is
+// if the argument wasn't given. values are signed like sqlite's rowids. returns false if the value isn't
+// a number or a valid range
+inline bool getRangeArg(wal::arg_parsing::ArgsParsing& args, const std::string& name, bool single, int64_t& min, int64_t& max)
+{
+    if ( !args.argExists(name) ) { return true; }
+    auto str = args.getArgValue<std::string>(name).value_or("");
+    auto parse = [](const std::string& text, int64_t& value) -> bool
+    {
+        const auto digits = text.starts_with('-') ? text.substr(1) : text;
+        if ( digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c){ return std::isdigit(c); }) ) { return false; }
+        try { value = std::stoll(text); }
+        catch(const std::exception&) { return false; }
+        return true;
+    };
+
+    bool valid = false;
+    const auto colon = str.find(':');
+    if ( single ) { valid = parse(str, min) && parse(str, max); }
+    else if ( std::string::npos != colon && str.size() > 1 )
+    {
+        const auto from = str.substr(0, colon);
+        const auto to = str.substr(colon + 1);
+        valid = (from.empty() || parse(from, min)) && (to.empty() || parse(to, max)) && min <= max;
+    }
+    if ( !valid ) { wal::Log::get().err() << "invalid value for " << name << ": " << str; }
+    return valid;
+}
+
+// pick the formatter of the output options & prepare it, returns EXIT_OK or the code to exit with
+inline int setupFormatter(wal::arg_parsing::ArgsParsing& args, bool routeTables, bool toDatabase,
+                          int& formatterId, wal::formatters::Formatter*& formatter, std::string& preamble)
+{
+    formatterId = wal::formatters::CSVFormatter::id;
+    std::unique_ptr<wal::formatters::inputs::InputType> formatterInput = nullptr;
+
+    if ( routeTables )
+    {
+        // every table gets it's own formatter, this one only writes the comments
+        formatterId = wal::formatters::SchemaFormatter::id;
+    }
+    else if ( args.argExists("--csv") )
+    {
+        formatterId = wal::formatters::CSVFormatter::id;
+        auto csvCols = args.getArgValue<std::string>("--csv");
+        if (csvCols)
+        {
+            formatterInput = std::make_unique<wal::formatters::inputs::StringInput>(csvCols.value());
+        }
+    }
+    else if ( args.argExists("--sql") )
+    {
+        // the database gets the raw values, not sql text
+        formatterId = toDatabase ? wal::formatters::DatabaseFormatter::id : wal::formatters::SchemaFormatter::id;
+        auto schemaFile = args.getArgValue<std::string>("--sql");
+        if (schemaFile)
+        {
+            formatterInput = std::make_unique<wal::formatters::inputs::FileInput>(schemaFile.value());
+        }
+    }
+
+    formatter = wal::formatters::Factory::instance().getFormatter(formatterId);
+
+    formatter->lenientMode();
+    if ( args.argExists("--strict") ) { formatter->strictMode(); }
+
+    if ( nullptr == formatterInput && !routeTables )
+    {
+        wal::Log::get().err() << "Didn't get any option: --csv, --sql, --tables";
+        return MISSING_OPT_ERR;
+    }
+    if ( nullptr != formatterInput ) { formatter->setInput(std::move(formatterInput)); }
+
+    if ( args.argExists("--columns") )
+    {
+        if ( routeTables )
+        {
+            wal::Log::get().err() << "--columns can't be used with --tables, every table has other columns";
+            return ARG_ERR;
+        }
+        std::vector<std::string> columns;
+        wal::formatters::tokenizers::split(args.getArgValue<std::string>("--columns").value_or(""), ",", [&columns](const std::string& part){
+            auto first = part.find_first_not_of(' ');
+            if (std::string::npos != first) { columns.push_back(part.substr(first, part.find_last_not_of(' ') - first + 1)); }
+            return true;
+        });
+        formatter->setProjection(std::move(columns));
+    }
+
+    try
+    {
+        preamble = formatter->prepare();
+    }
+    catch(const wal::formatters::Formatter::FormatterException& e)
+    {
+        wal::Log::get().err() << "Failed to parse formatter input due to: " << e.what();
+        return FORMAT_ERR;
+    }
+    return EXIT_OK;
+}
+
+// compile --where against the columns of the prepared formatter, returns EXIT_OK or the code to exit with
+inline int setupWhereFilter(wal::arg_parsing::ArgsParsing& args, bool routeTables, const wal::formatters::Formatter* formatter,
+                            std::unique_ptr<wal::filters::WhereFilter>& whereFilter)
 {
-    wal::Log::get().debug() << "frame page number " << header.pageNumber();
-    wal::Log::get().debug() << "frame page size " << header.sizeInPage();
+    if ( args.argExists("--where") )
+    {
+        if ( routeTables )
+        {
+            wal::Log::get().err() << "--where can't be used with --tables, every table has other columns";
+            return ARG_ERR;
+        }
+        try
+        {
+            whereFilter = std::make_unique<wal::filters::WhereFilter>(args.getArgValue<std::string>("--where").value_or(""),
+                                                                      formatter->columnNames(), formatter->rowidColumn());
+        }
+        catch(const wal::filters::WhereFilter::ParseException& e)
+        {
+            wal::Log::get().err() << "invalid --where expression: " << e.what();
+            return ARG_ERR;
+        }
+    }
+    return EXIT_OK;
+}
+
+inline wal::pipeline::FrameDecoder::Options decodeOptionsOf(const wal::formatters::Formatter& formatter,
+                                                            const wal::filters::WhereFilter* whereFilter,
+                                                            bool outputIndexes, bool skipInvalidFrames,
+                                                            bool printFrameHeaders, bool carveFreeSpace,
+                                                            int64_t minRowid, int64_t maxRowid)
+{
+    wal::pipeline::FrameDecoder::Options decodeOptions;
+    decodeOptions.outputIndexes = outputIndexes;
+    decodeOptions.skipInvalidFrames = skipInvalidFrames;
+    decodeOptions.printFrameHeaders = printFrameHeaders;
+    decodeOptions.carveFreeSpace = carveFreeSpace;
+    // columns that aren't output are skipped by the reader
+    decodeOptions.columns = formatter.projectionMask();
+    // the filter has to see it's columns even if they aren't output
+    if ( whereFilter && !decodeOptions.columns.empty() )
+    {
+        for (auto column : whereFilter->columns()) { decodeOptions.columns[column] = true; }
+    }
+    decodeOptions.minRowid = minRowid;
+    decodeOptions.maxRowid = maxRowid;
+    return decodeOptions;
+}
+
+// set by SIGINT/SIGTERM, --follow stops waiting for frames and flushes what it has
+volatile std::sig_atomic_t stopFollowing = 0;
+
+inline void onStopSignal(int)
+{
+    stopFollowing = 1;
 }
 
 enum class VerboseLevels
@@ -56,6 +251,28 @@ enum class VerboseLevels
     Debug=2
 };
 
+enum class StatsFormats
+{
+    Text=1,
+    Json=2
+};
+
+// the --stats report goes to stderr, so it doesn't mix with the rows
+inline void printStats(const std::optional<StatsFormats>& format)
+{
+    if ( !format ) { return; }
+    if ( StatsFormats::Json == format.value() ) { std::cerr << wal::Stats::get().json() << std::endl; }
+    else { std::cerr << wal::Stats::get().summary(); }
+}
+
+// the --trace events are saved once the parse is done
+inline void saveTrace(const std::string& path)
+{
+    if ( path.empty() ) { return; }
+    if ( wal::Trace::get().save(path) ) { wal::Log::get().info() << "saved the trace to " << path; }
+    else { wal::Log::get().err() << "Failed to write the trace to " << path; }
+}
+
 int main(int argc, char* argv[])
 {
     wal::arg_parsing::ArgsParsing args{
@@ -63,16 +280,38 @@ int main(int argc, char* argv[])
         "parse binary WAL (Write-Ahead-Log) sqlite file & has options to output it",
         argc, argv};
 
-    args.addArg({"--input", "-i"}, "filepath input of wal sql binary file", false /*optional*/, true /*get any input*/);
+    args.addArg({"--input", "-i"}, "filepath input of wal sql binary file, or a directory (every WAL file in it) or a glob of files to parse all of them i.e. -i './archive/*.db-wal'", false /*optional*/, true /*get any input*/);
     args.addArg({"--help", "-h"}, "show this usage", true /*optional*/);
     args.addArg<VerboseLevels>({"--verbose", "-v"}, "verbose levels", true /*optional*/ , {{"info",VerboseLevels::Info},{"debug",VerboseLevels::Debug}});
     args.addArg({"--csv", "-csv"}, "[default] will output csv format with defined columns i.e. -csv 'col1,col2'", true /*optional*/, true /*get any input*/);
     args.addArg({"--sql", "-s"}, "will output sql insert statements with the given schema file (only supports single create table schema) i.e. -s '../schema.sql' ", true /*optional*/, true /*get any input*/);
     args.addArg({"--strict", "-c"}, "if using --sql arg will output only insert statement that are valid with the schema", true /*optional*/);
     args.addArg({"--lenient", "-l"}, "[default] if using --sql arg will output any insert statement, even if the column don't match", true /*optional*/);
-    args.addArg({"--valid-frames", "-f"}, "prase only btree frames that have valid checksum", true /*optional*/);
+    args.addArg({"--valid-frames", "-f"}, "prase only btree frames that have valid salts and checksum chain, frames after the first torn/stale frame are dropped", true /*optional*/);
     args.addArg({"--index", "-x"}, "parse index btree data instead of table data, will only print the indices as is", true /*optional*/);
     args.addArg({"--quiet", "-q"}, "don't output any logs, not even errors", true /*optional*/);
+    args.addArg({"--stream", "-t"}, "write rows as frames are decoded (in frame order) instead of collecting, sorting and deduping all of them first", true /*optional*/);
+    args.addArg({"--dedupe", "-d"}, "if using --stream arg will drop repeated rows using a bounded table of row hashes (best effort)", true /*optional*/);
+    args.addArg({"--threads", "-j"}, "number of threads decoding frames, output keeps the same order as a single thread run i.e. -j 8", true /*optional*/, true /*get any input*/);
+    args.addArg({"--txn", "-n"}, "group frames into transactions by their commit frame, output rows per transaction and drop frames after the last commit", true /*optional*/);
+    args.addArg({"--latest-pages", "-p"}, "only decode the newest frame of every database page, older versions of the page are skipped (frames left from before a checkpoint only count for pages no newer frame holds)", true /*optional*/);
+    args.addArg({"--upto-commit", "-u"}, "only decode frames up to (and including) the N-th commit frame i.e. -u 3", true /*optional*/, true /*get any input*/);
+    args.addArg({"--db", "-db"}, "the main database file of the WAL, overflow pages that aren't in the WAL are read from it i.e. -db ./database.sql", true /*optional*/, true /*get any input*/);
+    args.addArg({"--carve", "-r"}, "also recover deleted records from the free space of leaf pages (unallocated space & freeblocks), each one is preceded by a comment with it's location and confidence", true /*optional*/);
+    args.addArg({"--tables", "-b"}, "output sql insert statements for every table of the --db database (replaces --sql), rows are routed to the table that owns their page", true /*optional*/);
+    args.addArg({"--page-map", "-pm"}, "with --tables keep the map of pages to tables in the given file, later runs with the same file reuse it while the database and WAL don't change i.e. -pm ./database.pagemap", true /*optional*/, true /*get any input*/);
+    args.addArg({"--build-index", "-k"}, "write an index of the WAL frames to <wal>.idx, later runs use it to read only the frames they need (while the WAL doesn't change). without an output option only the index is written", true /*optional*/);
+    args.addArg({"--columns", "-o"}, "only output the given columns in the given order, named as in the --sql schema or the --csv columns i.e. -o 'col2,col1'", true /*optional*/, true /*get any input*/);
+    args.addArg({"--where", "-e"}, "only output rows that match the expression, evaluated before the row is formatted i.e. -e \"col3 > 100 AND col5 LIKE 'abc%'\"", true /*optional*/, true /*get any input*/);
+    args.addArg({"--batch-size", "-a"}, "if using --sql or --tables arg will merge up to N rows of a table into a single multi-row INSERT statement, statements are wrapped in BEGIN/COMMIT i.e. -a 500", true /*optional*/, true /*get any input*/);
+    args.addArg({"--to-db", "-to"}, "load the rows into a new sqlite database instead of printing them, the table is created from the --sql schema and rows are loaded in frame order so the newest version of a row is kept i.e. -to ./recovered.db", true /*optional*/, true /*get any input*/);
+    args.addArg({"--follow", "-fl"}, "keep following the WAL after it's end, rows are written as their transaction is committed (until interrupted). the WAL is followed over checkpoints that start it over", true /*optional*/);
+    args.addArg({"--state-file", "-sf"}, "keep the position after the last committed transaction in the given file, a later run with the same file only decodes the frames committed since (from the first frame again if the WAL was started over by a checkpoint) i.e. -sf ./wal.state", true /*optional*/, true /*get any input*/);
+    args.addArg({"--output-dir", "-od"}, "with a directory or glob --input write the output of every WAL file to <dir>/<wal file name>.sql (or .csv) instead of to the standard output i.e. -od ./out", true /*optional*/, true /*get any input*/);
+    args.addArg<StatsFormats>({"--stats", "-st"}, "print counters (frames, pages, cells, rows, errors) and the time spent in every stage of the parse to stderr once it's done, as text or json", true /*optional*/, {{"text",StatsFormats::Text},{"json",StatsFormats::Json}});
+    args.addArg({"--trace", "-tr"}, "record when every frame is read, decoded, formatted & written on every thread and save it to the given file in the chrome trace event format (chrome://tracing or perfetto) i.e. -tr ./trace.json", true /*optional*/, true /*get any input*/);
+    args.addArg({"--rowid", "-w"}, "only output rows with the given rowid, every version of the row in the WAL i.e. -w 123456", true /*optional*/, true /*get any input*/);
+    args.addArg({"--rowid-range", "-g"}, "only output rows with a rowid in the given inclusive range, either side can be left out and rowids can be negative i.e. -g 100:200 or -g -50:", true /*optional*/, true /*get any input*/);
 
 
     if ( args.argExists("--help") )
@@ -115,157 +354,491 @@ int main(int argc, char* argv[])
         wal::Log::get().setLogLevel(wal::Log::ReportLevel::None);
     }
 
+    auto statsFormat = args.getArgValue<StatsFormats>("--stats");
+    if ( statsFormat ) { wal::Stats::get().enable(); }
+
+    const std::string tracePath = args.getArgValue<std::string>("--trace").value_or("");
+    if ( !tracePath.empty() ) { wal::Trace::get().enable(); }
+
     // readfile
     auto pathStr = args.getArgValue<std::string>("--input").value_or("");
-    if (pathStr.empty() || !std::filesystem::exists(pathStr))
+    // a directory or a glob is a batch of WAL files, they are parsed once the formatter is set up
+    const bool batch = !pathStr.empty() && (std::filesystem::is_directory(pathStr) || wal::pipeline::BatchRunner::isPattern(pathStr));
+    if ( batch )
+    {
+        for (const auto* option : {"--db", "--tables", "--page-map", "--to-db", "--follow", "--state-file", "--txn", "--upto-commit", "--build-index"})
+        {
+            if ( !args.argExists(option) ) { continue; }
+            wal::Log::get().err() << option << " can't be used with a directory or glob --input";
+            return ARG_ERR;
+        }
+    }
+    else if ( args.argExists("--output-dir") )
+    {
+        wal::Log::get().err() << "--output-dir needs a directory or glob --input";
+        return ARG_ERR;
+    }
+    else if (pathStr.empty() || !std::filesystem::exists(pathStr))
     {
         wal::Log::get().err() << "Failed to find file at path " << pathStr;
         return PATH_ERR;
     }
 
-    std::filesystem::path path{pathStr};
-    auto file = std::ifstream(path, std::ios::binary);
+    // large rows continue on overflow pages, the ones that were checkpointed are only in the database file
+    std::unique_ptr<wal::MappedFile> databaseFile;
+    std::string databasePath;
+    if ( args.argExists("--db") )
+    {
+        databasePath = args.getArgValue<std::string>("--db").value_or("");
+        if (databasePath.empty() || !std::filesystem::exists(databasePath))
+        {
+            wal::Log::get().err() << "Failed to find database file at path " << databasePath;
+            return PATH_ERR;
+        }
+        try
+        {
+            databaseFile = std::make_unique<wal::MappedFile>(databasePath, wal::MappedFile::AccessHint::Random);
+        }
+        catch(const std::runtime_error& e)
+        {
+            wal::Log::get().err() << "Failed to read database file at path " << databasePath << ": " << e.what();
+            return READ_ERR;
+        }
+    }
 
-    if (file.bad())
+    bool routeTables = args.argExists("--tables");
+    if ( routeTables && nullptr == databaseFile )
     {
-        wal::Log::get().err() << "Failed to read file at path " << path;
-        return READ_ERR;
+        wal::Log::get().err() << "--tables needs the database file, use --db";
+        return MISSING_OPT_ERR;
+    }
+    const std::string pageMapPath = args.getArgValue<std::string>("--page-map").value_or("");
+    if ( args.argExists("--page-map") && pageMapPath.empty() )
+    {
+        wal::Log::get().err() << "invalid value for --page-map";
+        return ARG_ERR;
     }
+    if ( !pageMapPath.empty() && !routeTables )
+    {
+        wal::Log::get().err() << "--page-map can only be used with --tables";
+        return MISSING_OPT_ERR;
+    }
+
+    size_t threads = 1;
+    if ( !getCountArg(args, "--threads", threads) ) { return ARG_ERR; }
 
-    wal::readers::WalHeaderReader header;
-    file.read(header, header.sizeOf());
+    size_t batchSize = 0;
+    if ( !getCountArg(args, "--batch-size", batchSize) ) { return ARG_ERR; }
 
-    if (!file)
+    size_t uptoCommit = 0;
+    if ( !getCountArg(args, "--upto-commit", uptoCommit) ) { return ARG_ERR; }
+
+    bool perTransaction = args.argExists("--txn");
+
+    int64_t minRowid = std::numeric_limits<int64_t>::min();
+    int64_t maxRowid = std::numeric_limits<int64_t>::max();
+    if ( !getRangeArg(args, "--rowid", true, minRowid, maxRowid) ) { return ARG_ERR; }
+    if ( !getRangeArg(args, "--rowid-range", false, minRowid, maxRowid) ) { return ARG_ERR; }
+    const bool filterRowids = args.argExists("--rowid") || args.argExists("--rowid-range");
+    if ( filterRowids && outputIndexes )
     {
-        wal::Log::get().err() << "Failed to read the header of the file (file may be too small)";
-        file.close();
-        return HEAD_READ_ERR;
+        wal::Log::get().err() << "--rowid & --rowid-range only work on table pages, they can't be used with --index";
+        return ARG_ERR;
+    }
+
+    // following & resuming work on what's committed, they can't be combined with options that look at the whole WAL once
+    bool follow = args.argExists("--follow");
+    const std::string statePath = args.getArgValue<std::string>("--state-file").value_or("");
+    if ( args.argExists("--state-file") && statePath.empty() )
+    {
+        wal::Log::get().err() << "invalid value for --state-file";
+        return ARG_ERR;
+    }
+    const bool incremental = follow || !statePath.empty();
+    if ( incremental )
+    {
+        for (const auto* option : {"--tables", "--txn", "--upto-commit", "--latest-pages", "--build-index"})
+        {
+            if ( !args.argExists(option) ) { continue; }
+            wal::Log::get().err() << option << " can't be used with " << (follow ? "--follow" : "--state-file");
+            return ARG_ERR;
+        }
     }
 
     bool skipInvalidFrames = args.argExists("--valid-frames");
 
+    if ( batch )
+    {
+        auto files = wal::pipeline::BatchRunner::inputFiles(pathStr);
+        if ( files.empty() )
+        {
+            wal::Log::get().err() << "Failed to find any WAL file at " << pathStr;
+            return PATH_ERR;
+        }
+
+        int formatterId = wal::formatters::CSVFormatter::id;
+        wal::formatters::Formatter* formatter = nullptr;
+        wal::pipeline::BatchRunner::Options batchOptions;
+        if ( auto error = setupFormatter(args, false, false, formatterId, formatter, batchOptions.preamble); EXIT_OK != error ) { return error; }
+        if ( batchSize > 0 && wal::formatters::SchemaFormatter::id != formatterId )
+        {
+            wal::Log::get().err() << "--batch-size can only be used with --sql or --tables";
+            return ARG_ERR;
+        }
+        std::unique_ptr<wal::filters::WhereFilter> whereFilter;
+        if ( auto error = setupWhereFilter(args, false, formatter, whereFilter); EXIT_OK != error ) { return error; }
+
+        batchOptions.decode = decodeOptionsOf(*formatter, whereFilter.get(), outputIndexes, skipInvalidFrames,
+                                              verboseVal && verboseVal.value() == VerboseLevels::Debug, args.argExists("--carve"),
+                                              minRowid, maxRowid);
+        batchOptions.filter = whereFilter.get();
+        batchOptions.stream = args.argExists("--stream");
+        batchOptions.dedupe = args.argExists("--dedupe");
+        batchOptions.latestPages = args.argExists("--latest-pages");
+        batchOptions.batchSize = batchSize;
+        if ( args.argExists("--output-dir") )
+        {
+            batchOptions.outputDir = args.getArgValue<std::string>("--output-dir").value_or("");
+            std::error_code ec;
+            std::filesystem::create_directories(batchOptions.outputDir, ec);
+            if ( batchOptions.outputDir.empty() || !std::filesystem::is_directory(batchOptions.outputDir) )
+            {
+                wal::Log::get().err() << "Failed to create the output directory " << batchOptions.outputDir;
+                return PATH_ERR;
+            }
+            batchOptions.extension = wal::formatters::SchemaFormatter::id == formatterId ? ".sql" : ".csv";
+        }
+
+        // files are decoded side by side, --threads bounds how many at once (all cores by default)
+        if ( !args.argExists("--threads") ) { threads = std::max(1u, std::thread::hardware_concurrency()); }
+        wal::Log::get().info() << "parsing " << files.size() << " WAL files on " << threads << " threads";
+        wal::pipeline::BatchRunner runner(*formatter, std::move(batchOptions), threads);
+        const size_t failed = runner.run(files, std::cout);
+        printStats(statsFormat);
+        saveTrace(tracePath);
+        if ( failed > 0 )
+        {
+            wal::Log::get().err() << failed << " out of " << files.size() << " WAL files failed to parse";
+            return READ_ERR;
+        }
+        return EXIT_OK;
+    }
+
+    std::filesystem::path path{pathStr};
+    std::unique_ptr<wal::MappedFile> file;
+    try
+    {
+        file = std::make_unique<wal::MappedFile>(path, wal::MappedFile::AccessHint::Sequential);
+    }
+    catch(const std::runtime_error& e)
+    {
+        wal::Log::get().err() << "Failed to read file at path " << path << ": " << e.what();
+        return READ_ERR;
+    }
+
+    wal::readers::WalFrameReader walReader(*file);
+    if (!walReader.readHeader())
+    {
+        wal::Log::get().err() << "Failed to read the header of the file (file may be too small)";
+        return HEAD_READ_ERR;
+    }
+    const auto& header = walReader.header();
+
     if ( verboseVal && verboseVal.value() == VerboseLevels::Debug )
     {
         printWalHeader(header);
     }
 
-    int formatterId = wal::formatters::CSVFormatter::id;
-    std::unique_ptr<wal::formatters::inputs::InputType> formatterInput = nullptr;
-
-    if ( args.argExists("--csv") )
+    // the frame index lets later runs skip reading the frame headers & pages they don't need
+    const std::filesystem::path indexPath = pathStr + ".idx";
+    wal::readers::FrameIndex frameIndex;
+    bool useIndex = false;
+    if ( args.argExists("--build-index") )
     {
-        formatterId = wal::formatters::CSVFormatter::id;
-        auto csvCols = args.getArgValue<std::string>("--csv");
-        if (csvCols)
+        frameIndex.build(walReader);
+        if ( !frameIndex.save(indexPath) )
         {
-            formatterInput = std::make_unique<wal::formatters::inputs::StringInput>(csvCols.value());
+            wal::Log::get().err() << "Failed to write the frame index to " << indexPath;
+            return READ_ERR;
         }
+        wal::Log::get().info() << "wrote the index of " << frameIndex.frameCount() << " frames to " << indexPath;
+        if ( !args.argExists("--csv") && !args.argExists("--sql") && !routeTables ) { return EXIT_OK; }
+        useIndex = true;
     }
-    else if ( args.argExists("--sql") )
+    // the index is of the WAL as it was, a followed (or resumed) WAL doesn't stay that way
+    else if ( !incremental && std::filesystem::exists(indexPath) )
     {
-        formatterId = wal::formatters::SchemaFormatter::id;
-        auto schemaFile = args.getArgValue<std::string>("--sql");
-        if (schemaFile)
+        useIndex = frameIndex.load(indexPath, walReader);
+        if ( useIndex ) { wal::Log::get().info() << "using the frame index " << indexPath; }
+        else { wal::Log::get().info() << "frame index " << indexPath << " doesn't match the WAL, ignoring it (rebuild it with --build-index)"; }
+    }
+
+    bool toDatabase = args.argExists("--to-db");
+    if ( toDatabase )
+    {
+#ifndef WAL_HAS_SQLITE
+        wal::Log::get().err() << "--to-db isn't available, wal-parser was built without sqlite";
+        return ARG_ERR;
+#endif
+        if ( routeTables || !args.argExists("--sql") )
         {
-            formatterInput = std::make_unique<wal::formatters::inputs::FileInput>(schemaFile.value());
+            wal::Log::get().err() << "--to-db needs the table schema of --sql";
+            return MISSING_OPT_ERR;
         }
     }
 
-    auto formatter = wal::formatters::Factory::instance().getFormatter(formatterId);
 
-    formatter->lenientMode();
-    if ( args.argExists("--strict") ) { formatter->strictMode(); }
+    int formatterId = wal::formatters::CSVFormatter::id;
+    wal::formatters::Formatter* formatter = nullptr;
+    std::string preamble;
+    if ( auto error = setupFormatter(args, routeTables, toDatabase, formatterId, formatter, preamble); EXIT_OK != error ) { return error; }
 
-    if ( nullptr == formatterInput )
+    // rows are batched after they are ordered & deduped, they are loaded into the database in frame order
+    std::unique_ptr<wal::writers::OutputWriter> sink;
+    if ( batchSize > 0 )
     {
-        wal::Log::get().err() << "Didn't get any option: --csv, --sql";
-        return MISSING_OPT_ERR;
+        if ( wal::formatters::SchemaFormatter::id != formatterId )
+        {
+            wal::Log::get().err() << "--batch-size can only be used with --sql or --tables";
+            return ARG_ERR;
+        }
+        sink = std::make_unique<wal::writers::BatchInsertWriter>(std::cout, batchSize);
     }
-    formatter->setInput(std::move(formatterInput));
-
-    std::set<std::string> outputData;
-    while(file)
+#ifdef WAL_HAS_SQLITE
+    wal::writers::DatabaseWriter* databaseWriter = nullptr;
+    if ( toDatabase )
     {
-        // - read frame header
-        wal::readers::FrameHeader frameHeader;
-        file.read( frameHeader, frameHeader.sizeOf() );
-        if (!file)
+        const auto* databaseFormatter = static_cast<const wal::formatters::DatabaseFormatter*>(formatter);
+        try
         {
-            if (file.eof()) { wal::Log::get().info() << "reach EOF." ; break; }
-            else            { wal::Log::get().err()  << "Failed to read Frame Header, file may be incomplete. existing" ; break; }
+            auto writer = std::make_unique<wal::writers::DatabaseWriter>(args.getArgValue<std::string>("--to-db").value_or(""),
+                                                                         databaseFormatter->createStatement(),
+                                                                         databaseFormatter->insertStatement());
+            databaseWriter = writer.get();
+            sink = std::move(writer);
         }
-
-        if ( verboseVal && verboseVal.value() == VerboseLevels::Debug ) { printFrameHeader(frameHeader); }
-
-        wal::FixedRuntimeArray<uint8_t> frameData(header.page_size());
-        file.read((char*)frameData.data(), header.page_size());
-        if (!file)
+        catch(const std::runtime_error& e)
         {
-            if (file.eof()) { wal::Log::get().err() << "reach EOF unexpectedly while reading Frame Chunk. exisintg" ; break; }
-            else            { wal::Log::get().err()  << "Failed to read Frame Chunk, file may be incomplete. existing" ; break; }
+            wal::Log::get().err() << e.what();
+            return PATH_ERR;
         }
+    }
+#endif
+
+    std::unique_ptr<wal::writers::OutputWriter> writer;
+    // the database keeps the last version of a row it's given, sorting would put an older one last
+    if ( args.argExists("--stream") || toDatabase )
+    {
+        writer = sink ? std::make_unique<wal::writers::StreamWriter>(*sink, args.argExists("--dedupe"))
+                      : std::make_unique<wal::writers::StreamWriter>(std::cout, args.argExists("--dedupe"));
+    }
+    else
+    {
+        writer = sink ? std::make_unique<wal::writers::SortedWriter>(*sink)
+                      : std::make_unique<wal::writers::SortedWriter>(std::cout);
+    }
+    if (!preamble.empty()) { writer->writeHeader(preamble); }
+
+    std::unique_ptr<wal::filters::WhereFilter> whereFilter;
+    if ( auto error = setupWhereFilter(args, routeTables, formatter, whereFilter); EXIT_OK != error ) { return error; }
+
+    auto decodeOptions = decodeOptionsOf(*formatter, whereFilter.get(), outputIndexes, skipInvalidFrames,
+                                         verboseVal && verboseVal.value() == VerboseLevels::Debug, args.argExists("--carve"),
+                                         minRowid, maxRowid);
 
-        if ( !isFrameWeakValid(header, frameHeader) && skipInvalidFrames )
-        {
-            wal::Log::get().info() <<  "Frame is invalid skipping";
-            wal::Log::get().info() <<  "mismatch salt1 " << header.salt1() << " != " << frameHeader.salt1();
-            wal::Log::get().info() <<  "mismatch salt2 " << header.salt2() << " != " << frameHeader.salt2();
-            continue;
-        }
 
-        auto it = frameData.begin();
-        wal::readers::BTreeReader bTreeReader;
 
-        bTreeReader.readHeader(it);
+    wal::readers::PageSource pageSource(walReader, databaseFile.get());
+    wal::pipeline::FrameDecoder decoder(walReader, *formatter, decodeOptions, &pageSource);
+    decoder.filterRows(whereFilter.get());
+    wal::pipeline::FramePipeline pipeline(decoder, threads);
 
-        if (bTreeReader.isInteriorType())
+    size_t frameCount = walReader.frameCount();
+    if ( skipInvalidFrames )
+    {
+        if ( !walReader.isHeaderChecksumValid() )
         {
-            wal::Log::get().info() <<  "Found interior Btree Node, skipping";
-            continue;
+            wal::Log::get().err() << "WAL header checksum mismatch, no frame is valid";
         }
+        frameCount = useIndex ? frameIndex.validFrameCount() : walReader.validFrameCount();
+        wal::Log::get().info() << frameCount << " out of " << walReader.frameCount() << " frames have a valid checksum";
+    }
+    // a followed (or resumed) WAL is indexed as frames are committed
+    pageSource.build(incremental ? 0 : frameCount, useIndex ? &frameIndex : nullptr);
 
-        if (bTreeReader.getBTreeNodeType() == wal::types::BTreeNodePageType::leafIndex && !outputIndexes)
+    wal::readers::TableMap tableMap(pageSource);
+    wal::formatters::TableFormatters tableFormatters(tableMap);
+    if ( routeTables )
+    {
+        // walking every b-tree is the slow part on big databases, with --page-map the map is reused while the
+        // database and WAL don't change
+        const auto key = wal::readers::TableMap::stateKey(walReader, pageSource.hasDatabase() ? databaseFile.get() : nullptr, frameCount);
+        if ( !pageMapPath.empty() && tableMap.load(pageMapPath, key) )
         {
-            wal::Log::get().info() <<  "Found "<< bTreeReader.getBTreeNodeType() << ", skipping";
-            continue;
+            wal::Log::get().info() << "loaded the page map from " << pageMapPath;
         }
-
-        if (bTreeReader.getBTreeNodeType() == wal::types::BTreeNodePageType::leafTable && outputIndexes)
+        else
         {
-            wal::Log::get().info() <<  "Found "<< bTreeReader.getBTreeNodeType() << " and we got --index arg, skipping";
-            continue;
+            tableMap.build(frameCount > 0 ? frameCount - 1 : 0);
+            if ( !pageMapPath.empty() && !tableMap.save(pageMapPath, key) ) { wal::Log::get().info() << "Failed to write the page map to " << pageMapPath; }
         }
+        wal::Log::get().info() << "found " << tableMap.tables().size() << " tables with " << tableMap.pageCount() << " pages";
 
-        bTreeReader.readPointerArray(it);
+        if ( tableFormatters.prepare(args.argExists("--strict")) == 0 )
+        {
+            wal::Log::get().err() << "Failed to find any table in the database schema";
+            return FORMAT_ERR;
+        }
+        decoder.routeTables(&tableFormatters);
+    }
 
-        wal::readers::RecordHeaderReader recordReader(bTreeReader.getBTreeNodeType());
+    bool latestPages = args.argExists("--latest-pages");
+    wal::readers::WalPageMap pageMap(walReader, useIndex ? &frameIndex : nullptr);
+    auto decodeFrames = [&](std::vector<size_t>&& frames)
+    {
+        if ( latestPages )
+        {
+            pageMap.build(frames);
+            auto latest = pageMap.latestOnly(frames);
+            wal::Log::get().info() << "decoding " << latest.size() << " latest page versions out of " << frames.size() << " frames";
+            frames = std::move(latest);
+        }
+        // only after picking the latest pages, a page's newest frame may not be a leaf anymore
+        if ( useIndex ) { frames = frameIndex.leafFrames(frames, outputIndexes, skipInvalidFrames); }
+        // carving can find deleted rows of any rowid, so pages are only skipped without it
+        if ( useIndex && filterRowids && !decodeOptions.carveFreeSpace ) { frames = frameIndex.rowidFrames(frames, minRowid, maxRowid); }
+        pipeline.run(frames, *writer);
+    };
+
+    if ( incremental )
+    {
+        // the first poll has everything that's committed after the saved position (or all of it), later ones only the frames committed since
+        wal::readers::WalFollower follower(walReader);
+        if ( !statePath.empty() && std::filesystem::exists(statePath) )
+        {
+            if ( follower.load(statePath) ) { wal::Log::get().info() << "going on from frame " << follower.nextFrame() << " of " << statePath; }
+            else { wal::Log::get().err() << "Failed to read the state file " << statePath << ", decoding from the first frame"; }
+        }
 
-        for(auto& ptr : bTreeReader.getPointerArray())
+        // the wait ends as soon as the WAL is written to, the timeout covers missed or unsupported notifications
+        std::unique_ptr<wal::FileWatcher> watcher;
+        if ( follow )
         {
-            auto ptrPos = frameData.begin() + ptr;
+            std::signal(SIGINT, onStopSignal);
+            std::signal(SIGTERM, onStopSignal);
+            watcher = std::make_unique<wal::FileWatcher>(path);
+        }
 
-            recordReader.read(ptrPos);
-            recordReader.printOut();
+        while ( !stopFollowing )
+        {
+            auto update = [&follower]()
+            {
+                wal::Trace::Scope scope("poll");
+                return follower.poll();
+            }();
+            if ( update.reset )
+            {
+                wal::Log::get().info() << "the WAL was started over (checkpoint), decoding it from the first frame";
+                pageSource.build(0);
+            }
+            if ( !update.frames.empty() )
+            {
+                wal::Log::get().info() << "decoding " << update.frames.size() << " committed frames";
+                pageSource.extend(update.frames.back() + 1);
+                decodeFrames(std::move(update.frames));
+                wal::Stats::Timer timer(wal::Stats::Stage::Output);
+                wal::Trace::Scope scope("output");
+                writer->flush();
+            }
+            // only once the rows are out, a run that's stopped before decodes the frames again
+            if ( (update.reset || !update.frames.empty()) && !statePath.empty() && !follower.save(statePath) )
+            {
+                wal::Log::get().err() << "Failed to write the state file " << statePath;
+            }
+            if ( !follow ) { break; }
 
-            std::string output;
+            {
+                wal::Trace::Scope scope("wait");
+                watcher->wait(std::chrono::milliseconds(200));
+            }
             try
             {
-                output = formatter->generateOutput(recordReader.headerData());
+                file->refresh();
+                if ( databaseFile ) { databaseFile->refresh(); }
             }
-            catch(const wal::formatters::Formatter::FormatterException& e)
+            catch(const std::runtime_error& e)
             {
-                wal::Log::get().err() << "Failed to generate output due to: " << e.what();
+                // i.e. it was truncated & is written again, the next refresh picks it up
+                wal::Log::get().info() << "Failed to map the file again: " << e.what();
             }
+        }
+        wal::Log::get().info() << "stopped at frame " << follower.nextFrame();
+    }
+    else if ( !perTransaction && uptoCommit == 0 )
+    {
+        std::vector<size_t> frames(frameCount);
+        std::iota(frames.begin(), frames.end(), 0);
+        decodeFrames(std::move(frames));
+    }
+    else
+    {
+        auto transactions = useIndex ? frameIndex.transactions(frameCount) : walReader.transactions(frameCount);
+        wal::Log::get().info() << "found " << transactions.size() << " committed transactions";
+        if ( uptoCommit > 0 && uptoCommit < transactions.size() ) { transactions.resize(uptoCommit); }
 
-            if (!output.empty()) { outputData.emplace(output); }
+        if ( perTransaction )
+        {
+            for (size_t i = 0; i < transactions.size(); ++i)
+            {
+                const auto& txn = transactions[i];
+                std::stringstream ss;
+                ss << "transaction " << i+1 << " frames " << txn.firstFrame << "-" << txn.lastFrame << " database size " << txn.databaseSize << " pages";
+                writer->writeHeader(formatter->comment(ss.str()));
+
+                std::vector<size_t> frames(txn.lastFrame - txn.firstFrame + 1);
+                std::iota(frames.begin(), frames.end(), txn.firstFrame);
+                decodeFrames(std::move(frames));
+                wal::Stats::Timer timer(wal::Stats::Stage::Output);
+                wal::Trace::Scope scope("output");
+                writer->flush();
+            }
         }
+        else
+        {
+            // frames are decoded up to the last commit frame that was kept
+            std::vector<size_t> frames(transactions.empty() ? 0 : transactions.back().lastFrame + 1);
+            std::iota(frames.begin(), frames.end(), 0);
+            decodeFrames(std::move(frames));
+        }
+    }
+
+    if (walReader.hasIncompleteFrame())
+    {
+        wal::Log::get().err() << "reach EOF unexpectedly while reading Frame Chunk, file may be incomplete.";
+    }
+    else
+    {
+        wal::Log::get().info() << "reach EOF." ;
+    }
 
+    {
+        wal::Stats::Timer timer(wal::Stats::Stage::Output);
+        wal::Trace::Scope scope("output");
+        writer->flush();
     }
 
-    for (auto rit = outputData.rbegin(); rit != outputData.rend(); ++rit)
+#ifdef WAL_HAS_SQLITE
+    if ( nullptr != databaseWriter )
     {
-        std::cout << *rit << std::endl;
+        wal::Log::get().info() << "loaded " << databaseWriter->rowsWritten() << " rows into " << args.getArgValue<std::string>("--to-db").value_or("");
+        if ( databaseWriter->rowsRejected() > 0 )
+        {
+            wal::Log::get().err() << databaseWriter->rowsRejected() << " rows were rejected by the constraints of the table";
+        }
     }
+#endif
 
+    printStats(statsFormat);
+    saveTrace(tracePath);
     return EXIT_OK;
 }
@@ -6,6 +6,8 @@
 #include <unordered_map>
 #include <optional>
 #include <string_view>
+#include <algorithm>
+#include <stdexcept>
 #include "ArgValues.h"
 #pragma once
 
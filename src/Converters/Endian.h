@@ -1,5 +1,8 @@
 #include <cstdint>
-#include <array>
+#include <cstddef>
+#include <cstring>
+#include <bit>
+#include <type_traits>
 #pragma once
 
 namespace wal::converters {
@@ -7,40 +10,61 @@ namespace wal::converters {
     struct Endian
     {
         protected:
-            template<typename TYPE, std::array<int,sizeof(TYPE)> MV_ARRAY>
-            static inline TYPE fromBig(const TYPE& value)
+            template<typename TYPE>
+            static constexpr TYPE fromBig(const TYPE& value)
             {
                 static_assert(std::is_integral_v<TYPE>, "converting type must be integral type");
-
-                TYPE ret = 0;
-                TYPE mask = ret | 0xFF;
-                for (int i=0; i<MV_ARRAY.size(); ++i)
-                {
-                    ret |= (MV_ARRAY[i] > 0 ? (mask & value) << MV_ARRAY[i] : (mask & value) >> (MV_ARRAY[i]*-1));
-                    mask = mask << 8;
-                }
-                return ret;
+                if constexpr (std::endian::native == std::endian::big) { return value; }
+                else { return std::byteswap(value); }
             }
+
         public:
+            // this converts the integral value of the double, not it's bits. it's kept for the
+            // existing callers, use loadBigFloat64 to read a big endian IEEE double from data
             static inline double fromBig(const double& value)
             {
                 auto i = static_cast<uint64_t>(value);
-                return static_cast<double>(fromBig<uint64_t, {56,40,24,8,-8,-24,-40,-56} >(i));
+                return static_cast<double>(fromBig<uint64_t>(i));
             }
 
-            static inline uint64_t fromBig(const uint64_t& value)
-            {
-                return fromBig<uint64_t, {56,40,24,8,-8,-24,-40,-56} >(value);
-            }
+            static constexpr uint64_t fromBig(const uint64_t& value) { return fromBig<uint64_t>(value); }
+
+            static constexpr uint32_t fromBig(const uint32_t& value) { return fromBig<uint32_t>(value); }
+
+            static constexpr uint16_t fromBig(const uint16_t& value) { return fromBig<uint16_t>(value); }
 
-            static inline uint32_t fromBig(const uint32_t& value)
+            // load SIZE big endian bytes from data into TYPE, data doesn't have to be aligned.
+            // SIZE can be smaller than TYPE (i.e. the 3 and 6 byte ints of the record format)
+            // the caller is responsible that SIZE bytes are readable
+            template<typename TYPE, size_t SIZE = sizeof(TYPE)>
+            static inline TYPE loadBig(const uint8_t* data)
             {
-                return fromBig<uint32_t, {24,8,-8,-24} >(value);
+                static_assert(std::is_unsigned_v<TYPE>, "loading type must be unsigned integral type");
+                static_assert(SIZE > 0 && SIZE <= sizeof(TYPE), "can't load more bytes than the type holds");
+
+                // odd sizes are composed from the natural ones, those compile to a single load (+ bswap)
+                if constexpr (SIZE == 1) { return data[0]; }
+                else if constexpr (SIZE == 3)
+                {
+                    return (TYPE(loadBig<uint16_t>(data)) << 8) | data[2];
+                }
+                else if constexpr (SIZE == 6)
+                {
+                    return (TYPE(loadBig<uint32_t>(data)) << 16) | loadBig<uint16_t>(data + 4);
+                }
+                else
+                {
+                    static_assert(SIZE == 2 || SIZE == 4 || SIZE == 8, "only 1, 2, 3, 4, 6 and 8 byte loads are supported");
+                    using Natural = std::conditional_t<SIZE == 2, uint16_t, std::conditional_t<SIZE == 4, uint32_t, uint64_t>>;
+                    Natural value;
+                    std::memcpy(&value, data, SIZE);
+                    return static_cast<TYPE>(fromBig<Natural>(value));
+                }
             }
 
-            static inline uint16_t fromBig(const uint16_t& value)
+            static inline double loadBigFloat64(const uint8_t* data)
             {
-                return fromBig<uint16_t, {8,-8} >(value);
+                return std::bit_cast<double>(loadBig<uint64_t>(data));
             }
     };
 }
@@ -1,5 +1,10 @@
 #include <cstdint>
 #include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <span>
+#include <cstring>
+#include <bit>
 #include "Utils/FixedRuntimeArray.h"
 #pragma once
 
@@ -20,68 +25,88 @@ namespace wal::converters {
                 char value[N] = {0};
             };
 
+            // kept out of line so building the message doesn't weigh on the conversion itself
+            [[noreturn, gnu::cold, gnu::noinline]]
+            static void notEnoughData(const char* typeName, size_t size)
+            {
+                std::string message = "Unable to convert data vector to ";
+                message += typeName;
+                message += " from " + std::to_string(size) + " bytes, not enough data";
+                throw std::runtime_error(message);
+            }
+
+            // assembles the first SIZE bytes with the first byte as the lowest one (the on-disk
+            // bytes in host order on little endian), callers swap it with Endian::fromBig
             template<size_t SIZE, typename RET, StringLiteral TYPE_STR>
-            static inline RET toThis(const FixedRuntimeArray<uint8_t>& data)
+            static inline RET toThis(std::span<const uint8_t> data)
             {
                 static_assert(std::is_integral_v<RET>, "return time must be integral type");
-                if (data.size() < SIZE )
-                {
-                    std::string message = "Unable to convert data vector to ";
-                    message += TYPE_STR.value;
-                    message += " from " + std::to_string(data.size()) + " bytes, not enough data";
-                    throw std::runtime_error(message);
-                }
+                if (data.size() < SIZE) [[unlikely]] { notEnoughData(TYPE_STR.value, data.size()); }
 
                 RET v = 0;
-                for (int i=0; i < SIZE; ++i)
+                if constexpr (std::endian::native == std::endian::little) { std::memcpy(&v, data.data(), SIZE); }
+                else
                 {
-                    RET c = data[i];
-                    v |= c << i*8;
+                    for (size_t i=0; i < SIZE; ++i) { v |= static_cast<RET>(data[i]) << i*8; }
                 }
                 return v;
+            }
 
+            static inline std::span<const uint8_t> view(const FixedRuntimeArray<uint8_t>& data)
+            {
+                return { data.data(), data.size() };
             }
 
         public:
-            static inline uint16_t toUInt16(const FixedRuntimeArray<uint8_t>& data)
+            static inline uint16_t toUInt16(std::span<const uint8_t> data)
             {
                 return toThis<sizeof(uint16_t),uint16_t, "uint16_t">(data);
             }
 
-            static inline uint32_t toUInt32(const FixedRuntimeArray<uint8_t>& data)
+            static inline uint32_t toUInt32(std::span<const uint8_t> data)
             {
                 return toThis<sizeof(uint32_t),uint32_t, "uint32_t">(data);
             }
 
-            static inline uint32_t toUInt32FromThreeBytes(const FixedRuntimeArray<uint8_t>& data)
+            static inline uint32_t toUInt32FromThreeBytes(std::span<const uint8_t> data)
             {
                 return toThis<3 ,uint32_t, "uint32_t">(data);
             }
 
-            static inline uint64_t toUInt64(const FixedRuntimeArray<uint8_t>& data)
+            static inline uint64_t toUInt64(std::span<const uint8_t> data)
             {
                 return toThis<sizeof(uint64_t),uint64_t, "uint64_t">(data);
             }
 
-            static inline uint64_t toUInt64FromSixBytes(const FixedRuntimeArray<uint8_t>& data)
+            static inline uint64_t toUInt64FromSixBytes(std::span<const uint8_t> data)
             {
                 return toThis<6,uint64_t, "uint64_t">(data);
             }
 
-            static inline float64_t toFloat64(const FixedRuntimeArray<uint8_t>& data)
+            static inline float64_t toFloat64(std::span<const uint8_t> data)
             {
                 return static_cast<float64_t>(toUInt64(data));
             }
 
+            static inline uint16_t toUInt16(const FixedRuntimeArray<uint8_t>& data) { return toUInt16(view(data)); }
+
+            static inline uint32_t toUInt32(const FixedRuntimeArray<uint8_t>& data) { return toUInt32(view(data)); }
+
+            static inline uint32_t toUInt32FromThreeBytes(const FixedRuntimeArray<uint8_t>& data) { return toUInt32FromThreeBytes(view(data)); }
+
+            static inline uint64_t toUInt64(const FixedRuntimeArray<uint8_t>& data) { return toUInt64(view(data)); }
+
+            static inline uint64_t toUInt64FromSixBytes(const FixedRuntimeArray<uint8_t>& data) { return toUInt64FromSixBytes(view(data)); }
+
+            static inline float64_t toFloat64(const FixedRuntimeArray<uint8_t>& data) { return toFloat64(view(data)); }
+
             template<typename TYPE, int COUNT>
             static inline TYPE fromIteratorToType(FixedRuntimeArray<uint8_t>::iterator& it)
             {
-                FixedRuntimeArray<uint8_t> data(it,COUNT);
-                if constexpr (std::is_same_v<TYPE,uint16_t>) { return toUInt16(data); }
-                if constexpr (std::is_same_v<TYPE,uint32_t>) { return toUInt32(data); }
-                if constexpr (std::is_same_v<TYPE,uint64_t> && COUNT == 3)  { return toUInt32FromThreeBytes(data); }
-                if constexpr (std::is_same_v<TYPE,uint64_t>) { return toUInt64(data); }
-                if constexpr (std::is_same_v<TYPE,uint64_t> && COUNT == 6)  { return toUInt64FromSixBytes(data); }
+                if (it.remaining() < COUNT) { throw std::out_of_range("while trying to access data, it's out of range"); }
+                TYPE v = toThis<COUNT, TYPE, "integral type">({ it.ptr(), COUNT });
+                it += COUNT;
+                return v;
             }
     };
 }
@@ -1,6 +1,14 @@
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <vector>
+#include <bit>
+#include <stdexcept>
+#include "Utils/FixedRuntimeArray.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #pragma once
 
 namespace wal::converters {
@@ -51,34 +59,91 @@ namespace wal::converters {
             }
 
             static inline uint64_t readVarInt(FixedRuntimeArray<uint8_t>::iterator& dataIt)
+            {
+                uint64_t v = 0;
+                size_t used = readVarInt(dataIt.ptr(), dataIt.remaining(), v);
+                if (used == 0) { throw std::out_of_range("while trying to read varint, it's out of range"); }
+                dataIt += used;
+                return v;
+            }
+
+            // decode a single varint from at most size bytes at data.
+            // returns the number of bytes it used, 0 if the varint doesn't fit in size
+            static inline size_t readVarInt(const uint8_t* data, size_t size, uint64_t& value)
             {
                 constexpr uint8_t lastSevenBits = 0x7f; //127 = 01111111
-                constexpr int maxSize = 9;
+                constexpr size_t maxSize = 9;
 
-                auto localIt = dataIt;
-                ++dataIt;
                 uint64_t v = 0;
-                for (int i=0; i<maxSize-1; ++i)
+                for (size_t i=0; i<maxSize-1; ++i)
                 {
-                    if (localIt[i] <= lastSevenBits)
+                    if (i >= size) { return 0; }
+                    v = (v << 7) | (data[i] & lastSevenBits);
+                    if (data[i] <= lastSevenBits)
                     {
-                        v |= localIt[i];
-                        return v;
+                        value = v;
+                        return i+1;
                     }
-
-                    v |= (localIt[i] & lastSevenBits);
-                    v = v << 7;
-
-                    ++dataIt;
                 }
 
-                // process 9-th byte
-                v = v << 8;
-                v |= localIt[8];
+                // the 9-th byte uses all 8 bits
+                if (size < maxSize) { return 0; }
+                value = (v << 8) | data[maxSize-1];
+                return maxSize;
+            }
 
-                ++dataIt;
+            // how many bytes from the start have the high bit clear, each of them is a complete varint
+            static inline size_t countSingleBytes(const uint8_t* data, size_t size)
+            {
+                size_t count = 0;
+#if defined(__SSE2__)
+                for (; size - count >= 16; count += 16)
+                {
+                    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + count));
+                    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(block));
+                    if (mask != 0) { return count + std::countr_zero(mask); }
+                }
+#endif
+                for (; size - count >= 8; count += 8)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, data + count, sizeof(word));
+                    uint64_t high = word & 0x8080808080808080ull;
+                    if (high != 0)
+                    {
+                        // the first byte in memory order that has the high bit set
+                        int bit = std::endian::native == std::endian::little ? std::countr_zero(high) : std::countl_zero(high);
+                        return count + bit / 8;
+                    }
+                }
+                while (count < size && data[count] <= 0x7f) { ++count; }
+                return count;
+            }
 
-                return v;
+            // decode all the varints in [data, data+size) into values (which is overwritten).
+            // meant for the serial types of a record header which are almost always single bytes,
+            // so runs of bytes without the high bit set are taken a whole block at a time.
+            // returns false if the last varint runs past size
+            static inline bool readVarInts(const uint8_t* data, size_t size, std::vector<uint64_t>& values)
+            {
+                values.resize(size); // there can't be more varints than bytes, trimmed at the end
+                size_t count = 0;
+                size_t pos = 0;
+                while (pos < size)
+                {
+                    size_t singles = countSingleBytes(data + pos, size - pos);
+                    for (size_t i=0; i<singles; ++i) { values[count++] = data[pos + i]; }
+                    pos += singles;
+                    if (pos >= size) { break; }
+
+                    // a long one, decode it on the scalar path
+                    size_t used = readVarInt(data + pos, size - pos, values[count]);
+                    if (used == 0) { values.resize(count); return false; }
+                    ++count;
+                    pos += used;
+                }
+                values.resize(count);
+                return true;
             }
     };
 
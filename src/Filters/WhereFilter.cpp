@@ -0,0 +1,547 @@
+#include "WhereFilter.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include "Types.h"
+
+using namespace wal::filters;
+
+namespace {
+
+    // a column value in one of sqlite's storage classes
+    struct Value
+    {
+        enum class Class : uint8_t
+        {
+            Null,
+            Integer,
+            Real,
+            Text,
+            Blob
+        };
+
+        Class type = Class::Null;
+        int64_t integer = 0;
+        double real = 0;
+        std::string_view text;
+    };
+
+    size_t integerSize(wal::types::RecordSerialTypes type)
+    {
+        switch (type)
+        {
+            case wal::types::RecordSerialTypes::ByteInt: return 1;
+            case wal::types::RecordSerialTypes::TwoBytesIntBE: return 2;
+            case wal::types::RecordSerialTypes::ThreeBytesIntBE: return 3;
+            case wal::types::RecordSerialTypes::FourBytesIntBE: return 4;
+            case wal::types::RecordSerialTypes::SixBytesIntBE: return 6;
+            case wal::types::RecordSerialTypes::EightBytesIntBE: return 8;
+            default: return 0;
+        }
+    }
+
+    // a column too short for it's serial type (a malformed record) is treated as null
+    Value valueOf(const wal::readers::RecordHeaderDataType& column)
+    {
+        Value value;
+        const auto type = column.getType();
+        const auto raw = column.asRawData();
+        switch (type)
+        {
+            case wal::types::RecordSerialTypes::Zero:
+            case wal::types::RecordSerialTypes::One:
+            case wal::types::RecordSerialTypes::ByteInt:
+            case wal::types::RecordSerialTypes::TwoBytesIntBE:
+            case wal::types::RecordSerialTypes::ThreeBytesIntBE:
+            case wal::types::RecordSerialTypes::FourBytesIntBE:
+            case wal::types::RecordSerialTypes::SixBytesIntBE:
+            case wal::types::RecordSerialTypes::EightBytesIntBE:
+                if (raw.size() < integerSize(type)) { break; }
+                value.type = Value::Class::Integer;
+                value.integer = column.asInt64();
+            break;
+            case wal::types::RecordSerialTypes::FloatBE:
+                if (raw.size() < sizeof(double)) { break; }
+                value.type = Value::Class::Real;
+                value.real = column.asFloat64();
+            break;
+            case wal::types::RecordSerialTypes::String:
+            case wal::types::RecordSerialTypes::Blob:
+                value.type = wal::types::RecordSerialTypes::String == type ? Value::Class::Text : Value::Class::Blob;
+                value.text = { reinterpret_cast<const char*>(raw.data()), raw.size() };
+            break;
+            default:
+            break;
+        }
+        return value;
+    }
+
+    // sql LIKE: % matches any run of characters, _ matches a single byte, ascii letters ignore case
+    bool like(std::string_view pattern, std::string_view text)
+    {
+        auto lower = [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); };
+        size_t p = 0;
+        size_t t = 0;
+        size_t star = std::string_view::npos;
+        size_t mark = 0;
+        while (t < text.size())
+        {
+            if (p < pattern.size() && '%' == pattern[p])
+            {
+                star = p++;
+                mark = t;
+                continue;
+            }
+            if (p < pattern.size() && ('_' == pattern[p] || lower(pattern[p]) == lower(text[t])))
+            {
+                ++p;
+                ++t;
+                continue;
+            }
+            if (std::string_view::npos == star) { return false; }
+            // let the last % take one more character and retry from there
+            p = star + 1;
+            t = ++mark;
+        }
+        while (p < pattern.size() && '%' == pattern[p]) { ++p; }
+        return p == pattern.size();
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y){
+            return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+        });
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        auto first = text.find_first_not_of(' ');
+        if (std::string_view::npos == first) { return {}; }
+        return text.substr(first, text.find_last_not_of(' ') - first + 1);
+    }
+
+    template<typename T>
+    bool parseWhole(std::string_view text, T& value)
+    {
+        if (text.empty()) { return false; }
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return std::errc() == ec && text.data() + text.size() == end;
+    }
+}
+
+// recursive descent over the tokens of the expression, adds the nodes & literals to the filter
+class WhereFilter::Parser
+{
+    public:
+        Parser(std::string_view text, const std::vector<std::string>& columns, std::optional<size_t> rowidColumn, WhereFilter& filter):
+            _columns(columns),
+            _rowidColumn(rowidColumn),
+            _filter(filter)
+        {
+            tokenize(text);
+        }
+
+        size_t parse()
+        {
+            if (Token::Kind::End == peek().kind) { error("empty expression"); }
+            auto root = parseOr();
+            if (Token::Kind::End != peek().kind) { error("unexpected '" + peek().text + "'"); }
+            return root;
+        }
+
+    private:
+        struct Token
+        {
+            enum class Kind : uint8_t
+            {
+                End,
+                Name,
+                QuotedName,
+                String,
+                Number,
+                Symbol,
+                LeftParen,
+                RightParen
+            };
+
+            Kind kind;
+            std::string text;
+            size_t position;
+        };
+
+        const std::vector<std::string>& _columns;
+        std::optional<size_t> _rowidColumn;
+        WhereFilter& _filter;
+        std::vector<Token> _tokens;
+        size_t _current = 0;
+
+        [[noreturn]] void error(const std::string& message) const { throw ParseException(message, peek().position); }
+
+        const Token& peek() const { return _tokens[_current]; }
+
+        const Token& take() { return _tokens[_current < _tokens.size() - 1 ? _current++ : _current]; }
+
+        bool isKeyword(std::string_view keyword) const
+        {
+            return Token::Kind::Name == peek().kind && equalsIgnoreCase(peek().text, keyword);
+        }
+
+        bool takeKeyword(std::string_view keyword)
+        {
+            if (!isKeyword(keyword)) { return false; }
+            take();
+            return true;
+        }
+
+        void tokenize(std::string_view text)
+        {
+            static auto isNameStart = [](char c) { return std::isalpha(static_cast<unsigned char>(c)) || '_' == c; };
+            static auto isNameChar = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || '_' == c || '.' == c; };
+            static auto isDigit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+
+            size_t i = 0;
+            while (i < text.size())
+            {
+                const char c = text[i];
+                const size_t start = i;
+                if (std::isspace(static_cast<unsigned char>(c))) { ++i; continue; }
+
+                if ('(' == c || ')' == c)
+                {
+                    _tokens.push_back({'(' == c ? Token::Kind::LeftParen : Token::Kind::RightParen, std::string(1, c), start});
+                    ++i;
+                    continue;
+                }
+
+                // 'text' with '' as an escaped quote, "name", `name` and [name] are quoted column names
+                if ('\'' == c || '"' == c || '`' == c || '[' == c)
+                {
+                    const char close = '[' == c ? ']' : c;
+                    std::string value;
+                    bool closed = false;
+                    for (++i; i < text.size(); ++i)
+                    {
+                        if (close != text[i]) { value += text[i]; continue; }
+                        if (']' != close && i + 1 < text.size() && close == text[i + 1]) { value += close; ++i; continue; }
+                        closed = true;
+                        ++i;
+                        break;
+                    }
+                    if (!closed) { throw ParseException("unterminated quote", start); }
+                    _tokens.push_back({'\'' == c ? Token::Kind::String : Token::Kind::QuotedName, std::move(value), start});
+                    continue;
+                }
+
+                const bool signedNumber = ('-' == c || '+' == c) && i + 1 < text.size() &&
+                                          (isDigit(text[i + 1]) || '.' == text[i + 1]);
+                if (isDigit(c) || signedNumber || ('.' == c && i + 1 < text.size() && isDigit(text[i + 1])))
+                {
+                    ++i;
+                    while (i < text.size() && (isDigit(text[i]) || '.' == text[i] || 'e' == text[i] || 'E' == text[i] ||
+                                               (('-' == text[i] || '+' == text[i]) && ('e' == text[i - 1] || 'E' == text[i - 1]))))
+                    {
+                        ++i;
+                    }
+                    _tokens.push_back({Token::Kind::Number, std::string(text.substr(start, i - start)), start});
+                    continue;
+                }
+
+                if (isNameStart(c))
+                {
+                    while (i < text.size() && isNameChar(text[i])) { ++i; }
+                    _tokens.push_back({Token::Kind::Name, std::string(text.substr(start, i - start)), start});
+                    continue;
+                }
+
+                static constexpr std::array<std::string_view, 8> symbols = {"==", "!=", "<>", "<=", ">=", "=", "<", ">"};
+                auto symbol = std::find_if(symbols.begin(), symbols.end(), [&](std::string_view s){ return text.substr(i).starts_with(s); });
+                if (symbols.end() == symbol) { throw ParseException(std::string("unexpected character '") + c + "'", start); }
+                _tokens.push_back({Token::Kind::Symbol, std::string(*symbol), start});
+                i += symbol->size();
+            }
+            _tokens.push_back({Token::Kind::End, "end of expression", text.size()});
+        }
+
+        size_t addNode(Op op, size_t left = 0, size_t right = 0)
+        {
+            Node node{op};
+            node.left = left;
+            node.right = right;
+            _filter._nodes.push_back(node);
+            return _filter._nodes.size() - 1;
+        }
+
+        size_t parseOr()
+        {
+            auto left = parseAnd();
+            while (takeKeyword("OR")) { left = addNode(Op::Or, left, parseAnd()); }
+            return left;
+        }
+
+        size_t parseAnd()
+        {
+            auto left = parseNot();
+            while (takeKeyword("AND")) { left = addNode(Op::And, left, parseNot()); }
+            return left;
+        }
+
+        size_t parseNot()
+        {
+            if (takeKeyword("NOT")) { return addNode(Op::Not, parseNot()); }
+            if (Token::Kind::LeftParen == peek().kind)
+            {
+                take();
+                auto inner = parseOr();
+                if (Token::Kind::RightParen != peek().kind) { error("expected ')'"); }
+                take();
+                return inner;
+            }
+            return parseComparison();
+        }
+
+        bool isColumn() const
+        {
+            if (Token::Kind::QuotedName == peek().kind) { return true; }
+            if (Token::Kind::Name != peek().kind) { return false; }
+            static constexpr std::array<std::string_view, 6> keywords = {"AND", "OR", "NOT", "LIKE", "IS", "NULL"};
+            return std::none_of(keywords.begin(), keywords.end(), [this](std::string_view k){ return equalsIgnoreCase(peek().text, k); });
+        }
+
+        bool isLiteral() const { return Token::Kind::String == peek().kind || Token::Kind::Number == peek().kind; }
+
+        size_t parseComparison()
+        {
+            if (isColumn())
+            {
+                const size_t source = resolveColumn(take());
+
+                if (takeKeyword("IS"))
+                {
+                    const bool negate = takeKeyword("NOT");
+                    if (!takeKeyword("NULL")) { error("expected NULL after IS"); }
+                    auto node = addComparison(Op::IsNull, source, 0);
+                    return negate ? addNode(Op::Not, node) : node;
+                }
+
+                const bool negate = takeKeyword("NOT");
+                if (negate && !isKeyword("LIKE")) { error("expected LIKE after NOT"); }
+                if (takeKeyword("LIKE"))
+                {
+                    if (Token::Kind::String != peek().kind) { error("expected a 'pattern' after LIKE"); }
+                    auto node = addComparison(Op::Like, source, addLiteral(take()));
+                    return negate ? addNode(Op::Not, node) : node;
+                }
+
+                const Op op = takeOperator();
+                if (isKeyword("NULL")) { error("comparing with NULL is never true, use IS NULL"); }
+                if (!isLiteral()) { error("expected a number or a 'string'"); }
+                return addComparison(op, source, addLiteral(take()));
+            }
+
+            if (isLiteral())
+            {
+                // literal <op> column is column <reversed op> literal
+                const size_t literal = addLiteral(take());
+                Op op = takeOperator();
+                if (!isColumn()) { error("expected a column name"); }
+                switch (op)
+                {
+                    case Op::Lt: op = Op::Gt; break;
+                    case Op::Le: op = Op::Ge; break;
+                    case Op::Gt: op = Op::Lt; break;
+                    case Op::Ge: op = Op::Le; break;
+                    default: break;
+                }
+                return addComparison(op, resolveColumn(take()), literal);
+            }
+
+            error("expected a column name");
+        }
+
+        Op takeOperator()
+        {
+            if (Token::Kind::Symbol != peek().kind) { error("expected a comparison operator"); }
+            const auto& symbol = take().text;
+            if ("=" == symbol || "==" == symbol) { return Op::Eq; }
+            if ("!=" == symbol || "<>" == symbol) { return Op::Ne; }
+            if ("<" == symbol) { return Op::Lt; }
+            if ("<=" == symbol) { return Op::Le; }
+            if (">" == symbol) { return Op::Gt; }
+            return Op::Ge;
+        }
+
+        size_t addComparison(Op op, size_t source, size_t literal)
+        {
+            auto node = addNode(op);
+            _filter._nodes[node].source = source;
+            _filter._nodes[node].literal = literal;
+            return node;
+        }
+
+        size_t addLiteral(const Token& token)
+        {
+            Literal literal;
+            literal.text = token.text;
+            // from_chars doesn't take a leading +
+            if (Token::Kind::Number == token.kind && literal.text.starts_with('+')) { literal.text.erase(0, 1); }
+            if (parseWhole(literal.text, literal.integer))
+            {
+                literal.isNumber = true;
+                literal.isInteger = true;
+                literal.real = static_cast<double>(literal.integer);
+            }
+            else if (parseWhole(literal.text, literal.real))
+            {
+                literal.isNumber = true;
+            }
+            else if (Token::Kind::Number == token.kind)
+            {
+                throw ParseException("malformed number '" + token.text + "'", token.position);
+            }
+
+            _filter._literals.push_back(std::move(literal));
+            return _filter._literals.size() - 1;
+        }
+
+        size_t resolveColumn(const Token& token)
+        {
+            auto it = std::find_if(_columns.begin(), _columns.end(), [&token](const std::string& column){ return trim(column) == token.text; });
+            if (_columns.end() == it)
+            {
+                static constexpr std::array<std::string_view, 3> rowidNames = {"rowid", "_rowid_", "oid"};
+                auto isRowid = std::any_of(rowidNames.begin(), rowidNames.end(), [&token](std::string_view n){ return equalsIgnoreCase(token.text, n); });
+                if (isRowid) { return rowidSource; }
+                throw ParseException("unknown column '" + token.text + "'", token.position);
+            }
+
+            const size_t column = static_cast<size_t>(std::distance(_columns.begin(), it));
+            // the column is stored as null, the value is the rowid
+            if (_rowidColumn && *_rowidColumn == column) { return rowidSource; }
+            if (std::find(_filter._columns.begin(), _filter._columns.end(), column) == _filter._columns.end()) { _filter._columns.push_back(column); }
+            return column;
+        }
+};
+
+WhereFilter::WhereFilter(std::string_view expression,
+                         const std::vector<std::string>& columns,
+                         std::optional<size_t> rowidColumn)
+{
+    Parser parser(expression, columns, rowidColumn, *this);
+    _root = parser.parse();
+}
+
+bool WhereFilter::matches(const readers::RecordHeaderReader::RecordData& record) const
+{
+    return Truth::True == evaluate(_root, record);
+}
+
+WhereFilter::Truth WhereFilter::evaluate(size_t index, const readers::RecordHeaderReader::RecordData& record) const
+{
+    const auto& node = _nodes[index];
+    switch (node.op)
+    {
+        case Op::And:
+        {
+            auto left = evaluate(node.left, record);
+            if (Truth::False == left) { return Truth::False; }
+            auto right = evaluate(node.right, record);
+            if (Truth::False == right) { return Truth::False; }
+            return Truth::True == left && Truth::True == right ? Truth::True : Truth::Null;
+        }
+        case Op::Or:
+        {
+            auto left = evaluate(node.left, record);
+            if (Truth::True == left) { return Truth::True; }
+            auto right = evaluate(node.right, record);
+            if (Truth::True == right) { return Truth::True; }
+            return Truth::False == left && Truth::False == right ? Truth::False : Truth::Null;
+        }
+        case Op::Not:
+        {
+            auto operand = evaluate(node.left, record);
+            if (Truth::Null == operand) { return Truth::Null; }
+            return Truth::True == operand ? Truth::False : Truth::True;
+        }
+        default:
+            return compare(node, record);
+    }
+}
+
+WhereFilter::Truth WhereFilter::compare(const Node& node, const readers::RecordHeaderReader::RecordData& record) const
+{
+    Value value;
+    if (rowidSource == node.source)
+    {
+        // a carved record's rowid can be unknown, it's null then
+        if (record.rowidKnown)
+        {
+            value.type = Value::Class::Integer;
+            value.integer = record.rowid;
+        }
+    }
+    // in lenient mode a record can have less columns than the schema, the missing ones are null
+    else if (node.source < record.headerData.size())
+    {
+        value = valueOf(record.headerData[node.source]);
+    }
+
+    if (Op::IsNull == node.op) { return Value::Class::Null == value.type ? Truth::True : Truth::False; }
+    if (Value::Class::Null == value.type) { return Truth::Null; }
+
+    const auto& literal = _literals[node.literal];
+    auto truth = [](bool b) { return b ? Truth::True : Truth::False; };
+
+    if (Op::Like == node.op)
+    {
+        std::array<char, 32> buffer;
+        std::string_view text = value.text;
+        if (Value::Class::Integer == value.type || Value::Class::Real == value.type)
+        {
+            auto result = Value::Class::Integer == value.type ? std::to_chars(buffer.begin(), buffer.end(), value.integer)
+                                                               : std::to_chars(buffer.begin(), buffer.end(), value.real);
+            text = { buffer.data(), static_cast<size_t>(result.ptr - buffer.data()) };
+        }
+        return truth(like(literal.text, text));
+    }
+
+    // numbers sort before text and text before blobs, like sqlite
+    int order = 0;
+    switch (value.type)
+    {
+        case Value::Class::Integer:
+        case Value::Class::Real:
+            if (!literal.isNumber) { order = -1; }
+            else if (Value::Class::Integer == value.type && literal.isInteger)
+            {
+                order = value.integer < literal.integer ? -1 : (value.integer > literal.integer ? 1 : 0);
+            }
+            else
+            {
+                const double real = Value::Class::Integer == value.type ? static_cast<double>(value.integer) : value.real;
+                order = real < literal.real ? -1 : (real > literal.real ? 1 : 0);
+            }
+        break;
+        case Value::Class::Text:
+        {
+            auto result = value.text.compare(literal.text);
+            order = result < 0 ? -1 : (result > 0 ? 1 : 0);
+        }
+        break;
+        default:
+            order = 1;
+        break;
+    }
+
+    switch (node.op)
+    {
+        case Op::Eq: return truth(order == 0);
+        case Op::Ne: return truth(order != 0);
+        case Op::Lt: return truth(order < 0);
+        case Op::Le: return truth(order <= 0);
+        case Op::Gt: return truth(order > 0);
+        case Op::Ge: return truth(order >= 0);
+        default: return Truth::Null;
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include "Readers/RecordHeaderReader.h"
+
+namespace wal::filters {
+
+    // a row filter like the WHERE clause of a query i.e. "col3 > 100 AND col5 LIKE 'abc%'".
+    // the expression is compiled once against the columns of the output format into a plan of typed
+    // comparisons, which is evaluated on the raw columns of a record before anything is formatted.
+    //
+    // supported: column <op> literal (or literal <op> column) with =, ==, !=, <>, <, <=, >, >=,
+    // [NOT] LIKE with % and _ (ascii case insensitive), IS [NOT] NULL, AND, OR, NOT and parentheses.
+    // literals are integers, reals and 'strings'. the rowid can be used as rowid/_rowid_/oid
+    // when no column has that name
+    class WhereFilter
+    {
+        public:
+            class ParseException : public std::runtime_error
+            {
+                public:
+                    ParseException(const std::string& message, size_t position):
+                        std::runtime_error(message + " at position " + std::to_string(position)),
+                        _position(position) {}
+                    size_t position() const { return _position; }
+                private:
+                    size_t _position;
+            };
+
+            // throws ParseException if the expression is malformed or names a column that isn't in columns
+            WhereFilter(std::string_view expression,
+                        const std::vector<std::string>& columns,
+                        std::optional<size_t> rowidColumn = std::nullopt);
+            ~WhereFilter() = default;
+
+            // a row whose expression is null (i.e. compares a null column) doesn't match, like in sqlite
+            bool matches(const readers::RecordHeaderReader::RecordData& record) const;
+
+            // the record columns the expression reads, they have to be decoded for matches()
+            const std::vector<size_t>& columns() const { return _columns; }
+
+        private:
+            enum class Op : uint8_t
+            {
+                Eq,
+                Ne,
+                Lt,
+                Le,
+                Gt,
+                Ge,
+                Like,
+                IsNull,
+                And,
+                Or,
+                Not
+            };
+
+            enum class Truth : uint8_t
+            {
+                False,
+                True,
+                Null
+            };
+
+            // a literal in every class it converts to without loss, it's compared in the class of the
+            // column value when it can be (the way sqlite applies a column's affinity)
+            struct Literal
+            {
+                bool isNumber = false;
+                bool isInteger = false;
+                int64_t integer = 0;
+                double real = 0;        // set for integers as well
+                std::string text;       // numbers keep the text they were written with
+            };
+
+            static constexpr size_t rowidSource = static_cast<size_t>(-1);
+
+            // a comparison reads source (a record column or the rowid), And/Or/Not combine the nodes at left/right
+            struct Node
+            {
+                Op op;
+                size_t source = rowidSource;
+                size_t literal = 0;
+                size_t left = 0;
+                size_t right = 0;
+            };
+
+            class Parser;
+
+            Truth evaluate(size_t node, const readers::RecordHeaderReader::RecordData& record) const;
+            Truth compare(const Node& node, const readers::RecordHeaderReader::RecordData& record) const;
+
+            std::vector<Node> _nodes;
+            std::vector<Literal> _literals;
+            std::vector<size_t> _columns;
+            size_t _root = 0;
+    };
+}
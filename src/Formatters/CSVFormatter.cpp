@@ -12,11 +12,10 @@ using namespace wal::formatters;
 // self register this formatterto the factory - using the static intialization order
 Formatter* CSVFormatter::_ref = Factory::instance().registerFormatter(CSVFormatter::id, new CSVFormatter() );
 
-std::string CSVFormatter::generateOutput(const readers::RecordHeaderReader::RecordData& record)
+void CSVFormatter::generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out)
 {
     // output data:
     constexpr auto COMMA = ", ";
-    size_t columnIndex = 0;
     std::stringstream ss;
     std::string comma = "";
 
@@ -24,30 +23,31 @@ std::string CSVFormatter::generateOutput(const readers::RecordHeaderReader::Reco
     // parse content:
     if ( didInputChange() )
     {
-        _tableColumns.clear();
-        parseColumns();
-
-        for (const auto& column: _tableColumns)
-        {
-            ss << comma;
-            ss << column;
-            comma = COMMA;
-        }
-
-        if (!_tableColumns.empty()) { ss << std::endl; }
-
-        comma = "";
+        auto header = prepare();
+        if (!header.empty()) { ss << header << std::endl; }
     }
 
     if (record.headerData.size() != _tableColumns.size() && _strict) 
     { 
         Log::get().err() << "mismatch between given csv columns and data on file: expected " << _tableColumns.size() << " columns got: " << record.headerData.size() << ". skipping...";
-        return ss.str();
+        out = ss.str();
+        return;
     }
 
-    for (auto& rec : record.headerData)
+    const size_t outputColumns = _projection.empty() ? record.headerData.size() : _projection.size();
+    for (size_t i = 0; i < outputColumns; ++i)
     {
+        const size_t columnIndex = _projection.empty() ? i : _projection[i];
         ss << comma ;
+        comma = COMMA;
+        // in lenient mode a record can have less columns than the header
+        if (columnIndex >= record.headerData.size())
+        {
+            ss << "NULL";
+            continue;
+        }
+
+        const auto& rec = record.headerData[columnIndex];
         switch (rec.getType())
         {
             case wal::types::RecordSerialTypes::Null:
@@ -55,7 +55,7 @@ std::string CSVFormatter::generateOutput(const readers::RecordHeaderReader::Reco
             break;
             case wal::types::RecordSerialTypes::Blob:
             {
-                auto data = rec.asData();
+                auto data = rec.asRawData();
                 if (!data.empty())
                 {
                     ss << "0x";
@@ -64,7 +64,7 @@ std::string CSVFormatter::generateOutput(const readers::RecordHeaderReader::Reco
             }
             break;
             case wal::types::RecordSerialTypes::String:
-                ss << "\"" << rec.asString() << "\"";
+                ss << "\"" << rec.asStringView() << "\"";
             break;
             case wal::types::RecordSerialTypes::One:
             case wal::types::RecordSerialTypes::Zero:
@@ -86,12 +86,39 @@ std::string CSVFormatter::generateOutput(const readers::RecordHeaderReader::Reco
                 throw CSVFormatterException(ss.str(), CSVFormatterException::ErrorCode::UnexpectedColumnType);
             }
         }
-        comma = COMMA;
-        ++columnIndex;
     }
-    return ss.str();
+    out = ss.str();
 }
 
+std::string CSVFormatter::prepare()
+{
+    if ( !didInputChange() ) { return {}; }
+
+    constexpr auto COMMA = ", ";
+    std::string header;
+    std::string comma = "";
+
+    _tableColumns.clear();
+    parseColumns();
+    resolveProjection(_tableColumns);
+
+    if (_projection.empty())
+    {
+        for (const auto& column: _tableColumns)
+        {
+            header += comma;
+            header += column;
+            comma = COMMA;
+        }
+    }
+    for (auto index : _projection)
+    {
+        header += comma;
+        header += _tableColumns[index];
+        comma = COMMA;
+    }
+    return header;
+}
 
 void CSVFormatter::parseColumns()
 {
@@ -21,7 +21,14 @@ namespace wal::formatters {
             CSVFormatter() = default;
             ~CSVFormatter() = default;
 
-            std::string generateOutput(const readers::RecordHeaderReader::RecordData& record) override;
+            std::string prepare() override;
+
+            using Formatter::generateOutput;
+            void generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out) override;
+
+            std::string comment(std::string_view text) const override { return std::string("# ") + std::string(text); }
+
+            const std::vector<std::string>& columnNames() const override { return _tableColumns; }
 
             static constexpr int id = 20; // the id in the factory when self registering
         private:
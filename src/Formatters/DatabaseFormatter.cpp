@@ -0,0 +1,108 @@
+#include "DatabaseFormatter.h"
+#include <sstream>
+#include "Factory.h"
+#include "Types.h"
+
+using namespace wal::formatters;
+
+namespace {
+
+    void appendValue(std::string& out, DatabaseFormatter::ValueType type, const void* data, size_t size)
+    {
+        out += static_cast<char>(type);
+        out.append(static_cast<const char*>(data), size);
+    }
+
+    void appendBytes(std::string& out, DatabaseFormatter::ValueType type, std::span<const uint8_t> data)
+    {
+        const auto length = static_cast<uint32_t>(data.size());
+        appendValue(out, type, &length, sizeof(length));
+        out.append(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+}
+
+// self register this formatter to the factory - using the static intialization order
+Formatter* DatabaseFormatter::_ref = Factory::instance().registerFormatter(DatabaseFormatter::id, new DatabaseFormatter() );
+
+void DatabaseFormatter::buildInsertStatement()
+{
+    const auto& columns = columnNames();
+    std::string names;
+    std::string parameters;
+    auto addColumn = [&](const std::string& name)
+    {
+        if (!names.empty())
+        {
+            names += ", ";
+            parameters += ", ";
+        }
+        names += name;
+        parameters += "?";
+    };
+    if (_projection.empty()) { std::ranges::for_each(columns, addColumn); }
+    for (auto index : _projection) { addColumn(columns[index]); }
+    // rows are loaded in frame order, a later version of a row replaces the one before it
+    _insertStatement = "INSERT OR REPLACE INTO " + tableName() + " (" + names + ") VALUES (" + parameters + ")";
+}
+
+void DatabaseFormatter::generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out)
+{
+    prepare();
+    out.clear();
+    if (!checkRecord(record)) { return; }
+
+    // every row has the same columns as the statement, the ones missing from the record are null
+    out += rowMarker;
+    for (const auto& column : _outputColumns)
+    {
+        if (column.recordIndex >= record.headerData.size())
+        {
+            out += static_cast<char>(ValueType::Null);
+            continue;
+        }
+
+        const auto& rec = record.headerData[column.recordIndex];
+        switch (rec.getType())
+        {
+            case wal::types::RecordSerialTypes::Null:
+                if (column.rowid && record.rowidKnown)
+                {
+                    const auto rowid = record.rowid;
+                    appendValue(out, ValueType::Integer, &rowid, sizeof(rowid));
+                }
+                else { out += static_cast<char>(ValueType::Null); }
+            break;
+            case wal::types::RecordSerialTypes::Blob:
+                appendBytes(out, ValueType::Blob, rec.asRawData());
+            break;
+            case wal::types::RecordSerialTypes::String:
+                appendBytes(out, ValueType::Text, rec.asRawData());
+            break;
+            case wal::types::RecordSerialTypes::One:
+            case wal::types::RecordSerialTypes::Zero:
+            case wal::types::RecordSerialTypes::ByteInt:
+            case wal::types::RecordSerialTypes::TwoBytesIntBE:
+            case wal::types::RecordSerialTypes::ThreeBytesIntBE:
+            case wal::types::RecordSerialTypes::FourBytesIntBE:
+            case wal::types::RecordSerialTypes::SixBytesIntBE:
+            case wal::types::RecordSerialTypes::EightBytesIntBE:
+            {
+                const auto value = rec.asInt64();
+                appendValue(out, ValueType::Integer, &value, sizeof(value));
+            }
+            break;
+            case wal::types::RecordSerialTypes::FloatBE:
+            {
+                const auto value = rec.asFloat64();
+                appendValue(out, ValueType::Real, &value, sizeof(value));
+            }
+            break;
+            default:
+            {
+                std::stringstream ss;
+                ss << "unexpected column type on generateOutput: " << rec.getType();
+                throw SchemaFormatterException(ss.str(), SchemaFormatterException::ErrorCode::UnexpectedColumnType);
+            }
+        }
+    }
+}
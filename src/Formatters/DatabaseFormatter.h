@@ -0,0 +1,84 @@
+#pragma once
+#include "SchemaFormatter.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace wal::formatters {
+
+    // formats rows for the DatabaseWriter, the values are kept in a compact binary form instead of text
+    // so they can be bound to a prepared statement as they are. a row is a 0 byte followed by every output
+    // column as a ValueType byte and it's value: 8 bytes of int64/double (host order) or a 4 byte size and
+    // the bytes of text/blob. the 0 byte can't be part of a comment, so rows preceded by one (carved rows) are still found
+    class DatabaseFormatter: public SchemaFormatter
+    {
+        public:
+            enum class ValueType: uint8_t
+            {
+                Null,
+                Integer,
+                Real,
+                Text,
+                Blob
+            };
+
+            static constexpr char rowMarker = '\0';
+
+            DatabaseFormatter() = default;
+            ~DatabaseFormatter() = default;
+
+            using Formatter::generateOutput;
+            void generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out) override;
+
+            // the database gets no comments
+            std::string comment(std::string_view) const override { return {}; }
+
+            // "INSERT OR REPLACE INTO <table> (<output columns>) VALUES (?, ...)", valid after prepare()
+            const std::string& insertStatement() const { return _insertStatement; }
+
+            // call onValue(ValueType, value bytes) for every column of a row, false if the row is malformed
+            template<typename F>
+            static bool readRow(std::string_view row, F&& onValue)
+            {
+                auto pos = row.find(rowMarker);
+                if (std::string_view::npos == pos) { return false; }
+                for (++pos; pos < row.size(); )
+                {
+                    const auto type = static_cast<ValueType>(row[pos++]);
+                    size_t size = 0;
+                    switch (type)
+                    {
+                        case ValueType::Null: break;
+                        case ValueType::Integer:
+                        case ValueType::Real: size = sizeof(uint64_t); break;
+                        case ValueType::Text:
+                        case ValueType::Blob:
+                        {
+                            uint32_t length = 0;
+                            if (row.size() - pos < sizeof(length)) { return false; }
+                            std::memcpy(&length, row.data() + pos, sizeof(length));
+                            pos += sizeof(length);
+                            size = length;
+                        }
+                        break;
+                        default: return false;
+                    }
+                    if (row.size() - pos < size) { return false; }
+                    onValue(type, row.substr(pos, size));
+                    pos += size;
+                }
+                return true;
+            }
+
+            static constexpr int id = 30; // the id in the factory when self registering
+
+        protected:
+            void buildInsertStatement() override;
+
+        private:
+            static Formatter* _ref;
+
+            std::string _insertStatement;
+    };
+}
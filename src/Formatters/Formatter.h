@@ -1,6 +1,11 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <optional>
 #include "Readers/RecordHeaderReader.h"
 #include "Input/InputType.h"
 
@@ -29,8 +34,45 @@ namespace wal::formatters {
             }
             void strictMode() { _strict = true; }
             void lenientMode() { _strict = false; }
+
+            static constexpr short unknownColumnError = 100;
+
+            // output only the named columns in the given order (empty for all), names are resolved
+            // against the columns of the input by prepare(), which throws if one of them isn't there
+            void setProjection(std::vector<std::string> names)
+            {
+                _projectionNames = std::move(names);
+                _inputChanged = true;
+            }
+
+            // the record columns that are output, by their position in the record. empty if all of them are,
+            // valid after prepare(). the other columns don't have to be decoded
+            const std::vector<bool>& projectionMask() const { return _projectionMask; }
+
+            // names of the record columns by their position in the record, valid after prepare()
+            virtual const std::vector<std::string>& columnNames() const = 0;
+
+            // the column that is an alias of the rowid (it's stored as null in the record), if there is one
+            virtual std::optional<size_t> rowidColumn() const { return std::nullopt; }
             
-            virtual std::string generateOutput(const wal::readers::RecordHeaderReader::RecordData& record) = 0;
+            // parse the input if it changed, returns text that should precede all rows (empty if there is none).
+            // generateOutput does this on it's own, but it has to be called once before generateOutput is
+            // used from several threads at the same time
+            virtual std::string prepare() = 0;
+
+            // formats the row into out, replacing what it held (left empty if the row isn't output). the same
+            // string can be passed for every row so it's capacity is reused
+            virtual void generateOutput(const wal::readers::RecordHeaderReader::RecordData& record, std::string& out) = 0;
+
+            std::string generateOutput(const wal::readers::RecordHeaderReader::RecordData& record)
+            {
+                std::string out;
+                generateOutput(record, out);
+                return out;
+            }
+
+            // a line of free text in the output format (i.e. to mark where a transaction starts)
+            virtual std::string comment(std::string_view text) const = 0;
         protected:
             inputs::InputType* getInput() 
             {
@@ -40,10 +82,30 @@ namespace wal::formatters {
             }
 
             bool didInputChange() { return _inputChanged; }
-            
+
+            // map the projection names to positions in columns, called by prepare() once the input is parsed
+            void resolveProjection(const std::vector<std::string>& columns)
+            {
+                _projection.clear();
+                _projectionMask.clear();
+                if (_projectionNames.empty()) { return; }
+
+                _projectionMask.resize(columns.size(), false);
+                for (const auto& name : _projectionNames)
+                {
+                    auto it = std::find(columns.begin(), columns.end(), name);
+                    if (columns.end() == it) { throw FormatterException("unknown column in projection: " + name, unknownColumnError); }
+                    _projection.push_back(std::distance(columns.begin(), it));
+                    _projectionMask[_projection.back()] = true;
+                }
+            }
+
             bool _strict = true;
+            std::vector<size_t> _projection;      // positions of the output columns in the record, empty for all
+            std::vector<bool> _projectionMask;
         private:
             bool _inputChanged = false;
             std::unique_ptr<inputs::InputType> _input = nullptr;
+            std::vector<std::string> _projectionNames;
     };
 }
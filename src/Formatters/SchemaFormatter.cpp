@@ -6,6 +6,8 @@
 #include <cctype>
 #include <algorithm>
 #include <ranges>
+#include <array>
+#include <charconv>
 #include "Factory.h"
 #include "Types.h"
 #include "Utils/Log.h"
@@ -108,6 +110,21 @@ namespace {
         return it;
     }
 
+    void appendInteger(std::string& out, int64_t value, int base)
+    {
+        std::array<char, 24> digits;
+        auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value, base);
+        out.append(digits.data(), result.ptr);
+    }
+
+    // the same text a default formatted stream writes (%g with 6 digits)
+    void appendFloat(std::string& out, wal::converters::float64_t value)
+    {
+        std::array<char, 32> digits;
+        auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value, std::chars_format::general, 6);
+        out.append(digits.data(), result.ptr);
+    }
+
     void clearAllParentheses(std::string& buffer)
     {
         int parenthesesCount = 0;
@@ -134,38 +151,54 @@ void SchemaFormatter::reset()
 {
     _primaryKeyIndex = noPrimaryKeyIndex;
     _tableName = "";
+    _createStatement.clear();
+    _insertPrefix.clear();
+    _outputColumns.clear();
     _columnNames.clear();
     _buffer.clear();
 }
 
-std::string SchemaFormatter::generateOutput(const readers::RecordHeaderReader::RecordData& record)
+std::string SchemaFormatter::prepare()
 {
-    // parse content:
     if ( didInputChange() )
     {
         reset();
         _buffer = getInput()->getInputData();
         parseSchema();
+        resolveProjection(_columnNames);
+        // the primary key column is checked for every row, even if it's not output
+        if (!_projectionMask.empty() && _primaryKeyIndex < _projectionMask.size()) { _projectionMask[_primaryKeyIndex] = true; }
+        auto addOutputColumn = [this](size_t index) { _outputColumns.push_back({ index, index == _primaryKeyIndex }); };
+        if (_projection.empty()) { for (size_t i = 0; i < _columnNames.size(); ++i) { addOutputColumn(i); } }
+        std::ranges::for_each(_projection, addOutputColumn);
+        buildInsertStatement();
     }
+    return {};
+}
 
-    if (record.headerData.size() != _columnNames.size() && _strict)
-    {
-        Log::get().err() << "mismatch between given schema and data on file: expected " << _columnNames.size() << " tuples got: " << record.headerData.size() << ". skipping...";
-        return {};
-    }
-    // output data:
+void SchemaFormatter::buildInsertStatement()
+{
     constexpr auto COMMA = ", ";
-    size_t columnIndex = 0;
-    std::stringstream ss;
-    ss << "INSERT INTO " << _tableName << " (" ;
+    _insertPrefix = "INSERT INTO " + _tableName + " (";
     std::string comma = "";
-    for (auto& colname : _columnNames)
+    auto addColumn = [&](const std::string& name)
     {
-        ss << comma << colname;
+        _insertPrefix += comma;
+        _insertPrefix += name;
         comma = COMMA;
+    };
+    if (_projection.empty()) { std::ranges::for_each(_columnNames, addColumn); }
+    for (auto index : _projection) { addColumn(_columnNames[index]); }
+    _insertPrefix += ") VALUES (";
+}
+
+bool SchemaFormatter::checkRecord(const readers::RecordHeaderReader::RecordData& record) const
+{
+    if (record.headerData.size() != _columnNames.size() && _strict)
+    {
+        Log::get().err() << "mismatch between given schema and data on file: expected " << _columnNames.size() << " tuples got: " << record.headerData.size() << ". skipping...";
+        return false;
     }
-    ss << ") VALUES (";
-    comma = "";
 
     // verify that the primary key position is a null value
     if ( _primaryKeyIndex != noPrimaryKeyIndex &&
@@ -173,28 +206,62 @@ std::string SchemaFormatter::generateOutput(const readers::RecordHeaderReader::R
     {
         throw SchemaFormatterException("Primary key invalid position", errorCode::InvalidPrimaryKeyPosition );
     }
+    return true;
+}
 
-    for (auto& rec : record.headerData)
+void SchemaFormatter::generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out)
+{
+    // parse content:
+    prepare();
+
+    out.clear();
+    if (!checkRecord(record)) { return; }
+    out += _insertPrefix;
+
+    // the rowid is written in hex right after a blob, that's what the output always was
+    bool hex = false;
+    constexpr std::string_view COMMA = ", ";
+
+    // without a projection a record in lenient mode can have more columns than the schema, all of them are output
+    const size_t outputColumns = _projection.empty() ? record.headerData.size() : _outputColumns.size();
+    for (size_t i = 0; i < outputColumns; ++i)
     {
-        ss << comma ;
+        const auto column = i < _outputColumns.size() ? _outputColumns[i] : OutputColumn{ i, false };
+        if (i > 0) { out += COMMA; }
+        // in lenient mode a record can have less columns than the schema
+        if (column.recordIndex >= record.headerData.size())
+        {
+            out += "NULL";
+            continue;
+        }
+
+        const auto& rec = record.headerData[column.recordIndex];
         switch (rec.getType())
         {
             case wal::types::RecordSerialTypes::Null:
-                if (columnIndex == _primaryKeyIndex) { ss << record.rowid; }
-                else { ss << "NULL"; }
+                if (column.rowid && record.rowidKnown) { appendInteger(out, record.rowid, hex ? 16 : 10); }
+                else { out += "NULL"; }
             break;
             case wal::types::RecordSerialTypes::Blob:
             {
-                auto data = rec.asData();
+                // every byte is written as a zero padded character, not as hex digits
+                auto data = rec.asRawData();
                 if (!data.empty())
                 {
-                    ss << "0x";
-                    for (auto b : data) { ss << std::setfill('0') << std::setw(2) << std::hex << b; }
+                    out += "0x";
+                    for (auto b : data)
+                    {
+                        out += '0';
+                        out += static_cast<char>(b);
+                    }
+                    hex = true;
                 }
             }
             break;
             case wal::types::RecordSerialTypes::String:
-                ss << "\"" << rec.asString() << "\"";
+                out += '"';
+                out += rec.asStringView();
+                out += '"';
             break;
             case wal::types::RecordSerialTypes::One:
             case wal::types::RecordSerialTypes::Zero:
@@ -202,12 +269,14 @@ std::string SchemaFormatter::generateOutput(const readers::RecordHeaderReader::R
             case wal::types::RecordSerialTypes::TwoBytesIntBE:
             case wal::types::RecordSerialTypes::ThreeBytesIntBE:
             case wal::types::RecordSerialTypes::FourBytesIntBE:
-                ss << std::dec << rec.asUInt32();
+                appendInteger(out, rec.asUInt32(), 10);
+                hex = false;
             break;
             case wal::types::RecordSerialTypes::SixBytesIntBE:
             case wal::types::RecordSerialTypes::EightBytesIntBE:
             case wal::types::RecordSerialTypes::FloatBE:
-                ss << std::dec << rec.asFloat64();
+                appendFloat(out, rec.asFloat64());
+                hex = false;
             break;
             default:
             {
@@ -216,11 +285,8 @@ std::string SchemaFormatter::generateOutput(const readers::RecordHeaderReader::R
                 throw SchemaFormatterException(ss.str(), errorCode::UnexpectedColumnType);
             }
         }
-        comma = COMMA;
-        ++columnIndex;
     }
-    ss << ");";
-    return ss.str();
+    out += ");";
 }
 
 void SchemaFormatter::parseSchema()
@@ -236,6 +302,7 @@ void SchemaFormatter::parseSchema()
         if (statementView.empty()) { continue; }
         std::string statement{&*statementView.begin(), static_cast<size_t>(std::ranges::distance(statementView)) };
 
+        _createStatement = statement;
         auto it = statement.cbegin();
         for (auto& token : pattern)
         {
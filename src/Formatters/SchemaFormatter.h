@@ -41,10 +41,46 @@ namespace wal::formatters {
             SchemaFormatter() = default;
             ~SchemaFormatter() = default;
 
-            std::string generateOutput(const readers::RecordHeaderReader::RecordData& record) override;
+            std::string prepare() override;
+
+            using Formatter::generateOutput;
+            void generateOutput(const readers::RecordHeaderReader::RecordData& record, std::string& out) override;
+
+            std::string comment(std::string_view text) const override { return std::string("-- ") + std::string(text); }
+
+            const std::vector<std::string>& columnNames() const override { return _columnNames; }
+
+            const std::string& tableName() const { return _tableName; }
+
+            // the CREATE TABLE statement the columns were parsed from (without it's ';'), valid after prepare()
+            const std::string& createStatement() const { return _createStatement; }
+
+            std::optional<size_t> rowidColumn() const override
+            {
+                if (noPrimaryKeyIndex == _primaryKeyIndex) { return std::nullopt; }
+                return _primaryKeyIndex;
+            }
 
             static constexpr int id = 10; // the id in the factory when self registering
 
+        protected:
+            // false if the record doesn't fit the schema in strict mode, throws if the primary key column isn't null
+            bool checkRecord(const readers::RecordHeaderReader::RecordData& record) const;
+
+            // called by prepare() once the schema is parsed, builds the statement up to the values (it's the same for every row)
+            virtual void buildInsertStatement();
+
+            // an output column, in output order. built by prepare() so rows don't resolve the projection again
+            struct OutputColumn
+            {
+                size_t recordIndex;     // position of the column in the record
+                bool rowid;             // alias of the rowid, stored as null in the record
+            };
+
+            static constexpr size_t noPrimaryKeyIndex = -1;
+            size_t _primaryKeyIndex = noPrimaryKeyIndex;
+            std::vector<OutputColumn> _outputColumns;
+
         private:
             void reset();
             void parseSchema();
@@ -59,7 +95,7 @@ namespace wal::formatters {
             std::string _buffer;
             std::vector<std::string> _columnNames;
             std::string _tableName;
-            size_t _primaryKeyIndex = noPrimaryKeyIndex;
-            static constexpr size_t noPrimaryKeyIndex = -1;
+            std::string _insertPrefix;
+            std::string _createStatement;
     };
 }
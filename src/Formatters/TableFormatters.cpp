@@ -0,0 +1,42 @@
+#include "TableFormatters.h"
+#include "SchemaFormatter.h"
+#include "Input/StringInput.h"
+#include "Utils/Log.h"
+
+using namespace wal::formatters;
+
+TableFormatters::TableFormatters(const readers::TableMap& tables):
+    _tables(tables)
+{}
+
+size_t TableFormatters::prepare(bool strict)
+{
+    size_t prepared = 0;
+    _formatters.clear();
+    for (const auto& table : _tables.tables())
+    {
+        auto formatter = std::make_unique<SchemaFormatter>();
+        if (strict) { formatter->strictMode(); }
+        else { formatter->lenientMode(); }
+        formatter->setInput(std::make_unique<inputs::StringInput>(table.sql));
+        try
+        {
+            formatter->prepare();
+            ++prepared;
+        }
+        catch(const Formatter::FormatterException& e)
+        {
+            wal::Log::get().err() << "Failed to parse the schema of table " << table.name << " due to: " << e.what() << ", it's rows are skipped";
+            formatter.reset();
+        }
+        _formatters.push_back(std::move(formatter));
+    }
+    return prepared;
+}
+
+Formatter* TableFormatters::forPage(uint32_t pageNumber) const
+{
+    auto table = _tables.tableOf(pageNumber);
+    if (!table || table.value() >= _formatters.size()) { return nullptr; }
+    return _formatters[table.value()].get();
+}
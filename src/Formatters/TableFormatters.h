@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Formatter.h"
+#include "Readers/TableMap.h"
+
+namespace wal::formatters {
+
+    // a SchemaFormatter for every table of a database, rows are routed to the formatter
+    // of the table that owns the page they were read from
+    class TableFormatters
+    {
+        public:
+            explicit TableFormatters(const readers::TableMap& tables);
+            ~TableFormatters() = default;
+
+            // parse the schema of every table, tables whose schema can't be parsed are skipped.
+            // returns the number of tables rows can be output for
+            size_t prepare(bool strict);
+
+            // null if the page isn't part of a table (or the table's schema couldn't be parsed)
+            Formatter* forPage(uint32_t pageNumber) const;
+
+        private:
+            const readers::TableMap& _tables;
+            std::vector<std::unique_ptr<Formatter>> _formatters; // by table index
+    };
+}
@@ -0,0 +1,166 @@
+#include "BatchRunner.h"
+#include <fstream>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+#include <future>
+#include <fnmatch.h>
+#include <deque>
+#include "Utils/Log.h"
+#include "Utils/MappedFile.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/Trace.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/WalPageMap.h"
+#include "Readers/PageSource.h"
+#include "Writers/SortedWriter.h"
+#include "Writers/StreamWriter.h"
+#include "Writers/BatchInsertWriter.h"
+#include "Converters/Endian.h"
+
+using namespace wal::pipeline;
+
+BatchRunner::BatchRunner(formatters::Formatter& formatter, Options options, size_t threads):
+    _formatter(formatter),
+    _options(std::move(options)),
+    _threads(std::max<size_t>(threads, 1))
+{}
+
+size_t BatchRunner::run(const std::vector<std::filesystem::path>& files, std::ostream& out)
+{
+    ThreadPool pool(std::min(_threads, std::max<size_t>(files.size(), 1)));
+    const size_t maxPending = pool.size() * pendingFilesPerThread;
+    std::deque<std::future<std::string>> pending;
+    size_t written = 0;
+    size_t failed = 0;
+
+    // blocks are written in the order of the files as soon as they are done, later files keep decoding meanwhile
+    auto drainFront = [&]()
+    {
+        const auto& file = files[written++];
+        auto result = std::move(pending.front());
+        pending.pop_front();
+        try
+        {
+            auto output = result.get();
+            if (_options.outputDir.empty())
+            {
+                out << _formatter.comment("file " + file.string()) << '\n' << output;
+            }
+            wal::Log::get().info() << "parsed " << file;
+        }
+        catch(const std::exception& e)
+        {
+            wal::Log::get().err() << "Failed to parse " << file << ": " << e.what();
+            ++failed;
+        }
+    };
+
+    for (size_t index = 0; index < files.size(); ++index)
+    {
+        pending.push_back(pool.submit([this, &file = files[index], index]() -> std::string
+        {
+            Trace::Scope scope("file", "file", index);
+            if (_options.outputDir.empty())
+            {
+                std::ostringstream output;
+                decodeFile(file, output);
+                return output.str();
+            }
+
+            const auto outputPath = _options.outputDir / (file.filename().string() + _options.extension);
+            std::ofstream output(outputPath, std::ios::trunc);
+            if (!output) { throw std::runtime_error("Failed to open the output file " + outputPath.string()); }
+            decodeFile(file, output);
+            return {};
+        }));
+
+        if (pending.size() >= maxPending) { drainFront(); }
+    }
+
+    while (!pending.empty()) { drainFront(); }
+    out.flush();
+    return failed;
+}
+
+void BatchRunner::decodeFile(const std::filesystem::path& path, std::ostream& out) const
+{
+    MappedFile file(path, MappedFile::AccessHint::Sequential);
+    readers::WalFrameReader walReader(file);
+    if (!walReader.readHeader()) { throw std::runtime_error("Failed to read the header of the file (file may be too small)"); }
+
+    const size_t frameCount = _options.decode.skipInvalidFrames ? walReader.validFrameCount() : walReader.frameCount();
+    readers::PageSource pageSource(walReader);
+    pageSource.build(frameCount);
+    FrameDecoder decoder(walReader, _formatter, _options.decode, &pageSource);
+    decoder.filterRows(_options.filter);
+
+    std::vector<size_t> frames(frameCount);
+    std::iota(frames.begin(), frames.end(), 0);
+    if (_options.latestPages)
+    {
+        readers::WalPageMap pageMap(walReader);
+        pageMap.build(frames);
+        frames = pageMap.latestOnly(frames);
+    }
+
+    std::unique_ptr<writers::OutputWriter> sink;
+    if (_options.batchSize > 0) { sink = std::make_unique<writers::BatchInsertWriter>(out, _options.batchSize); }
+    std::unique_ptr<writers::OutputWriter> writer;
+    if (_options.stream)
+    {
+        writer = sink ? std::make_unique<writers::StreamWriter>(*sink, _options.dedupe)
+                      : std::make_unique<writers::StreamWriter>(out, _options.dedupe);
+    }
+    else
+    {
+        writer = sink ? std::make_unique<writers::SortedWriter>(*sink)
+                      : std::make_unique<writers::SortedWriter>(out);
+    }
+    if (!_options.preamble.empty()) { writer->writeHeader(_options.preamble); }
+
+    for (auto frameIndex : frames) { decoder.decode(frameIndex, *writer); }
+    writer->flush();
+
+    if (walReader.hasIncompleteFrame()) { wal::Log::get().err() << path << " ends with an incomplete frame, file may be incomplete"; }
+}
+
+bool BatchRunner::isPattern(const std::string& input)
+{
+    return std::string::npos != input.find_first_of("*?[");
+}
+
+std::vector<std::filesystem::path> BatchRunner::inputFiles(const std::string& input)
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    if (!isPattern(input))
+    {
+        // only WAL files, a directory of WALs has their indexes, state files & databases as well
+        for (const auto& entry : std::filesystem::directory_iterator(input, ec))
+        {
+            if (!entry.is_regular_file(ec)) { continue; }
+            std::ifstream file(entry.path(), std::ios::binary);
+            uint8_t magic[4] = {};
+            if (!file.read(reinterpret_cast<char*>(magic), sizeof(magic))) { continue; }
+            const auto value = converters::Endian::loadBig<uint32_t>(magic);
+            if (value == readers::WalFrameReader::magicLittleEndian || value == readers::WalFrameReader::magicBigEndian)
+            {
+                files.push_back(entry.path());
+            }
+        }
+    }
+    else
+    {
+        const std::filesystem::path pattern(input);
+        const auto directory = pattern.has_parent_path() ? pattern.parent_path() : std::filesystem::path(".");
+        const auto name = pattern.filename().string();
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+        {
+            if (entry.is_regular_file(ec) && 0 == fnmatch(name.c_str(), entry.path().filename().c_str(), 0)) { files.push_back(entry.path()); }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
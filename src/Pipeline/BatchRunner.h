@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <filesystem>
+#include "FrameDecoder.h"
+#include "Formatters/Formatter.h"
+#include "Filters/WhereFilter.h"
+
+namespace wal::pipeline {
+
+    // decodes many WAL files with one prepared formatter (the schema is parsed once for all of them).
+    // every file is decoded on a single thread of a pool, so files are decoded side by side.
+    // the output of a file goes to it's own file in the output directory, or to a single stream as a
+    // block that starts with a comment naming the WAL (blocks are written in the order of the files)
+    class BatchRunner
+    {
+        public:
+            // how many files may be decoded ahead of the one being written, a file's output is held in memory
+            // until it's block is written
+            static constexpr size_t pendingFilesPerThread = 2;
+
+            struct Options
+            {
+                FrameDecoder::Options decode;
+                const filters::WhereFilter* filter = nullptr;
+                bool stream = false;            // rows in frame order instead of sorted & deduped
+                bool dedupe = false;
+                bool latestPages = false;
+                size_t batchSize = 0;           // rows per multi-row INSERT statement, 0 for single rows
+                std::string preamble;           // written at the start of every file's output
+                std::filesystem::path outputDir;
+                std::string extension;          // of the output files, appended to the WAL's file name
+            };
+
+            BatchRunner(formatters::Formatter& formatter, Options options, size_t threads);
+            ~BatchRunner() = default;
+
+            // returns the number of files that failed, every failure is logged
+            size_t run(const std::vector<std::filesystem::path>& files, std::ostream& out);
+
+            // true if the input is a glob (i.e. ./archive/*.db-wal) instead of a path
+            static bool isPattern(const std::string& input);
+
+            // the files of a directory that start with a WAL header, or the files whose name matches a glob
+            // (fnmatch's * ? and [...] in the file name, the directory can't have any), sorted by path
+            static std::vector<std::filesystem::path> inputFiles(const std::string& input);
+
+        private:
+            // throws std::runtime_error if the file can't be read
+            void decodeFile(const std::filesystem::path& path, std::ostream& out) const;
+
+            formatters::Formatter& _formatter;
+            Options _options;
+            size_t _threads;
+    };
+}
@@ -0,0 +1,278 @@
+#include "FrameDecoder.h"
+#include "Readers/BTreeReader.h"
+#include "Readers/RecordHeaderReader.h"
+#include "Readers/FreeSpaceCarver.h"
+#include "Utils/Log.h"
+#include "Utils/Stats.h"
+#include "Utils/Trace.h"
+#include <sstream>
+
+using namespace wal::pipeline;
+
+namespace {
+
+    inline bool isFrameWeakValid(const wal::readers::WalHeaderReader& header,
+                                 const wal::readers::FrameHeader& frameHeader)
+    {
+        return header.salt1() == frameHeader.salt1() &&
+               header.salt2() == frameHeader.salt2();
+    }
+
+    inline void printFrameHeader(const wal::readers::FrameHeader& header)
+    {
+        wal::Log::get().debug() << "frame page number " << header.pageNumber();
+        wal::Log::get().debug() << "frame page size " << header.sizeInPage();
+    }
+}
+
+FrameDecoder::FrameDecoder(const readers::WalFrameReader& walReader,
+                           formatters::Formatter& formatter,
+                           const Options& options,
+                           const readers::PageSource* pages):
+    _walReader(walReader),
+    _formatter(formatter),
+    _options(options),
+    _pages(pages)
+{}
+
+void FrameDecoder::decode(size_t frameIndex, writers::OutputWriter& out) const
+{
+    using wal::Stats;
+    using wal::Trace;
+    auto& stats = Stats::get();
+    Trace::Scope scope("decode", "frame", frameIndex);
+
+    const auto& header = _walReader.header();
+    auto frame = [&]()
+    {
+        Stats::Timer timer(Stats::Stage::FrameRead);
+        Trace::Scope scope("frame read");
+        return _walReader.frameAt(frameIndex);
+    }();
+    const auto& frameHeader = frame.header;
+    stats.add(Stats::Counter::FramesRead);
+    stats.add(Stats::Counter::PageBytes, frame.data.remaining());
+
+    if ( _options.printFrameHeaders ) { printFrameHeader(frameHeader); }
+
+    bool weakValid = false;
+    {
+        Stats::Timer timer(Stats::Stage::SaltCheck);
+        weakValid = isFrameWeakValid(header, frameHeader);
+    }
+    if ( !weakValid && _options.skipInvalidFrames )
+    {
+        stats.add(Stats::Counter::FramesInvalidSalt);
+        wal::Log::get().info() <<  "Frame is invalid skipping";
+        wal::Log::get().info() <<  "mismatch salt1 " << header.salt1() << " != " << frameHeader.salt1();
+        wal::Log::get().info() <<  "mismatch salt2 " << header.salt2() << " != " << frameHeader.salt2();
+        return;
+    }
+
+    formatters::Formatter* formatter = &_formatter;
+    if (nullptr != _tables)
+    {
+        formatter = _tables->forPage(frameHeader.pageNumber());
+        if (nullptr == formatter)
+        {
+            stats.add(Stats::Counter::FramesUnknownTable);
+            wal::Log::get().info() << "page " << frameHeader.pageNumber() << " doesn't belong to a known table, skipping";
+            return;
+        }
+    }
+
+    try
+    {
+        auto it = frame.data;
+        // the first page of the database starts with the database file header
+        const size_t headerOffset = frameHeader.pageNumber() == 1 ? readers::BTreeReader::firstPageHeaderOffset : 0;
+        it += headerOffset;
+
+        readers::BTreeReader bTreeReader;
+
+        {
+            Stats::Timer timer(Stats::Stage::PageHeader);
+            bTreeReader.readHeader(it);
+        }
+        stats.addPage(bTreeReader.getBTreeNodeType());
+
+        if (bTreeReader.isInteriorType())
+        {
+            stats.add(Stats::Counter::FramesInterior);
+            wal::Log::get().info() <<  "Found interior Btree Node, skipping";
+            return;
+        }
+
+        if (!bTreeReader.isLeafType())
+        {
+            stats.add(Stats::Counter::FramesOtherPage);
+            wal::Log::get().info() <<  "Found "<< bTreeReader.getBTreeNodeType() << ", skipping";
+            return;
+        }
+
+        if (bTreeReader.getBTreeNodeType() == wal::types::BTreeNodePageType::leafIndex && !_options.outputIndexes)
+        {
+            stats.add(Stats::Counter::FramesOtherPage);
+            wal::Log::get().info() <<  "Found "<< bTreeReader.getBTreeNodeType() << ", skipping";
+            return;
+        }
+
+        if (bTreeReader.getBTreeNodeType() == wal::types::BTreeNodePageType::leafTable && _options.outputIndexes)
+        {
+            stats.add(Stats::Counter::FramesOtherPage);
+            wal::Log::get().info() <<  "Found "<< bTreeReader.getBTreeNodeType() << " and we got --index arg, skipping";
+            return;
+        }
+
+        {
+            Stats::Timer timer(Stats::Stage::PointerArray);
+            bTreeReader.readPointerArray(it);
+        }
+
+        readers::RecordHeaderReader::Overflow overflow;
+        overflow.usableSize = _pages ? _pages->usableSize() : _walReader.pageSize();
+        overflow.pages = _pages;
+        overflow.frameIndex = frame.index;
+        overflow.columns = _options.columns.empty() ? nullptr : &_options.columns;
+        readers::RecordHeaderReader recordReader(bTreeReader.getBTreeNodeType(), overflow);
+
+        const auto& pointers = bTreeReader.getPointerArray();
+        stats.add(Stats::Counter::Cells, pointers.size());
+        const bool filterRowids = _options.filtersRowids() && bTreeReader.getBTreeNodeType() == wal::types::BTreeNodePageType::leafTable;
+        if (filterRowids && !pointers.empty() && !_options.carveFreeSpace)
+        {
+            // cells are sorted by rowid, the first and last ones bound the page
+            int64_t first = 0;
+            int64_t last = 0;
+            if (readers::RecordHeaderReader::peekRowid(frame.data + pointers.front(), first) &&
+                readers::RecordHeaderReader::peekRowid(frame.data + pointers.back(), last) &&
+                (last < _options.minRowid || first > _options.maxRowid))
+            {
+                wal::Log::get().info() << "rowids " << first << "-" << last << " of frame " << frame.index << " are out of range, skipping";
+                stats.add(Stats::Counter::FramesRowidRange);
+                return;
+            }
+        }
+
+        // rows are formatted straight into the string handed to the writer, it starts at the size of the last row
+        std::string output;
+        for(auto& ptr : pointers)
+        {
+            auto ptrPos = frame.data + ptr;
+
+            int64_t rowid = 0;
+            if (filterRowids && readers::RecordHeaderReader::peekRowid(ptrPos, rowid) &&
+                (rowid < _options.minRowid || rowid > _options.maxRowid))
+            {
+                continue;
+            }
+
+            {
+                Stats::Timer timer(Stats::Stage::RecordRead);
+                recordReader.read(ptrPos);
+            }
+            recordReader.printOut();
+            if (nullptr != _filter)
+            {
+                Stats::Timer timer(Stats::Stage::Filter);
+                if (!_filter->matches(recordReader.headerData()))
+                {
+                    stats.add(Stats::Counter::RowsFiltered);
+                    continue;
+                }
+            }
+
+            try
+            {
+                Stats::Timer timer(Stats::Stage::Format);
+                Trace::Scope scope("format");
+                formatter->generateOutput(recordReader.headerData(), output);
+            }
+            catch(const formatters::Formatter::FormatterException& e)
+            {
+                output.clear();
+                stats.add(Stats::Counter::FormatterErrors);
+                wal::Log::get().err() << "Failed to generate output due to: " << e.what();
+            }
+
+            if (!output.empty())
+            {
+                Stats::Timer timer(Stats::Stage::Write);
+                Trace::Scope scope("write");
+                const auto size = output.size();
+                out.write(std::move(output));
+                output.clear();
+                output.reserve(size);
+                stats.add(Stats::Counter::RowsEmitted);
+            }
+        }
+
+        if (_options.carveFreeSpace) { carve(frame, bTreeReader, headerOffset, *formatter, out); }
+    }
+    catch(const std::out_of_range& e)
+    {
+        stats.add(Stats::Counter::FramesMalformed);
+        wal::Log::get().err() << "Failed to decode frame " << frame.index << " (page " << frameHeader.pageNumber() << "), page data is malformed. skipping";
+    }
+}
+
+void FrameDecoder::carve(const readers::WalFrameReader::Frame& frame,
+                         const readers::BTreeReader& bTreeReader,
+                         size_t headerOffset,
+                         formatters::Formatter& formatter,
+                         writers::OutputWriter& out) const
+{
+    readers::FreeSpaceCarver carver(bTreeReader.getBTreeNodeType(), formatter.columnNames().size());
+    std::vector<readers::FreeSpaceCarver::Candidate> candidates;
+    carver.carve(frame.data.ptr(), frame.data.remaining(), headerOffset, bTreeReader, candidates);
+    if (candidates.empty()) { return; }
+
+    // carved records are always completely in the page, no overflow pages are followed for them
+    readers::RecordHeaderReader recordReader(bTreeReader.getBTreeNodeType());
+    std::vector<uint8_t> rebuilt;
+    for (const auto& candidate : candidates)
+    {
+        // only carved records that still have their cell prefix know their rowid
+        if (_options.filtersRowids() && (readers::FreeSpaceCarver::Confidence::High != candidate.confidence ||
+                                         candidate.rowid < _options.minRowid || candidate.rowid > _options.maxRowid))
+        {
+            continue;
+        }
+
+        std::string output;
+        try
+        {
+            auto it = frame.data + candidate.recordOffset;
+            if (candidate.rebuiltHeaderSize > 0)
+            {
+                // the overwritten start of the header followed by the rest of the record
+                rebuilt.assign(candidate.rebuiltHeader.begin(), candidate.rebuiltHeader.begin() + candidate.rebuiltHeaderSize);
+                rebuilt.insert(rebuilt.end(), it.ptr(), it.ptr() + (candidate.payloadSize - candidate.rebuiltHeaderSize));
+                it = FixedRuntimeArray<uint8_t>::iterator(rebuilt.data(), rebuilt.size());
+            }
+            const bool rowidKnown = readers::FreeSpaceCarver::Confidence::High == candidate.confidence;
+            recordReader.readPayload(it, candidate.payloadSize, rowidKnown ? std::optional<int64_t>(candidate.rowid) : std::nullopt);
+            if (nullptr != _filter && !_filter->matches(recordReader.headerData())) { continue; }
+            formatter.generateOutput(recordReader.headerData(), output);
+        }
+        catch(const std::out_of_range& e)
+        {
+            output.clear();
+            wal::Log::get().info() << "carved record at offset " << candidate.cellOffset << " of frame " << frame.index << " is malformed, skipping";
+        }
+        catch(const formatters::Formatter::FormatterException& e)
+        {
+            // carving is a guess, records that don't fit the output format are expected
+            output.clear();
+            wal::Log::get().info() << "carved record at offset " << candidate.cellOffset << " of frame " << frame.index << " can't be output: " << e.what();
+        }
+        if (output.empty()) { continue; }
+
+        std::stringstream ss;
+        ss << "carved from " << candidate.region << " of frame " << frame.index << " (page " << frame.header.pageNumber()
+           << ") offset " << candidate.cellOffset << " confidence " << candidate.confidence;
+        if (readers::FreeSpaceCarver::Confidence::High != candidate.confidence) { ss << " rowid unknown"; }
+        out.write(formatter.comment(ss.str()) + "\n" + output);
+        wal::Stats::get().add(wal::Stats::Counter::RowsCarved);
+    }
+}
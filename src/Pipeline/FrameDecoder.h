@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <limits>
+#include "Readers/WalFrameReader.h"
+#include "Readers/PageSource.h"
+#include "Readers/BTreeReader.h"
+#include "Formatters/Formatter.h"
+#include "Formatters/TableFormatters.h"
+#include "Filters/WhereFilter.h"
+#include "Writers/OutputWriter.h"
+
+namespace wal::pipeline {
+
+    // decodes a single WAL frame into formatted rows. frames are self contained once the WAL header
+    // was read, so decode() can be called for different frames from several threads at once
+    // (as long as the formatter was prepared beforehand)
+    class FrameDecoder
+    {
+        public:
+            struct Options
+            {
+                bool outputIndexes = false;     // decode leaf index pages instead of leaf table pages
+                bool skipInvalidFrames = false; // skip frames that don't belong to the current WAL header
+                bool printFrameHeaders = false;
+                bool carveFreeSpace = false;    // also recover records of deleted cells from the page's free space
+                // columns that are output, only those are read (and get their overflow pages read). empty for all
+                std::vector<bool> columns;
+                // only rows with a rowid in [minRowid, maxRowid] are decoded, the rest of the cells are skipped
+                int64_t minRowid = std::numeric_limits<int64_t>::min();
+                int64_t maxRowid = std::numeric_limits<int64_t>::max();
+
+                bool filtersRowids() const
+                {
+                    return minRowid != std::numeric_limits<int64_t>::min() || maxRowid != std::numeric_limits<int64_t>::max();
+                }
+            };
+
+            // without pages, columns that continue on overflow pages are truncated to what's in the cell
+            FrameDecoder(const readers::WalFrameReader& walReader,
+                         formatters::Formatter& formatter,
+                         const Options& options,
+                         const readers::PageSource* pages = nullptr);
+            ~FrameDecoder() = default;
+
+            void decode(size_t frameIndex, writers::OutputWriter& out) const;
+
+            // format every page with the formatter of the table it belongs to instead of the single formatter,
+            // pages that don't belong to a known table are skipped. tables has to outlive the decoder
+            void routeTables(const formatters::TableFormatters* tables) { _tables = tables; }
+
+            // only output rows that match the filter, it's evaluated before a row is formatted.
+            // the filter has to outlive the decoder
+            void filterRows(const filters::WhereFilter* filter) { _filter = filter; }
+
+        private:
+            // output the records found in the free space of the page, each one preceded by a comment line
+            // that says where it was found and how likely it is a real record
+            void carve(const readers::WalFrameReader::Frame& frame, const readers::BTreeReader& bTreeReader,
+                       size_t headerOffset, formatters::Formatter& formatter, writers::OutputWriter& out) const;
+
+            const readers::WalFrameReader& _walReader;
+            formatters::Formatter& _formatter;
+            Options _options;
+            const readers::PageSource* _pages;
+            const formatters::TableFormatters* _tables = nullptr;
+            const filters::WhereFilter* _filter = nullptr;
+    };
+}
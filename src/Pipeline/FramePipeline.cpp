@@ -0,0 +1,61 @@
+#include "FramePipeline.h"
+#include <deque>
+#include <algorithm>
+#include "Writers/BufferWriter.h"
+#include "Utils/Stats.h"
+#include "Utils/Trace.h"
+
+using namespace wal::pipeline;
+
+FramePipeline::FramePipeline(const FrameDecoder& decoder, size_t threads):
+    _decoder(decoder),
+    _pool(threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr)
+{}
+
+void FramePipeline::run(const std::vector<size_t>& frames, writers::OutputWriter& out)
+{
+    if (nullptr == _pool)
+    {
+        for (auto frameIndex : frames) { _decoder.decode(frameIndex, out); }
+        return;
+    }
+
+    using Chunk = std::future<std::unique_ptr<writers::BufferWriter>>;
+    std::deque<Chunk> pending;
+    const size_t maxPending = _pool->size() * pendingTasksPerThread;
+
+    auto drainFront = [&pending, &out]()
+    {
+        auto chunk = std::move(pending.front());
+        pending.pop_front();
+        // get() rethrows anything the worker threw
+        auto buffer = chunk.get();
+        Stats::Timer timer(Stats::Stage::Write);
+        Trace::Scope scope("write");
+        buffer->moveTo(out);
+    };
+
+    try
+    {
+        for (size_t start = 0; start < frames.size(); start += framesPerTask)
+        {
+            size_t stop = std::min(start + framesPerTask, frames.size());
+            pending.emplace_back(_pool->submit([this, &frames, start, stop]()
+            {
+                auto buffer = std::make_unique<writers::BufferWriter>();
+                for (size_t i = start; i < stop; ++i) { _decoder.decode(frames[i], *buffer); }
+                return buffer;
+            }));
+
+            if (pending.size() >= maxPending) { drainFront(); }
+        }
+
+        while (!pending.empty()) { drainFront(); }
+    }
+    catch(...)
+    {
+        // the queued chunks still reference the frame list, let them finish before leaving
+        for (auto& chunk : pending) { chunk.wait(); }
+        throw;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include "FrameDecoder.h"
+#include "Utils/ThreadPool.h"
+#include "Writers/OutputWriter.h"
+
+namespace wal::pipeline {
+
+    // runs the frame decoder over a list of frames, either on the calling thread or split into
+    // chunks over a worker pool. rows always reach the output writer in frame order
+    class FramePipeline
+    {
+        public:
+            static constexpr size_t framesPerTask = 64;
+            // how many chunks may be decoded ahead of the writer, bounds the memory held by the pipeline
+            static constexpr size_t pendingTasksPerThread = 4;
+
+            FramePipeline(const FrameDecoder& decoder, size_t threads);
+            ~FramePipeline() = default;
+
+            void run(const std::vector<size_t>& frames, writers::OutputWriter& out);
+
+        private:
+            const FrameDecoder& _decoder;
+            std::unique_ptr<ThreadPool> _pool;
+    };
+}
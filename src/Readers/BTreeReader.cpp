@@ -21,6 +21,12 @@ bool BTreeReader::isInteriorType() const
            _btreeHeader.type == wal::types::BTreeNodePageType::interiorTable;
 }
 
+bool BTreeReader::isLeafType() const
+{
+    return _btreeHeader.type == wal::types::BTreeNodePageType::leafIndex ||
+           _btreeHeader.type == wal::types::BTreeNodePageType::leafTable;
+}
+
 
 void BTreeReader::convertToLittleEndian()
 {
@@ -33,14 +39,15 @@ void BTreeReader::readPointerArray(FixedRuntimeArray<uint8_t>::iterator& dataIt)
 {
     using namespace wal::converters;
     if (_btreeHeader.cellCount == 0 ) {return;}
+    const size_t arraySize = _btreeHeader.cellCount * sizeof(uint16_t);
+    if (dataIt.remaining() < arraySize) { throw std::out_of_range("pointer array exceeds the page"); }
+
+    const uint8_t* pointers = dataIt.ptr();
     _pointerArray.reserve(_btreeHeader.cellCount);
-    for (int i=0; i<_btreeHeader.cellCount; ++i)
+    for (size_t i=0; i<_btreeHeader.cellCount; ++i)
     {
-        _pointerArray.emplace_back(
-            Endian::fromBig(
-                FromData::fromIteratorToType<uint16_t,sizeof(uint16_t)>(dataIt)
-            )
-        );
+        _pointerArray.emplace_back(Endian::loadBig<uint16_t>(pointers + i*sizeof(uint16_t)));
     }
+    dataIt += arraySize;
 }
 
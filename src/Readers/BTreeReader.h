@@ -9,6 +9,9 @@ namespace wal::readers {
     class BTreeReader
     {
         public:
+            // page 1 of the database starts with the 100 bytes database file header, the btree header follows it
+            static constexpr size_t firstPageHeaderOffset = 100;
+
             BTreeReader() = default;
             ~BTreeReader() = default;
 
@@ -16,13 +19,26 @@ namespace wal::readers {
 
             bool isInteriorType() const;
 
+            bool isLeafType() const;
+
             void readPointerArray(FixedRuntimeArray<uint8_t>::iterator& dataIt);
 
-            std::vector<uint16_t> getPointerArray() { return _pointerArray; }
+            const std::vector<uint16_t>& getPointerArray() const { return _pointerArray; }
 
             uint32_t getCellCountOverflow() { return _cellCountStartOverflow; }
 
-            wal::types::BTreeNodePageType getBTreeNodeType() { return _btreeHeader.type; }
+            wal::types::BTreeNodePageType getBTreeNodeType() const { return _btreeHeader.type; }
+
+            // offset of the first freeblock in the page, 0 if there are none
+            uint16_t getFirstFreeBlockPos() const { return _btreeHeader.firstFreeBlockPos; }
+
+            uint16_t getCellCount() const { return _btreeHeader.cellCount; }
+
+            // offset where the cell content area starts, everything between the pointer array and it is unallocated
+            size_t getCellContentStart() const { return _btreeHeader.cellContentStart == 0 ? 0xFFFF+1 : _btreeHeader.cellContentStart; }
+
+            // size of the btree header of a leaf page, interior pages have the right most pointer after it
+            static constexpr size_t leafHeaderSize = 8;
 
         private:
 
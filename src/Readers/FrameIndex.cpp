@@ -0,0 +1,178 @@
+#include "FrameIndex.h"
+#include "BTreeReader.h"
+#include "Converters/Endian.h"
+#include "Converters/VarInt.h"
+#include <fstream>
+#include <array>
+#include <algorithm>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr std::array<char, 8> indexMagic = { 'W', 'A', 'L', 'I', 'N', 'D', 'E', 'X' };
+
+    // everything the index has to match in the WAL it's used with
+    struct __attribute((packed)) IndexHeader
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t pageSize;
+        uint32_t salt1;
+        uint32_t salt2;
+        uint64_t fileSize;
+        uint64_t frameCount;
+        uint64_t validFrameCount;
+    };
+}
+
+void FrameIndex::build(const WalFrameReader& walReader)
+{
+    const size_t count = walReader.frameCount();
+    _entries.clear();
+    _entries.reserve(count);
+    for (size_t index = 0; index < count; ++index) { _entries.push_back(readEntry(walReader, index)); }
+    _validFrameCount = walReader.validFrameCount();
+    _pageSize = walReader.pageSize();
+    _salt1 = walReader.header().salt1();
+    _salt2 = walReader.header().salt2();
+    _fileSize = walReader.fileSize();
+}
+
+FrameIndex::Entry FrameIndex::readEntry(const WalFrameReader& walReader, size_t frameIndex)
+{
+    using namespace wal::converters;
+
+    auto frame = walReader.frameAt(frameIndex);
+    Entry entry;
+    entry.offset = frame.offset;
+    entry.pageNumber = frame.header.pageNumber();
+    entry.commitSize = frame.header.sizeInPage();
+    if (frame.header.salt1() == walReader.header().salt1() && frame.header.salt2() == walReader.header().salt2())
+    {
+        entry.flags |= SaltValid;
+    }
+
+    // the b-tree header, overflow & freelist pages end up with whatever their first byte is
+    const uint8_t* page = frame.data.ptr();
+    const size_t pageSize = frame.data.remaining();
+    const size_t headerOffset = entry.pageNumber == 1 ? BTreeReader::firstPageHeaderOffset : 0;
+    if (headerOffset + BTreeReader::leafHeaderSize > pageSize) { return entry; }
+    entry.pageType = static_cast<wal::types::BTreeNodePageType>(page[headerOffset]);
+    entry.cellCount = Endian::loadBig<uint16_t>(page + headerOffset + 3);
+
+    if (wal::types::BTreeNodePageType::leafTable != entry.pageType) { return entry; }
+
+    // leaf table cells are the payload size followed by the rowid
+    const size_t pointers = headerOffset + BTreeReader::leafHeaderSize;
+    const size_t cells = std::min<size_t>(entry.cellCount, (pageSize - pointers) / sizeof(uint16_t));
+    for (size_t cell = 0; cell < cells; ++cell)
+    {
+        const size_t position = Endian::loadBig<uint16_t>(page + pointers + cell * sizeof(uint16_t));
+        if (position >= pageSize) { continue; }
+
+        uint64_t payloadSize = 0;
+        uint64_t value = 0;
+        const size_t used = VarInt::readVarInt(page + position, pageSize - position, payloadSize);
+        if (used == 0 || VarInt::readVarInt(page + position + used, pageSize - position - used, value) == 0) { continue; }
+        const auto rowid = static_cast<int64_t>(value);
+
+        if (!(entry.flags & HasRowids))
+        {
+            entry.minRowid = entry.maxRowid = rowid;
+            entry.flags |= HasRowids;
+        }
+        entry.minRowid = std::min(entry.minRowid, rowid);
+        entry.maxRowid = std::max(entry.maxRowid, rowid);
+    }
+    return entry;
+}
+
+bool FrameIndex::save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) { return false; }
+
+    const IndexHeader header{ indexMagic, version, _pageSize, _salt1, _salt2, _fileSize, _entries.size(), _validFrameCount };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(_entries.data()), _entries.size() * sizeof(Entry));
+    return static_cast<bool>(file);
+}
+
+bool FrameIndex::load(const std::filesystem::path& path, const WalFrameReader& walReader)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) { return false; }
+
+    IndexHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) { return false; }
+    if (header.magic != indexMagic || header.version != version) { return false; }
+
+    // a WAL that was reset or appended to since the index was built
+    if (header.pageSize != walReader.pageSize() ||
+        header.salt1 != walReader.header().salt1() ||
+        header.salt2 != walReader.header().salt2() ||
+        header.fileSize != walReader.fileSize() ||
+        header.frameCount != walReader.frameCount() ||
+        header.validFrameCount > header.frameCount)
+    {
+        return false;
+    }
+
+    std::vector<Entry> entries(header.frameCount);
+    if (!file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(Entry))) { return false; }
+
+    _entries = std::move(entries);
+    _validFrameCount = header.validFrameCount;
+    _pageSize = header.pageSize;
+    _salt1 = header.salt1;
+    _salt2 = header.salt2;
+    _fileSize = header.fileSize;
+    return true;
+}
+
+std::vector<WalFrameReader::Transaction> FrameIndex::transactions(size_t frameCount) const
+{
+    std::vector<WalFrameReader::Transaction> result;
+    frameCount = std::min(frameCount, _entries.size());
+    size_t firstFrame = 0;
+    for (size_t index = 0; index < frameCount; ++index)
+    {
+        if (_entries[index].commitSize == 0) { continue; }
+
+        result.push_back({ firstFrame, index, _entries[index].commitSize });
+        firstFrame = index + 1;
+    }
+    return result;
+}
+
+std::vector<size_t> FrameIndex::leafFrames(const std::vector<size_t>& frames, bool outputIndexes, bool skipInvalidFrames) const
+{
+    const auto wanted = outputIndexes ? wal::types::BTreeNodePageType::leafIndex : wal::types::BTreeNodePageType::leafTable;
+    std::vector<size_t> result;
+    result.reserve(frames.size());
+    for (auto frameIndex : frames)
+    {
+        const auto& current = _entries.at(frameIndex);
+        if (current.pageType != wanted) { continue; }
+        if (skipInvalidFrames && !(current.flags & SaltValid)) { continue; }
+        result.push_back(frameIndex);
+    }
+    return result;
+}
+
+std::vector<size_t> FrameIndex::rowidFrames(const std::vector<size_t>& frames, int64_t minRowid, int64_t maxRowid) const
+{
+    std::vector<size_t> result;
+    result.reserve(frames.size());
+    for (auto frameIndex : frames)
+    {
+        const auto& current = _entries.at(frameIndex);
+        if (wal::types::BTreeNodePageType::leafTable == current.pageType &&
+            (!(current.flags & HasRowids) || current.maxRowid < minRowid || current.minRowid > maxRowid))
+        {
+            continue;
+        }
+        result.push_back(frameIndex);
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <filesystem>
+#include "Types.h"
+#include "WalFrameReader.h"
+
+namespace wal::readers {
+
+    // a summary of every frame of a WAL that's saved next to it (<wal>.idx), so later runs can pick
+    // the frames they need without reading the whole file. the index is only used while the WAL
+    // has the same size, salts and page size it was built from.
+    // the file is a header followed by the packed entries as they are in memory, in the host's byte order. it's
+    // meant for the machine that built it, on one with the other byte order the version doesn't match and the
+    // index is ignored
+    class FrameIndex
+    {
+        public:
+            enum Flags : uint8_t
+            {
+                SaltValid = 1,  // the frame's salts match the WAL header
+                HasRowids = 2   // a leaf table page with cells, minRowid & maxRowid are set
+            };
+
+            struct __attribute((packed)) Entry
+            {
+                uint64_t offset = 0;        // offset of the frame header in the WAL
+                uint32_t pageNumber = 0;
+                uint32_t commitSize = 0;    // database size in pages for commit frames, 0 for other frames
+                uint8_t flags = 0;
+                wal::types::BTreeNodePageType pageType = wal::types::BTreeNodePageType::uknown;
+                uint16_t cellCount = 0;
+                int64_t minRowid = 0;
+                int64_t maxRowid = 0;
+            };
+
+            FrameIndex() = default;
+            ~FrameIndex() = default;
+
+            // read every frame of the WAL, this touches all of it
+            void build(const WalFrameReader& walReader);
+
+            bool save(const std::filesystem::path& path) const;
+
+            // returns false if the file is missing, malformed or doesn't match the WAL
+            bool load(const std::filesystem::path& path, const WalFrameReader& walReader);
+
+            size_t frameCount() const { return _entries.size(); }
+
+            // same as WalFrameReader::validFrameCount, without reading the WAL
+            size_t validFrameCount() const { return _validFrameCount; }
+
+            const Entry& entry(size_t frameIndex) const { return _entries.at(frameIndex); }
+
+            // same as WalFrameReader::transactions, from the commit sizes in the index
+            std::vector<WalFrameReader::Transaction> transactions(size_t frameCount) const;
+
+            // the given frames without the ones that hold no rows to decode: pages that aren't leaf pages
+            // of the wanted kind and, with skipInvalidFrames, frames with salts of another WAL generation
+            std::vector<size_t> leafFrames(const std::vector<size_t>& frames, bool outputIndexes, bool skipInvalidFrames) const;
+
+            // the given frames without the leaf table pages whose rowids are all outside [minRowid, maxRowid]
+            std::vector<size_t> rowidFrames(const std::vector<size_t>& frames, int64_t minRowid, int64_t maxRowid) const;
+
+        private:
+            static Entry readEntry(const WalFrameReader& walReader, size_t frameIndex);
+
+            static constexpr uint32_t version = 2; // 2: rowids are signed
+
+            std::vector<Entry> _entries;
+            size_t _validFrameCount = 0;
+            // the WAL the index was built from
+            uint32_t _pageSize = 0;
+            uint32_t _salt1 = 0;
+            uint32_t _salt2 = 0;
+            uint64_t _fileSize = 0;
+    };
+}
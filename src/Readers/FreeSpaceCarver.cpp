@@ -0,0 +1,209 @@
+#include "FreeSpaceCarver.h"
+#include "Converters/Endian.h"
+#include "Converters/VarInt.h"
+#include <algorithm>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr size_t freeBlockHeaderSize = 4; // next freeblock offset and the freeblock's size
+
+    // bytes a column of the serial type takes, serial types 10 & 11 are reserved and never in a record
+    constexpr uint64_t badSerialType = ~0ULL;
+    inline uint64_t serialTypeSize(uint64_t serialType)
+    {
+        constexpr uint8_t sizes[12] = { 0, 1, 2, 3, 4, 6, 8, 8, 0, 0, 0, 0 };
+        if (serialType >= 12) { return (serialType - 12) / 2; }
+        if (serialType == 10 || serialType == 11) { return badSerialType; }
+        return sizes[serialType];
+    }
+
+    // the serial type of a column that was overwritten, from it's size. only null and integers
+    // (the rowid alias column is null) can be told apart by size alone
+    inline bool firstIntegerSerialType(uint64_t size, uint8_t& serialType)
+    {
+        switch (size)
+        {
+            case 0: serialType = 0; return true;
+            case 1: case 2: case 3: case 4: serialType = static_cast<uint8_t>(size); return true;
+            case 6: serialType = 5; return true;
+            case 8: serialType = 6; return true;
+        }
+        return false;
+    }
+}
+
+void FreeSpaceCarver::carve(const uint8_t* page,
+                            size_t pageSize,
+                            size_t headerOffset,
+                            const BTreeReader& btree,
+                            std::vector<Candidate>& found) const
+{
+    const size_t pointerArrayEnd = headerOffset + BTreeReader::leafHeaderSize + btree.getCellCount() * sizeof(uint16_t);
+    const size_t contentStart = std::min(btree.getCellContentStart(), pageSize);
+    if (pointerArrayEnd < contentStart) { scan(page, pointerArrayEnd, contentStart, Region::Unallocated, found); }
+
+    // freeblocks are kept in increasing offset order, anything else is a corrupt (or looping) chain
+    size_t position = btree.getFirstFreeBlockPos();
+    while (position != 0 && position >= contentStart && position + freeBlockHeaderSize <= pageSize)
+    {
+        const size_t next = converters::Endian::loadBig<uint16_t>(page + position);
+        const size_t size = converters::Endian::loadBig<uint16_t>(page + position + sizeof(uint16_t));
+        if (size < freeBlockHeaderSize || position + size > pageSize) { break; }
+
+        // the freeblock header overwrote the start of the first cell in it, cells after it are intact
+        scan(page, position, position + size, Region::FreeBlock, found);
+
+        if (next != 0 && next < position + size) { break; }
+        position = next;
+    }
+}
+
+void FreeSpaceCarver::scan(const uint8_t* page, size_t begin, size_t end, Region region, std::vector<Candidate>& found) const
+{
+    size_t offset = begin;
+    while (offset < end)
+    {
+        Candidate candidate{};
+        if (matchCell(page, offset, end, candidate))
+        {
+            candidate.confidence = Confidence::High;
+        }
+        else if (rebuildCell(page, offset, end, candidate))
+        {
+            candidate.confidence = Confidence::Low;
+        }
+        else if (size_t size = matchRecord(page + offset, end - offset, minMediumConfidenceColumns, maxColumns()); size > 0)
+        {
+            candidate = { offset, offset, size, 0, region, Confidence::Medium, {}, 0 };
+        }
+        else
+        {
+            ++offset;
+            continue;
+        }
+
+        candidate.region = region;
+        found.push_back(candidate);
+        offset = candidate.recordOffset + candidate.payloadSize - candidate.rebuiltHeaderSize;
+    }
+}
+
+bool FreeSpaceCarver::matchCell(const uint8_t* page, size_t offset, size_t end, Candidate& candidate) const
+{
+    using converters::VarInt;
+
+    // zeroed space is the common case, a cell never has an empty payload
+    if (page[offset] == 0) { return false; }
+
+    size_t position = offset;
+    uint64_t payloadSize = 0;
+    size_t used = VarInt::readVarInt(page + position, end - position, payloadSize);
+    if (used == 0 || payloadSize > end - position) { return false; }
+    position += used;
+
+    uint64_t rowid = 0;
+    if (wal::types::BTreeNodePageType::leafTable == _nodeType)
+    {
+        used = VarInt::readVarInt(page + position, end - position, rowid);
+        if (used == 0) { return false; }
+        position += used;
+    }
+
+    if (payloadSize > end - position || matchRecord(page + position, end - position, 1, maxColumns()) != payloadSize) { return false; }
+
+    candidate.cellOffset = offset;
+    candidate.recordOffset = position;
+    candidate.payloadSize = payloadSize;
+    candidate.rowid = static_cast<int64_t>(rowid);
+    return true;
+}
+
+size_t FreeSpaceCarver::matchRecord(const uint8_t* data, size_t size, size_t minColumns, size_t maxColumns)
+{
+    using converters::VarInt;
+
+    uint64_t headerSize = 0;
+    const size_t used = VarInt::readVarInt(data, size, headerSize);
+    if (used == 0 || headerSize <= used || headerSize > size) { return 0; }
+
+    uint64_t recordSize = headerSize;
+    size_t columns = 0;
+    size_t position = used;
+    while (position < headerSize)
+    {
+        uint64_t serialType = 0;
+        const size_t typeBytes = VarInt::readVarInt(data + position, headerSize - position, serialType);
+        if (typeBytes == 0) { return 0; }
+
+        const uint64_t columnSize = serialTypeSize(serialType);
+        if (columnSize == badSerialType || columnSize > size - recordSize) { return 0; }
+        recordSize += columnSize;
+        position += typeBytes;
+        if (++columns > maxColumns) { return 0; }
+    }
+
+    return columns >= minColumns && recordSize > headerSize ? recordSize : 0;
+}
+
+bool FreeSpaceCarver::rebuildCell(const uint8_t* page, size_t offset, size_t end, Candidate& candidate) const
+{
+    using converters::VarInt;
+
+    // a freed cell starts with the freeblock header: the next freeblock's offset and the size of the cell.
+    // the size is all that's left of the cell prefix, it's enough to find the overwritten header bytes
+    if (end - offset <= freeBlockHeaderSize) { return false; }
+    const size_t next = converters::Endian::loadBig<uint16_t>(page + offset);
+    const size_t cellSize = converters::Endian::loadBig<uint16_t>(page + offset + sizeof(uint16_t));
+    if (cellSize <= freeBlockHeaderSize || offset + cellSize > end || (next != 0 && next < offset + cellSize)) { return false; }
+
+    const uint8_t* types = page + offset + freeBlockHeaderSize;
+    const size_t available = cellSize - freeBlockHeaderSize;
+
+    // a 3 bytes prefix (payload size under 128 & rowid under 16384) loses only the header size, a 2 bytes
+    // prefix (rowid under 128) loses the first serial type too. both are assumed to be single byte varints.
+    // of the header lengths that fit, the one with as many columns as the table wins, then the 3 bytes
+    // prefix, then a null first column (the rowid alias)
+    int best = -1;
+    for (size_t prefix = 3; prefix >= 2; --prefix)
+    {
+        const size_t lost = freeBlockHeaderSize - prefix;
+        const uint64_t payloadSize = cellSize - prefix;
+        uint64_t columnsSize = 0;
+        size_t typeBytes = 0;
+        size_t columns = lost - 1;
+        while (typeBytes < available)
+        {
+            uint64_t serialType = 0;
+            const size_t used = VarInt::readVarInt(types + typeBytes, available - typeBytes, serialType);
+            const uint64_t columnSize = used == 0 ? badSerialType : serialTypeSize(serialType);
+            if (columnSize == badSerialType) { break; }
+            columnsSize += columnSize;
+            typeBytes += used;
+            if (++columns > maxColumns()) { break; }
+
+            const uint64_t headerSize = lost + typeBytes;
+            if (headerSize > 0x7f || headerSize + columnsSize > payloadSize) { break; }
+            // zeroed space parses as a header of nulls
+            if (columnsSize == 0) { continue; }
+
+            const uint64_t firstColumnSize = payloadSize - headerSize - columnsSize;
+            uint8_t firstType = 0;
+            if (lost == 1 && firstColumnSize != 0) { continue; }
+            if (lost == 2 && !firstIntegerSerialType(firstColumnSize, firstType)) { continue; }
+
+            const int score = (columns == _columns ? 4 : 0) + (lost == 1 ? 2 : 0) + (firstColumnSize == 0 ? 1 : 0);
+            if (score > best)
+            {
+                candidate.cellOffset = offset;
+                candidate.recordOffset = offset + freeBlockHeaderSize;
+                candidate.payloadSize = payloadSize;
+                candidate.rowid = 0;
+                candidate.rebuiltHeader = { static_cast<uint8_t>(headerSize), firstType };
+                candidate.rebuiltHeaderSize = lost;
+                best = score;
+            }
+        }
+    }
+    return best >= 0;
+}
@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <limits>
+#include "Types.h"
+#include "BTreeReader.h"
+#pragma once
+
+namespace wal::readers {
+
+    // finds records of deleted cells in the parts of a leaf page that live cells don't use: the unallocated
+    // gap between the cell pointer array and the cell content area, and the chain of freeblocks.
+    // deleting a cell only unlinks it and writes a 4 bytes freeblock header over it's start, so until the
+    // space is reused (or if secure_delete zeroed it) the rest of the old record is still there
+    class FreeSpaceCarver
+    {
+        public:
+            enum class Region
+            {
+                Unallocated,
+                FreeBlock
+            };
+
+            enum class Confidence
+            {
+                Low,    // the start of the record header was overwritten by a freeblock header and is rebuilt from the freeblock size
+                Medium, // only the record header is plausible, the cell prefix is gone (rowid is unknown)
+                High    // the payload size and rowid before the record match it
+            };
+
+            struct Candidate
+            {
+                size_t cellOffset;      // offset in the page where the cell (or the record, if the prefix is gone) starts
+                size_t recordOffset;    // offset in the page of the record header, or of what's left of it if it was rebuilt
+                uint64_t payloadSize;   // size of the record, it's always completely in the page
+                int64_t rowid;          // 0 if it's unknown
+                Region region;
+                Confidence confidence;
+                // the header bytes a freeblock header overwrote (header size and maybe the first serial type),
+                // the record is these followed by the page from recordOffset
+                std::array<uint8_t, 2> rebuiltHeader;
+                size_t rebuiltHeaderSize;
+            };
+
+            // records without a cell prefix need at least this many columns, short headers match random bytes too easily
+            static constexpr size_t minMediumConfidenceColumns = 2;
+
+            // columns is the number of columns in the table's records (0 if it's unknown), it decides how an
+            // overwritten record header is rebuilt and records with more columns than it aren't reported
+            explicit FreeSpaceCarver(const wal::types::BTreeNodePageType& nodeType, size_t columns = 0):
+                _nodeType(nodeType),
+                _columns(columns)
+            {}
+            ~FreeSpaceCarver() = default;
+
+            // scan the free space of a leaf page whose btree header was read by btree, headerOffset is where that
+            // header starts (100 on page 1). candidates are appended to found, the scan itself doesn't allocate
+            void carve(const uint8_t* page, size_t pageSize, size_t headerOffset, const BTreeReader& btree,
+                       std::vector<Candidate>& found) const;
+
+            // size of the record at data (header and columns) if it's a plausible record that ends before size, 0 if not.
+            // a plausible record has minColumns to maxColumns columns and not all of them are empty (zeroed space
+            // parses as a header of nulls)
+            static size_t matchRecord(const uint8_t* data, size_t size, size_t minColumns,
+                                      size_t maxColumns = std::numeric_limits<size_t>::max());
+
+        private:
+            void scan(const uint8_t* page, size_t begin, size_t end, Region region, std::vector<Candidate>& found) const;
+            bool matchCell(const uint8_t* page, size_t offset, size_t end, Candidate& candidate) const;
+            bool rebuildCell(const uint8_t* page, size_t offset, size_t end, Candidate& candidate) const;
+            size_t maxColumns() const { return 0 == _columns ? std::numeric_limits<size_t>::max() : _columns; }
+
+            wal::types::BTreeNodePageType _nodeType;
+            size_t _columns;
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const FreeSpaceCarver::Region& region)
+    {
+        switch (region)
+        {
+            case FreeSpaceCarver::Region::Unallocated: os << "unallocated space"; return os;
+            case FreeSpaceCarver::Region::FreeBlock: os << "freeblock"; return os;
+        }
+        return os;
+    }
+
+    inline std::ostream& operator<<(std::ostream& os, const FreeSpaceCarver::Confidence& confidence)
+    {
+        switch (confidence)
+        {
+            case FreeSpaceCarver::Confidence::Low: os << "low"; return os;
+            case FreeSpaceCarver::Confidence::Medium: os << "medium"; return os;
+            case FreeSpaceCarver::Confidence::High: os << "high"; return os;
+        }
+        return os;
+    }
+}
@@ -0,0 +1,62 @@
+#include "OverflowChain.h"
+#include "Converters/Endian.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr size_t nextPageBytes = 4;
+}
+
+OverflowChain::OverflowChain(const PageSource& pages, uint32_t firstPage, size_t frameIndex, uint64_t payloadSize):
+    _pages(pages),
+    _frameIndex(frameIndex),
+    _contentSize(pages.usableSize() - nextPageBytes),
+    _maxPages(payloadSize / _contentSize + 1),
+    _page(pages.page(firstPage, frameIndex))
+{}
+
+bool OverflowChain::nextPage()
+{
+    if (nullptr == _page || _visited >= _maxPages) { return false; }
+
+    uint32_t next = converters::Endian::loadBig<uint32_t>(_page);
+    _page = _pages.page(next, _frameIndex);
+    _pageStart += _contentSize;
+    ++_visited;
+    return nullptr != _page;
+}
+
+bool OverflowChain::copy(size_t offset, size_t length, uint8_t* out)
+{
+    if (offset < _pageStart) { return false; } // only forward
+    while (length > 0)
+    {
+        if (nullptr == _page) { return false; }
+        if (offset >= _pageStart + _contentSize)
+        {
+            if (!nextPage()) { return false; }
+            continue;
+        }
+
+        size_t inPage = offset - _pageStart;
+        size_t chunk = std::min(length, _contentSize - inPage);
+        std::memcpy(out, _page + nextPageBytes + inPage, chunk);
+        out += chunk;
+        offset += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+size_t OverflowChain::localPayloadSize(uint64_t payloadSize, size_t usableSize, bool tableLeaf)
+{
+    // X: the most a cell holds, M: the least it holds once the payload spills
+    const size_t maxLocal = tableLeaf ? usableSize - 35 : ((usableSize - 12) * 64 / 255) - 23;
+    if (payloadSize <= maxLocal) { return payloadSize; }
+
+    const size_t minLocal = ((usableSize - 12) * 32 / 255) - 23;
+    const size_t local = minLocal + ((payloadSize - minLocal) % (usableSize - 4));
+    return local <= maxLocal ? local : minLocal;
+}
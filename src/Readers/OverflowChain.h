@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "PageSource.h"
+
+namespace wal::readers {
+
+    // reads the part of a record payload that doesn't fit in it's cell. the rest of the payload is stored
+    // in a linked list of overflow pages, each starts with the next page number (0 for the last one)
+    // followed by usable size - 4 bytes of payload. reads have to be in increasing offset order,
+    // the chain is only walked forward and only as far as the reads need
+    class OverflowChain
+    {
+        public:
+            // payloadSize limits how many pages can be walked, so a looping chain ends
+            OverflowChain(const PageSource& pages, uint32_t firstPage, size_t frameIndex, uint64_t payloadSize);
+            ~OverflowChain() = default;
+
+            // copy length bytes from offset (counted from the start of the overflow content) to out,
+            // returns false if the chain is broken (page missing, ends early or loops)
+            bool copy(size_t offset, size_t length, uint8_t* out);
+
+            // how many bytes of a payload are stored in the cell itself (see sqlite's btreeParseCellAdjustSizeForOverflow)
+            static size_t localPayloadSize(uint64_t payloadSize, size_t usableSize, bool tableLeaf);
+
+        private:
+            bool nextPage();
+
+            const PageSource& _pages;
+            size_t _frameIndex;
+            size_t _contentSize;     // payload bytes per overflow page
+            size_t _maxPages;
+            const uint8_t* _page;    // current page, null if the chain is broken
+            size_t _pageStart = 0;   // offset of the current page's content
+            size_t _visited = 1;
+    };
+}
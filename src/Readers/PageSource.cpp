@@ -0,0 +1,101 @@
+#include "PageSource.h"
+#include "Converters/Endian.h"
+#include "Utils/Log.h"
+#include <algorithm>
+
+using namespace wal::readers;
+
+PageSource::PageSource(const WalFrameReader& walReader, const MappedFile* database):
+    _walReader(walReader),
+    _database(database),
+    _usableSize(walReader.pageSize())
+{
+    if (nullptr == _database) { return; }
+
+    // the database header stores the page size as 16bit, 1 stands for 65536
+    if (_database->size() < databaseHeaderReservedOffset + 1)
+    {
+        wal::Log::get().err() << "database file is too small, ignoring it";
+        _database = nullptr;
+        return;
+    }
+    uint32_t pageSize = converters::Endian::loadBig<uint16_t>(_database->data() + databaseHeaderPageSizeOffset);
+    if (pageSize == 1) { pageSize = 65536; }
+    if (pageSize != _walReader.pageSize())
+    {
+        wal::Log::get().err() << "database page size " << pageSize << " doesn't match the WAL page size " << _walReader.pageSize() << ", ignoring it";
+        _database = nullptr;
+        return;
+    }
+    _usableSize = pageSize - _database->data()[databaseHeaderReservedOffset];
+}
+
+void PageSource::build(size_t frameCount, const FrameIndex* index)
+{
+    _frameCount = 0;
+    _frames.clear();
+    _commitFrames.clear();
+    extend(frameCount, index);
+}
+
+void PageSource::extend(size_t frameCount, const FrameIndex* index)
+{
+    const size_t first = _frameCount;
+    _frameCount = std::max(first, std::min(frameCount, _walReader.frameCount()));
+    for (size_t frame = first; frame < _frameCount; ++frame)
+    {
+        uint32_t pageNumber = 0;
+        uint32_t commitSize = 0;
+        if (index)
+        {
+            pageNumber = index->entry(frame).pageNumber;
+            commitSize = index->entry(frame).commitSize;
+        }
+        else
+        {
+            auto frameHeader = _walReader.frameHeaderAt(frame);
+            pageNumber = frameHeader.pageNumber();
+            commitSize = frameHeader.sizeInPage();
+        }
+        _frames[pageNumber].push_back(frame);
+        if (commitSize != 0) { _commitFrames.push_back(frame); }
+    }
+
+    // without a database file page 1 in the WAL has the reserved size as well
+    if (nullptr == _database)
+    {
+        if (auto* first = page(1, _frameCount > 0 ? _frameCount - 1 : 0))
+        {
+            _usableSize = _walReader.pageSize() - first[databaseHeaderReservedOffset];
+        }
+    }
+}
+
+size_t PageSource::commitFrameOf(size_t frameIndex) const
+{
+    auto it = std::lower_bound(_commitFrames.begin(), _commitFrames.end(), frameIndex);
+    // frames after the last commit only see what was written before them
+    return _commitFrames.end() == it ? frameIndex : *it;
+}
+
+const uint8_t* PageSource::page(uint32_t pageNumber, size_t frameIndex) const
+{
+    if (pageNumber == 0) { return nullptr; }
+
+    auto it = _frames.find(pageNumber);
+    if (_frames.end() != it)
+    {
+        const size_t limit = commitFrameOf(frameIndex);
+        const auto& frames = it->second;
+        auto after = std::upper_bound(frames.begin(), frames.end(), limit);
+        if (frames.begin() != after)
+        {
+            return _walReader.frameAt(*(after - 1)).data.ptr();
+        }
+    }
+
+    if (nullptr == _database) { return nullptr; }
+    const size_t offset = static_cast<size_t>(pageNumber - 1) * _walReader.pageSize();
+    if (offset + _walReader.pageSize() > _database->size()) { return nullptr; }
+    return _database->data() + offset;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "Utils/MappedFile.h"
+#include "WalFrameReader.h"
+#include "FrameIndex.h"
+
+namespace wal::readers {
+
+    // resolves database page numbers to page data: from the WAL frames first and from the main
+    // database file (when there is one) for pages the WAL doesn't hold, i.e. the overflow pages of a row
+    // that were checkpointed before the row's leaf page was changed again
+    class PageSource
+    {
+        public:
+            // database is optional, it has to outlive this object
+            PageSource(const WalFrameReader& walReader, const MappedFile* database = nullptr);
+            ~PageSource() = default;
+
+            // index the first frameCount frames of the WAL, with a frame index the frame headers aren't read
+            void build(size_t frameCount, const FrameIndex* index = nullptr);
+
+            // index the frames after the ones that are indexed already up to frameCount, for a WAL that grew
+            // since it was indexed (the file has to be mapped again before). indexed frames aren't read again
+            void extend(size_t frameCount, const FrameIndex* index = nullptr);
+
+            // the page as it was when the transaction of frameIndex was committed: the newest frame of the page
+            // up to that commit, or the database file if the WAL doesn't have the page by then.
+            // returns null if the page can't be found
+            const uint8_t* page(uint32_t pageNumber, size_t frameIndex) const;
+
+            uint32_t pageSize() const { return _walReader.pageSize(); }
+
+            // page size without the bytes reserved at the end of every page (database header offset 20)
+            size_t usableSize() const { return _usableSize; }
+
+            // false if the database file doesn't match the WAL (i.e. other page size) and is ignored
+            bool hasDatabase() const { return nullptr != _database; }
+
+        private:
+            // the commit frame closing the transaction frameIndex belongs to
+            size_t commitFrameOf(size_t frameIndex) const;
+
+            static constexpr size_t databaseHeaderPageSizeOffset = 16;
+            static constexpr size_t databaseHeaderReservedOffset = 20;
+
+            const WalFrameReader& _walReader;
+            const MappedFile* _database;
+            std::unordered_map<uint32_t, std::vector<size_t>> _frames; // frames of every page in file order
+            std::vector<size_t> _commitFrames;
+            size_t _frameCount = 0;
+            size_t _usableSize = 0;
+    };
+}
@@ -1,46 +1,61 @@
 #include "RecordHeaderDataType.h"
 #include "Converters/FromData.h"
 #include "Converters/Endian.h"
+#include <cstring>
+#include <bit>
+#include <stdexcept>
 
 using namespace wal::readers;
 
 RecordHeaderDataType::RecordHeaderDataType(const types::RecordSerialTypes& type,
-                                           const FixedRuntimeArray<uint8_t>& data):
-    type(type),
-    data(data)
+                                           const uint8_t* data,
+                                           size_t size):
+    _owned(nullptr),
+    _data(data),
+    _size(size),
+    type(type)
 {}
 
+RecordHeaderDataType::RecordHeaderDataType(const types::RecordSerialTypes& type,
+                                           const FixedRuntimeArray<uint8_t>& data):
+    _owned(data.size() > 0 ? std::make_shared<uint8_t[]>(data.size()) : nullptr),
+    _data(_owned.get()),
+    _size(data.size()),
+    type(type)
+{
+    if (_size > 0) { std::memcpy(_owned.get(), data.data(), _size); }
+}
+
 std::string RecordHeaderDataType::asString() const
+{
+    return std::string(asStringView());
+}
+
+std::string_view RecordHeaderDataType::asStringView() const
 {
     if (types::RecordSerialTypes::String != type) { return {}; }
-    std::string ret;
-    ret.resize(data.size());
-    std::memcpy(ret.data(),(const void *) data.data(), data.size());
-    return ret;
+    return { reinterpret_cast<const char*>(_data), _size };
 }
 
 std::vector<uint8_t> RecordHeaderDataType::asData() const
 {
     if (types::RecordSerialTypes::Blob != type) { return {}; }
-    std::vector<uint8_t> ret;
-    ret.reserve(data.size());
-    for (auto& b: data) { ret.push_back(b); }
-    return ret;
+    return { _data, _data + _size };
 }
 
 uint8_t RecordHeaderDataType::asUInt8() const
 {
     if (types::RecordSerialTypes::One == type) { return 1; }
 
-    if (types::RecordSerialTypes::ByteInt != type) { return 0; }
-    return data[0];
+    if (types::RecordSerialTypes::ByteInt != type || _size < 1) { return 0; }
+    return _data[0];
 }
 
 uint16_t RecordHeaderDataType::asUInt16() const
 {
     if (types::RecordSerialTypes::TwoBytesIntBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toUInt16(data));
+        return loadBig<uint16_t, 2>();
     }
     return static_cast<uint16_t>(asUInt8());
 }
@@ -49,11 +64,11 @@ uint32_t RecordHeaderDataType::asUInt32() const
 {
     if (types::RecordSerialTypes::ThreeBytesIntBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toUInt32FromThreeBytes(data));
+        return loadBig<uint32_t, 3>();
     }
     if (types::RecordSerialTypes::FourBytesIntBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toUInt32(data));
+        return loadBig<uint32_t, 4>();
     }
     return static_cast<uint32_t>(asUInt16());
 }
@@ -62,20 +77,41 @@ uint64_t RecordHeaderDataType::asUInt64() const
 {
     if (types::RecordSerialTypes::SixBytesIntBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toUInt64FromSixBytes(data));
+        return loadBig<uint64_t, 6>();
     }
     if (types::RecordSerialTypes::EightBytesIntBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toUInt64(data));
+        return loadBig<uint64_t, 8>();
     }
     return static_cast<uint64_t>(asUInt32());
 }
 
+int64_t RecordHeaderDataType::asInt64() const
+{
+    size_t bits = 0;
+    switch (type)
+    {
+        case types::RecordSerialTypes::ByteInt: bits = 8; break;
+        case types::RecordSerialTypes::TwoBytesIntBE: bits = 16; break;
+        case types::RecordSerialTypes::ThreeBytesIntBE: bits = 24; break;
+        case types::RecordSerialTypes::FourBytesIntBE: bits = 32; break;
+        case types::RecordSerialTypes::SixBytesIntBE: bits = 48; break;
+        default: return static_cast<int64_t>(asUInt64());
+    }
+    const unsigned shift = 64 - bits;
+    return static_cast<int64_t>(asUInt64() << shift) >> shift;
+}
+
 wal::converters::float64_t RecordHeaderDataType::asFloat64() const
 {
     if (types::RecordSerialTypes::FloatBE == type)
     {
-        return converters::Endian::fromBig(converters::FromData::toFloat64(data));
+        return std::bit_cast<converters::float64_t>(loadBig<uint64_t, 8>());
     }
     return static_cast<converters::float64_t>(asUInt64());
 }
+
+void RecordHeaderDataType::notEnoughData(size_t needed) const
+{
+    throw std::runtime_error("Unable to convert column of " + std::to_string(_size) + " bytes, " + std::to_string(needed) + " bytes needed");
+}
@@ -1,17 +1,31 @@
 #include <cstdint>
 #include <vector>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include "Types.h"
 #include "Utils/FixedRuntimeArray.h"
 #include "Converters/FromData.h"
+#include "Converters/Endian.h"
 #pragma once
 
 namespace wal::readers {
 
+    // a single column of a record: it's serial type and a view of it's bytes.
+    // when created by the RecordHeaderReader the view points into the page buffer and nothing is copied,
+    // so it's only valid as long as the page is (the WAL file stays mapped)
     class RecordHeaderDataType
     {
         friend class RecordHeaderReader;
         public:
 
+            // view of size bytes at data, data is not owned
+            RecordHeaderDataType(const types::RecordSerialTypes& type,
+                                 const uint8_t* data,
+                                 size_t size);
+
+            // holds it's own copy of the data (for records that are not read from a page)
             RecordHeaderDataType(const types::RecordSerialTypes& type,
                                     const FixedRuntimeArray<uint8_t>& data);
 
@@ -19,10 +33,15 @@ namespace wal::readers {
 
             std::string asString() const;
 
+            std::string_view asStringView() const;
+
             std::vector<uint8_t> asData() const;
 
             bool isNull() const { return types::RecordSerialTypes::Null == type; }
 
+            // the column continues on overflow pages that weren't read, only the part in the cell is here
+            bool isTruncated() const { return _truncated; }
+
             uint8_t asUInt8() const;
 
             uint16_t asUInt16() const;
@@ -31,13 +50,29 @@ namespace wal::readers {
 
             uint64_t asUInt64() const;
 
+            // the signed value of an integer column, sign extended from the size of it's serial type
+            int64_t asInt64() const;
+
             converters::float64_t asFloat64() const;
 
             // return the data as is without any type checks
-            const FixedRuntimeArray<uint8_t>& asRawData() const { return data; }
+            std::span<const uint8_t> asRawData() const { return {_data, _size}; }
 
         private:
-            FixedRuntimeArray<uint8_t> data;
+            template<typename TYPE, size_t SIZE>
+            TYPE loadBig() const
+            {
+                if (_size < SIZE) [[unlikely]] { notEnoughData(SIZE); }
+                return converters::Endian::loadBig<TYPE, SIZE>(_data);
+            }
+
+            [[noreturn]] void notEnoughData(size_t needed) const;
+
+            // shared so copies of an owning column stay valid without copying the data again
+            std::shared_ptr<uint8_t[]> _owned;
+            const uint8_t* _data;
+            size_t _size;
             types::RecordSerialTypes type;
+            bool _truncated = false;
     };
 }
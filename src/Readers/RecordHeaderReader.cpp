@@ -3,6 +3,9 @@
 #include "Utils/Log.h"
 #include "Converters/FromData.h"
 #include "Converters/Endian.h"
+#include <sstream>
+#include <optional>
+#include <cstring>
 
 using namespace wal::readers;
 using namespace wal::types;
@@ -10,9 +13,13 @@ using namespace wal::types;
 
 
 RecordHeaderReader::RecordHeaderReader(const wal::types::BTreeNodePageType& nodeType):
-    _nodeType(nodeType) ,
-    _headerData({}),
-    _rowid(0)
+    RecordHeaderReader(nodeType, Overflow{})
+{}
+
+RecordHeaderReader::RecordHeaderReader(const wal::types::BTreeNodePageType& nodeType, const Overflow& overflow):
+    _record({{}, 0}),
+    _nodeType(nodeType),
+    _overflow(overflow)
 {}
 
 void RecordHeaderReader::read(FixedRuntimeArray<uint8_t>::iterator& dataIt)
@@ -20,15 +27,52 @@ void RecordHeaderReader::read(FixedRuntimeArray<uint8_t>::iterator& dataIt)
     auto payloadSize = converters::VarInt::readVarInt(dataIt);
     wal::Log::get().debug() << "payload size: " <<  payloadSize;
 
+    int64_t rowid = 0;
     if (wal::types::BTreeNodePageType::leafTable == _nodeType)
     {
-        _rowid = converters::VarInt::readVarInt(dataIt);
-        wal::Log::get().debug() << "row id: " <<  _rowid;
+        rowid = static_cast<int64_t>(converters::VarInt::readVarInt(dataIt));
+        wal::Log::get().debug() << "row id: " <<  rowid;
     }
+    readPayload(dataIt, payloadSize, rowid);
+}
+
+void RecordHeaderReader::readPayload(FixedRuntimeArray<uint8_t>::iterator& dataIt, uint64_t payloadSize, std::optional<int64_t> rowid)
+{
+    _record.rowid = rowid.value_or(0);
+    _record.rowidKnown = rowid.has_value();
+    _record.headerData.clear();
+
+    const size_t available = dataIt.remaining();
+    const uint8_t* payload = dataIt.ptr();
 
-    auto startPos = dataIt;
+    // only the start of a big payload is in the cell, followed by the number of it's first overflow page
+    size_t localSize = payloadSize;
+    uint32_t firstOverflowPage = 0;
+    if (_overflow.usableSize > 0)
+    {
+        localSize = OverflowChain::localPayloadSize(payloadSize, _overflow.usableSize, wal::types::BTreeNodePageType::leafTable == _nodeType);
+    }
+    if (localSize < payloadSize)
+    {
+        if (localSize + sizeof(uint32_t) > available) { throw std::out_of_range("record cell exceeds the page"); }
+        firstOverflowPage = converters::Endian::loadBig<uint32_t>(payload + localSize);
+        wal::Log::get().debug() << "payload continues on overflow page " << firstOverflowPage;
+    }
+    else if (payloadSize > available)
+    {
+        // malformed, the columns can still be read up to the end of the page
+        payloadSize = available;
+        localSize = available;
+    }
+
+    std::optional<OverflowChain> chain;
+    if (firstOverflowPage != 0 && nullptr != _overflow.pages)
+    {
+        chain.emplace(*_overflow.pages, firstOverflowPage, _overflow.frameIndex, payloadSize);
+    }
 
-    auto headerSize = converters::VarInt::readVarInt(dataIt); //size in bytes (including the bytes making up headerSize)
+    uint64_t headerSize = 0; //size in bytes (including the bytes making up headerSize)
+    const size_t headerSizeBytes = converters::VarInt::readVarInt(payload, localSize, headerSize);
     wal::Log::get().debug() << "read record header size : " << headerSize;
 
     if (headerSize < 2)
@@ -37,34 +81,147 @@ void RecordHeaderReader::read(FixedRuntimeArray<uint8_t>::iterator& dataIt)
         return;
     }
 
-    std::vector<types::RecordHeaderFormat> headerFormats;
-    while (std::distance(startPos, dataIt) < headerSize)
+    if (headerSizeBytes == 0 || headerSize > payloadSize || headerSize < headerSizeBytes)
     {
-        uint64_t headerByte = converters::VarInt::readVarInt(dataIt);
-        headerFormats.push_back(recordHeaderByteToType(headerByte));
+        throw std::out_of_range("record header of " + std::to_string(headerSize) + " bytes exceeds the payload");
     }
-    readHeader(dataIt, headerFormats);
+
+    const uint8_t* header = payload;
+    if (headerSize > localSize)
+    {
+        // only records with a lot of columns have a header that doesn't fit in the cell
+        _headerBuffer.resize(headerSize);
+        std::memcpy(_headerBuffer.data(), payload, localSize);
+        if (!chain || !chain->copy(0, headerSize - localSize, _headerBuffer.data() + localSize))
+        {
+            throw std::out_of_range("record header continues on overflow pages that can't be read");
+        }
+        header = _headerBuffer.data();
+    }
+
+    // the serial types are everything after the header size varint up to headerSize, decoded in one go
+    if (!converters::VarInt::readVarInts(header + headerSizeBytes, headerSize - headerSizeBytes, _serialTypes))
+    {
+        throw std::out_of_range("record header serial types run past the header");
+    }
+
+    _headerFormats.clear();
+    for (auto serialType : _serialTypes) { _headerFormats.push_back(recordHeaderByteToType(serialType)); }
+    readColumns(payload, localSize, payloadSize, headerSize, chain ? &chain.value() : nullptr, firstOverflowPage);
+
+    dataIt += std::min(available, localSize == payloadSize ? localSize : localSize + sizeof(uint32_t));
 }
 
-void RecordHeaderReader::readHeader(FixedRuntimeArray<uint8_t>::iterator& dataIt,
-                                    std::vector<types::RecordHeaderFormat> headerFormats)
+bool RecordHeaderReader::peekRowid(const FixedRuntimeArray<uint8_t>::iterator& cell, int64_t& rowid)
 {
-    _headerData.clear();
-    for (const auto& format : headerFormats)
+    // the rowid follows the payload size
+    const uint8_t* data = cell.ptr();
+    const size_t size = cell.remaining();
+    uint64_t payloadSize = 0;
+    uint64_t value = 0;
+    const size_t used = converters::VarInt::readVarInt(data, size, payloadSize);
+    if (used == 0 || converters::VarInt::readVarInt(data + used, size - used, value) == 0) { return false; }
+    rowid = static_cast<int64_t>(value);
+    return true;
+}
+
+void RecordHeaderReader::readColumns(const uint8_t* payload,
+                                     size_t localSize,
+                                     uint64_t payloadSize,
+                                     uint64_t headerSize,
+                                     OverflowChain* chain,
+                                     uint32_t firstOverflowPage)
+{
+    auto& columns = _record.headerData;
+    _pending.clear();
+
+    // columns in the cell are views into the page, the ones (partly) on overflow pages that are wanted
+    // are copied to the overflow buffer once it's size is known, the rest keep only what's in the cell
+    size_t offset = headerSize;
+    size_t overflowBytes = 0;
+    for (const auto& format : _headerFormats)
     {
         if (format.byteSize == 0)
         {
-            _headerData.push_back({ format.type, {}});
+            columns.push_back({ format.type, nullptr, 0 });
             continue;
         }
 
-        FixedRuntimeArray<uint8_t> data(format.byteSize);
-        std::copy_n(dataIt, format.byteSize, data.begin());
-        dataIt+=format.byteSize;
-        _headerData.push_back({ format.type, data});
+        if (offset + format.byteSize > payloadSize)
+        {
+            throw std::out_of_range("record column of " + std::to_string(format.byteSize) + " bytes exceeds the payload");
+        }
+
+        if (!isColumnWanted(columns.size()))
+        {
+            // only it's size is needed to find the next column
+            columns.push_back({ types::RecordSerialTypes::Null, nullptr, 0 });
+        }
+        else if (offset + format.byteSize <= localSize)
+        {
+            columns.push_back({ format.type, payload + offset, format.byteSize });
+        }
+        else if (nullptr != chain)
+        {
+            _pending.push_back({ columns.size(), offset });
+            columns.push_back({ format.type, nullptr, format.byteSize });
+            overflowBytes += format.byteSize;
+        }
+        else
+        {
+            columns.push_back(truncatedColumn(format, payload, localSize, offset));
+        }
+        offset += format.byteSize;
+    }
+
+    if (_pending.empty()) { return; }
+
+    _overflowBuffer.resize(overflowBytes);
+    uint8_t* out = _overflowBuffer.data();
+    bool broken = false;
+    for (const auto& pending : _pending)
+    {
+        auto& column = columns[pending.column];
+        const size_t inCell = pending.offset < localSize ? localSize - pending.offset : 0;
+        if (!broken)
+        {
+            std::memcpy(out, payload + pending.offset, inCell);
+            const size_t overflowOffset = pending.offset + inCell - localSize;
+            broken = !chain->copy(overflowOffset, column._size - inCell, out + inCell);
+        }
+
+        if (broken) { column = truncatedColumn({ column.type, column._size }, payload, localSize, pending.offset); }
+        else { column._data = out; }
+        out += column._size;
+    }
+
+    if (broken)
+    {
+        wal::Log::get().err() << "overflow pages of the record with rowid " << _record.rowid << " (first page " << firstOverflowPage << ") can't be read, columns are truncated";
     }
 }
 
+bool RecordHeaderReader::isColumnWanted(size_t column) const
+{
+    return nullptr == _overflow.columns || (column < _overflow.columns->size() && (*_overflow.columns)[column]);
+}
+
+RecordHeaderDataType RecordHeaderReader::truncatedColumn(const types::RecordHeaderFormat& format,
+                                                         const uint8_t* payload,
+                                                         size_t localSize,
+                                                         size_t offset)
+{
+    // text and blobs keep what's in the cell, a number that isn't complete is no number
+    const bool keepPrefix = types::RecordSerialTypes::String == format.type || types::RecordSerialTypes::Blob == format.type;
+    const size_t inCell = offset < localSize ? localSize - offset : 0;
+
+    RecordHeaderDataType column(keepPrefix ? format.type : types::RecordSerialTypes::Null,
+                                keepPrefix ? payload + offset : nullptr,
+                                keepPrefix ? std::min(inCell, format.byteSize) : 0);
+    column._truncated = true;
+    return column;
+}
+
 RecordHeaderFormat RecordHeaderReader::recordHeaderByteToType(const uint64_t& headerByte)
 {
     auto serialType = static_cast<RecordSerialTypes>(headerByte);
@@ -106,7 +263,9 @@ RecordHeaderFormat RecordHeaderReader::recordHeaderByteToType(const uint64_t& he
 
 void RecordHeaderReader::printOut()
 {
-    for (const auto& recordTuple: _headerData)
+    if (!wal::Log::get().enabled(wal::Log::ReportLevel::Info)) { return; }
+
+    for (const auto& recordTuple: _record.headerData)
     {
         switch (recordTuple.type)
         {
@@ -149,15 +308,17 @@ void RecordHeaderReader::printOut()
                 wal::Log::get().info() << "SQL Internal";
             break;
             case RecordSerialTypes::Blob:
-                wal::Log::get().info() << "Bolb: ";
+            {
+                std::stringstream ss;
                 for (const auto& byte : recordTuple.asData())
                 {
-                    printf("0x%X ",byte);
+                    ss << "0x" << std::uppercase << std::hex << static_cast<int>(byte) << " ";
                 }
-                wal::Log::get().info();
+                wal::Log::get().info() << "Bolb: " << ss.str();
+            }
             break;
             case RecordSerialTypes::String:
-                wal::Log::get().info() << "String: " << recordTuple.asString(); // assuming ascii
+                wal::Log::get().info() << "String: " << recordTuple.asStringView(); // assuming ascii
             break;
         }
     }
@@ -1,9 +1,14 @@
 #include <cstdint>
 #include <vector>
+#include <utility>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <optional>
 #include "Types.h"
 #include "RecordHeaderDataType.h"
+#include "PageSource.h"
+#include "OverflowChain.h"
 #pragma once
 
 namespace wal::readers {
@@ -14,25 +19,62 @@ namespace wal::readers {
             struct RecordData
             {
                 std::vector< RecordHeaderDataType > headerData;
-                uint64_t rowid;
+                int64_t rowid;
+                bool rowidKnown = true; // false for a record carved without it's cell prefix, rowid is 0 then
             };
 
-            RecordHeaderReader(const wal::types::BTreeNodePageType& nodeType);
+            // how the payload is read: columns that are needed and payloads that continue on overflow pages
+            struct Overflow
+            {
+                size_t usableSize = 0;              // 0 if unknown, payloads are then assumed to be in the cell
+                const PageSource* pages = nullptr;  // without it columns on overflow pages are truncated
+                size_t frameIndex = 0;              // the frame the cells are read from
+                const std::vector<bool>* columns = nullptr; // columns to read, the rest are null placeholders. null for all
+            };
+
+            explicit RecordHeaderReader(const wal::types::BTreeNodePageType& nodeType);
+            RecordHeaderReader(const wal::types::BTreeNodePageType& nodeType, const Overflow& overflow);
             ~RecordHeaderReader() = default;
 
             // reading header and populate data in this object
             void read(FixedRuntimeArray<uint8_t>::iterator& dataIt);
 
+            // read a record that starts at dataIt without it's cell prefix (payload size & rowid),
+            // i.e. one carved from the free space of a page. rowid is empty if it's unknown
+            void readPayload(FixedRuntimeArray<uint8_t>::iterator& dataIt, uint64_t payloadSize, std::optional<int64_t> rowid);
+
             void printOut();
 
-            RecordData headerData() { return {_headerData, _rowid }; }
+            // the rowid of a leaf table cell without decoding it's record, false if the cell is malformed.
+            // rowids are signed, the varint holds their two's complement
+            static bool peekRowid(const FixedRuntimeArray<uint8_t>::iterator& cell, int64_t& rowid);
+
+            // the columns are views into the page read last (or into this reader for columns from overflow pages),
+            // they are reused on the next read
+            const RecordData& headerData() const { return _record; }
 
         private:
-            std::vector< RecordHeaderDataType > _headerData;
+            RecordData _record;
+            std::vector<uint64_t> _serialTypes; // kept to reuse it's allocation between records
+            std::vector<types::RecordHeaderFormat> _headerFormats;
             wal::types::BTreeNodePageType _nodeType;
-            uint64_t _rowid;
+            Overflow _overflow;
+
+            // columns that are copied from overflow pages, by their offset in the payload
+            struct PendingColumn
+            {
+                size_t column;
+                size_t offset;
+            };
+            std::vector<PendingColumn> _pending;
+            std::vector<uint8_t> _overflowBuffer;
+            std::vector<uint8_t> _headerBuffer;
 
-            void readHeader(FixedRuntimeArray<uint8_t>::iterator& dataIt, std::vector<types::RecordHeaderFormat> headerFormats);
+            void readColumns(const uint8_t* payload, size_t localSize, uint64_t payloadSize, uint64_t headerSize,
+                             OverflowChain* chain, uint32_t firstOverflowPage);
+            bool isColumnWanted(size_t column) const;
+            static RecordHeaderDataType truncatedColumn(const types::RecordHeaderFormat& format, const uint8_t* payload,
+                                                        size_t localSize, size_t offset);
             types::RecordHeaderFormat recordHeaderByteToType(const uint64_t& headerByte);
     };
 }
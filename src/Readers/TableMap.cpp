@@ -0,0 +1,268 @@
+#include "TableMap.h"
+#include "BTreeReader.h"
+#include "RecordHeaderReader.h"
+#include "Converters/Endian.h"
+#include "Utils/Log.h"
+#include <fstream>
+#include <array>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr std::array<char, 8> cacheMagic = { 'W', 'A', 'L', 'P', 'M', 'A', 'P', '1' };
+    constexpr size_t interiorHeaderSize = 12; // the leaf header followed by the right most child
+    constexpr size_t rightMostChildOffset = 8;
+    constexpr size_t databaseChangeCounterOffset = 24; // followed by the database size in pages
+    constexpr size_t maxCachedString = 1 << 24;
+
+    // sqlite_schema columns: type, name, tbl_name, rootpage, sql
+    enum SchemaColumn : size_t { SchemaType = 0, SchemaName, SchemaTableName, SchemaRootPage, SchemaSql, SchemaColumns };
+
+    inline void hash(uint64_t& value, const void* data, size_t size)
+    {
+        // FNV-1a
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) { value = (value ^ bytes[i]) * 0x100000001b3ULL; }
+    }
+
+    template<typename T>
+    void writeValue(std::ofstream& file, const T& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    template<typename T>
+    bool readValue(std::ifstream& file, T& value) { return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T))); }
+
+    void writeString(std::ofstream& file, const std::string& value)
+    {
+        writeValue(file, static_cast<uint32_t>(value.size()));
+        file.write(value.data(), value.size());
+    }
+
+    bool readString(std::ifstream& file, std::string& value)
+    {
+        uint32_t size = 0;
+        if (!readValue(file, size) || size > maxCachedString) { return false; }
+        value.resize(size);
+        return static_cast<bool>(file.read(value.data(), size));
+    }
+}
+
+TableMap::TableMap(const PageSource& pages):
+    _pages(pages)
+{}
+
+void TableMap::build(size_t frameIndex)
+{
+    _tables.clear();
+    _tablePages.clear();
+    readSchema(frameIndex);
+
+    std::vector<uint32_t> pages;
+    for (size_t table = 0; table < _tables.size(); ++table)
+    {
+        pages.clear();
+        walk(_tables[table].rootPage, frameIndex, pages, nullptr);
+        // a page can only be part of one b-tree, if two claim it the first one keeps it
+        for (auto page : pages) { _tablePages.emplace(page, table); }
+    }
+}
+
+void TableMap::readSchema(size_t frameIndex)
+{
+    std::vector<uint32_t> pages;
+    std::vector<uint32_t> leaves;
+    walk(schemaRootPage, frameIndex, pages, &leaves);
+
+    RecordHeaderReader::Overflow overflow;
+    overflow.usableSize = _pages.usableSize();
+    overflow.pages = &_pages;
+    overflow.frameIndex = frameIndex;
+    RecordHeaderReader recordReader(wal::types::BTreeNodePageType::leafTable, overflow);
+
+    for (auto leaf : leaves)
+    {
+        const uint8_t* data = _pages.page(leaf, frameIndex);
+        const size_t headerOffset = leaf == schemaRootPage ? BTreeReader::firstPageHeaderOffset : 0;
+        FixedRuntimeArray<uint8_t>::iterator page(const_cast<uint8_t*>(data), _pages.pageSize());
+
+        auto it = page + headerOffset;
+        BTreeReader bTreeReader;
+        try
+        {
+            bTreeReader.readHeader(it);
+            bTreeReader.readPointerArray(it);
+        }
+        catch(const std::out_of_range& e)
+        {
+            wal::Log::get().err() << "sqlite_schema page " << leaf << " is malformed, skipping";
+            continue;
+        }
+
+        for (auto ptr : bTreeReader.getPointerArray())
+        {
+            try
+            {
+                auto cell = page + ptr;
+                recordReader.read(cell);
+            }
+            catch(const std::out_of_range& e)
+            {
+                wal::Log::get().err() << "sqlite_schema record on page " << leaf << " is malformed, skipping";
+                continue;
+            }
+
+            const auto& columns = recordReader.headerData().headerData;
+            if (columns.size() < SchemaColumns || columns[SchemaType].asStringView() != "table") { continue; }
+
+            // virtual tables have no b-tree (root page 0)
+            const uint32_t rootPage = columns[SchemaRootPage].asUInt32();
+            if (rootPage == 0) { continue; }
+            _tables.push_back({ columns[SchemaName].asString(), columns[SchemaSql].asString(), rootPage });
+        }
+    }
+}
+
+void TableMap::walk(uint32_t root, size_t frameIndex, std::vector<uint32_t>& pages, std::vector<uint32_t>* leaves) const
+{
+    std::unordered_set<uint32_t> visited;
+    std::vector<uint32_t> pending = { root };
+    while (!pending.empty())
+    {
+        const uint32_t pageNumber = pending.back();
+        pending.pop_back();
+        if (!visited.insert(pageNumber).second) { continue; }
+
+        const uint8_t* data = _pages.page(pageNumber, frameIndex);
+        if (nullptr == data)
+        {
+            wal::Log::get().info() << "b-tree page " << pageNumber << " (root " << root << ") isn't in the WAL or the database, skipping";
+            continue;
+        }
+
+        try
+        {
+            FixedRuntimeArray<uint8_t>::iterator page(const_cast<uint8_t*>(data), _pages.pageSize());
+            const size_t headerOffset = pageNumber == schemaRootPage ? BTreeReader::firstPageHeaderOffset : 0;
+            auto it = page + headerOffset;
+            BTreeReader bTreeReader;
+            bTreeReader.readHeader(it);
+
+            if (bTreeReader.isLeafType())
+            {
+                pages.push_back(pageNumber);
+                if (nullptr != leaves) { leaves->push_back(pageNumber); }
+                continue;
+            }
+            if (!bTreeReader.isInteriorType())
+            {
+                wal::Log::get().info() << "page " << pageNumber << " (root " << root << ") isn't a b-tree page, skipping";
+                continue;
+            }
+
+            pages.push_back(pageNumber);
+            pending.push_back(converters::Endian::loadBig<uint32_t>(data + headerOffset + rightMostChildOffset));
+            it = page + headerOffset + interiorHeaderSize;
+            bTreeReader.readPointerArray(it);
+            // interior cells of both table & index b-trees start with the left child's page number
+            for (auto ptr : bTreeReader.getPointerArray())
+            {
+                if (ptr + sizeof(uint32_t) > _pages.pageSize()) { continue; }
+                pending.push_back(converters::Endian::loadBig<uint32_t>(data + ptr));
+            }
+        }
+        catch(const std::out_of_range& e)
+        {
+            wal::Log::get().err() << "b-tree page " << pageNumber << " (root " << root << ") is malformed, skipping";
+        }
+    }
+}
+
+std::optional<size_t> TableMap::tableOf(uint32_t pageNumber) const
+{
+    auto it = _tablePages.find(pageNumber);
+    if (_tablePages.end() == it) { return std::nullopt; }
+    return it->second;
+}
+
+uint64_t TableMap::stateKey(const WalFrameReader& walReader, const MappedFile* database, size_t frameCount)
+{
+    uint64_t key = 0xcbf29ce484222325ULL;
+    const uint32_t salts[2] = { walReader.header().salt1(), walReader.header().salt2() };
+    hash(key, salts, sizeof(salts));
+    hash(key, &frameCount, sizeof(frameCount));
+    if (frameCount > 0)
+    {
+        // the last frame's checksum covers every frame before it
+        const auto last = walReader.frameHeaderAt(frameCount - 1);
+        const uint32_t checksum[2] = { last.checksum1(), last.checksum2() };
+        hash(key, checksum, sizeof(checksum));
+    }
+    if (nullptr != database)
+    {
+        const size_t size = database->size();
+        hash(key, &size, sizeof(size));
+        if (size >= databaseChangeCounterOffset + 2 * sizeof(uint32_t))
+        {
+            hash(key, database->data() + databaseChangeCounterOffset, 2 * sizeof(uint32_t));
+        }
+    }
+    return key;
+}
+
+bool TableMap::save(const std::filesystem::path& path, uint64_t key) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) { return false; }
+
+    file.write(cacheMagic.data(), cacheMagic.size());
+    writeValue(file, key);
+    writeValue(file, static_cast<uint32_t>(_tables.size()));
+    for (const auto& table : _tables)
+    {
+        writeValue(file, table.rootPage);
+        writeString(file, table.name);
+        writeString(file, table.sql);
+    }
+    writeValue(file, static_cast<uint32_t>(_tablePages.size()));
+    for (const auto& [page, table] : _tablePages)
+    {
+        writeValue(file, page);
+        writeValue(file, static_cast<uint32_t>(table));
+    }
+    return static_cast<bool>(file);
+}
+
+bool TableMap::load(const std::filesystem::path& path, uint64_t key)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) { return false; }
+
+    std::array<char, cacheMagic.size()> magic{};
+    uint64_t savedKey = 0;
+    if (!file.read(magic.data(), magic.size()) || magic != cacheMagic) { return false; }
+    if (!readValue(file, savedKey) || savedKey != key) { return false; }
+
+    std::vector<Table> tables;
+    uint32_t count = 0;
+    if (!readValue(file, count)) { return false; }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Table table;
+        if (!readValue(file, table.rootPage) || !readString(file, table.name) || !readString(file, table.sql)) { return false; }
+        tables.push_back(std::move(table));
+    }
+
+    std::unordered_map<uint32_t, size_t> tablePages;
+    if (!readValue(file, count)) { return false; }
+    tablePages.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t page = 0;
+        uint32_t table = 0;
+        if (!readValue(file, page) || !readValue(file, table) || table >= tables.size()) { return false; }
+        tablePages.emplace(page, table);
+    }
+
+    _tables = std::move(tables);
+    _tablePages = std::move(tablePages);
+    return true;
+}
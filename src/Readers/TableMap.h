@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include "Utils/MappedFile.h"
+#include "PageSource.h"
+#include "WalFrameReader.h"
+
+namespace wal::readers {
+
+    // maps database pages to the table they belong to. the tables are read from sqlite_schema (the b-tree on page 1)
+    // and the b-tree of every table is walked from it's root page to find all of it's pages
+    class TableMap
+    {
+        public:
+            struct Table
+            {
+                std::string name;
+                std::string sql;    // the CREATE TABLE statement as stored in sqlite_schema
+                uint32_t rootPage;
+            };
+
+            explicit TableMap(const PageSource& pages);
+            ~TableMap() = default;
+
+            // read the tables and walk their b-trees as they were when the transaction of frameIndex was committed
+            void build(size_t frameIndex);
+
+            // a map saved by save(), returns false if the file is missing, malformed or was saved with another key
+            bool load(const std::filesystem::path& path, uint64_t key);
+
+            bool save(const std::filesystem::path& path, uint64_t key) const;
+
+            // index in tables() of the table that owns the page
+            std::optional<size_t> tableOf(uint32_t pageNumber) const;
+
+            const std::vector<Table>& tables() const { return _tables; }
+
+            size_t pageCount() const { return _tablePages.size(); }
+
+            // identifies the database & WAL state a map was built from, a cached map with another key is stale
+            static uint64_t stateKey(const WalFrameReader& walReader, const MappedFile* database, size_t frameCount);
+
+        private:
+            void readSchema(size_t frameIndex);
+            // every page of the b-tree at root, leaf pages are also added to leaves if it's given
+            void walk(uint32_t root, size_t frameIndex, std::vector<uint32_t>& pages, std::vector<uint32_t>* leaves) const;
+
+            static constexpr uint32_t schemaRootPage = 1;
+
+            const PageSource& _pages;
+            std::vector<Table> _tables;
+            std::unordered_map<uint32_t, size_t> _tablePages; // page number to table index
+    };
+}
@@ -0,0 +1,146 @@
+#include "WalChecksum.h"
+#include <cstring>
+#include <bit>
+
+using namespace wal::readers;
+
+// the kernels are always inlined so they get compiled for the target of the function using them
+#if defined(__GNUC__)
+#define WAL_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define WAL_ALWAYS_INLINE inline
+#endif
+
+namespace {
+
+    // 2x2 matrix over uint32 (arithmetic mod 2^32, same as the checksum)
+    struct Matrix
+    {
+        uint32_t a, b, c, d; // [[a,b],[c,d]]
+
+        constexpr Matrix operator*(const Matrix& o) const
+        {
+            return { a*o.a + b*o.c, a*o.b + b*o.d,
+                     c*o.a + d*o.c, c*o.b + d*o.d };
+        }
+    };
+
+    // one step: (s1,s2) -> M*(s1,s2) + N*(x0,x1)
+    constexpr Matrix stepM{1, 1, 1, 2};
+    constexpr Matrix stepN{1, 0, 1, 1};
+
+    struct BlockCoefficients
+    {
+        // contribution of word pair k to s1 and s2
+        std::array<uint32_t, WalChecksum::blockPairs> s1x0{}, s1x1{}, s2x0{}, s2x1{};
+        Matrix carry{1, 0, 0, 1}; // M^blockPairs, applied to the incoming sums
+    };
+
+    constexpr BlockCoefficients makeCoefficients()
+    {
+        BlockCoefficients coef;
+        // walk backwards: pair k is followed by (blockPairs-1-k) steps, so it's weighted by M^(blockPairs-1-k) * N
+        Matrix power{1, 0, 0, 1};
+        for (size_t i = 0; i < WalChecksum::blockPairs; ++i)
+        {
+            size_t k = WalChecksum::blockPairs - 1 - i;
+            auto weight = power * stepN;
+            coef.s1x0[k] = weight.a;
+            coef.s1x1[k] = weight.b;
+            coef.s2x0[k] = weight.c;
+            coef.s2x1[k] = weight.d;
+            power = power * stepM;
+        }
+        coef.carry = power;
+        return coef;
+    }
+
+    constexpr BlockCoefficients coefficients = makeCoefficients();
+
+    template<bool SWAP>
+    WAL_ALWAYS_INLINE uint32_t loadWord(const uint8_t* data)
+    {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        if constexpr (SWAP) { return std::byteswap(word); }
+        return word;
+    }
+
+    template<bool SWAP>
+    WAL_ALWAYS_INLINE WalChecksum::Value scalar(const uint8_t* data, size_t size, WalChecksum::Value sum)
+    {
+        for (size_t i = 0; i + 8 <= size; i += 8)
+        {
+            sum.s1 += loadWord<SWAP>(data + i) + sum.s2;
+            sum.s2 += loadWord<SWAP>(data + i + 4) + sum.s1;
+        }
+        return sum;
+    }
+
+    template<bool SWAP>
+    WAL_ALWAYS_INLINE WalChecksum::Value blocks(const uint8_t* data, size_t size, WalChecksum::Value sum)
+    {
+        constexpr size_t blockBytes = WalChecksum::blockPairs * 8;
+        size_t pos = 0;
+        for (; pos + blockBytes <= size; pos += blockBytes)
+        {
+            std::array<uint32_t, WalChecksum::blockPairs> x0, x1;
+            for (size_t k = 0; k < WalChecksum::blockPairs; ++k)
+            {
+                x0[k] = loadWord<SWAP>(data + pos + k*8);
+                x1[k] = loadWord<SWAP>(data + pos + k*8 + 4);
+            }
+
+            uint32_t s1 = 0, s2 = 0;
+            for (size_t k = 0; k < WalChecksum::blockPairs; ++k)
+            {
+                s1 += coefficients.s1x0[k] * x0[k] + coefficients.s1x1[k] * x1[k];
+                s2 += coefficients.s2x0[k] * x0[k] + coefficients.s2x1[k] * x1[k];
+            }
+
+            const auto& m = coefficients.carry;
+            sum = { m.a * sum.s1 + m.b * sum.s2 + s1,
+                    m.c * sum.s1 + m.d * sum.s2 + s2 };
+        }
+        return scalar<SWAP>(data + pos, size - pos, sum);
+    }
+
+    inline bool needsSwap(bool bigEndian)
+    {
+        return bigEndian != (std::endian::native == std::endian::big);
+    }
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    // the weighted sums need a vector 32bit multiply to beat the plain loop, which baseline x86-64
+    // doesn't have, so the block kernel is only used when the cpu supports avx2
+    #define WAL_CHECKSUM_DISPATCH 1
+
+    __attribute__((target("avx2")))
+    WalChecksum::Value blocksAvx2(const uint8_t* data, size_t size, bool swap, WalChecksum::Value seed)
+    {
+        return swap ? blocks<true>(data, size, seed) : blocks<false>(data, size, seed);
+    }
+
+    bool hasAvx2()
+    {
+        static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+        return supported;
+    }
+#endif
+}
+
+WalChecksum::Value WalChecksum::compute(const uint8_t* data, size_t size, bool bigEndian, Value seed)
+{
+    bool swap = needsSwap(bigEndian);
+#ifdef WAL_CHECKSUM_DISPATCH
+    if (hasAvx2()) { return blocksAvx2(data, size, swap, seed); }
+    return swap ? scalar<true>(data, size, seed) : scalar<false>(data, size, seed);
+#else
+    return swap ? blocks<true>(data, size, seed) : blocks<false>(data, size, seed);
+#endif
+}
+
+WalChecksum::Value WalChecksum::computeReference(const uint8_t* data, size_t size, bool bigEndian, Value seed)
+{
+    return needsSwap(bigEndian) ? scalar<true>(data, size, seed) : scalar<false>(data, size, seed);
+}
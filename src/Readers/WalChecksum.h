@@ -0,0 +1,35 @@
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#pragma once
+
+namespace wal::readers {
+
+    // sqlite's WAL checksum (see walChecksumBytes in wal.c): the data is read as pairs of 32bit words
+    // and every pair is folded into the running sums with
+    //     s1 += x0 + s2;
+    //     s2 += x1 + s1;
+    // which is one long dependency chain. the recurrence is linear, so a block of pairs can also be
+    // written as weighted sums of the words (coefficients depend only on the position in the block)
+    // plus the incoming sums multiplied by a fixed matrix. the weighted sums have no dependency
+    // between words and get vectorized by the compiler
+    class WalChecksum
+    {
+        public:
+            struct Value
+            {
+                uint32_t s1 = 0;
+                uint32_t s2 = 0;
+
+                bool operator==(const Value& other) const = default;
+            };
+
+            // size must be a multiple of 8, words are read as big endian if bigEndian is set, native otherwise
+            static Value compute(const uint8_t* data, size_t size, bool bigEndian, Value seed);
+
+            // the plain byte by byte definition, kept as a reference for tests
+            static Value computeReference(const uint8_t* data, size_t size, bool bigEndian, Value seed);
+
+            static constexpr size_t blockPairs = 64; // 512 bytes, page sizes are always a multiple of it
+    };
+}
@@ -0,0 +1,111 @@
+#include "WalFollower.h"
+#include <fstream>
+#include <array>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr std::array<char, 8> stateMagic = { 'W', 'A', 'L', 'S', 'T', 'A', 'T', 'E' };
+
+    struct __attribute((packed)) State
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t pageSize;
+        uint32_t salt1;
+        uint32_t salt2;
+        uint64_t nextFrame;
+        uint64_t offset;        // of the next frame's header in the WAL
+        uint32_t checksum1;     // checksum of the frame before the next one (or the header's)
+        uint32_t checksum2;
+    };
+}
+
+WalFollower::WalFollower(WalFrameReader& walReader):
+    _walReader(walReader)
+{}
+
+WalFollower::Update WalFollower::poll()
+{
+    Update update;
+    // the header is written last when the WAL is started over, until then it's the old one or it's torn
+    if (!_walReader.readHeader() || !_walReader.isHeaderChecksumValid()) { return update; }
+
+    const auto& header = _walReader.header();
+    if (!_started || header.salt1() != _salt1 || header.salt2() != _salt2 || !matchesPosition())
+    {
+        update.reset = _started;
+        _started = true;
+        _salt1 = header.salt1();
+        _salt2 = header.salt2();
+        _pageSize = _walReader.pageSize();
+        _nextFrame = 0;
+        _checksum = { header.checksum1(), header.checksum2() };
+    }
+
+    auto checksum = _checksum;
+    const size_t count = _walReader.frameCount();
+    for (size_t index = _nextFrame; index < count; ++index)
+    {
+        auto frameHeader = _walReader.frameHeaderAt(index);
+        // a frame of the generation before the WAL was started over, or one that isn't completely written yet
+        if (frameHeader.salt1() != _salt1 || frameHeader.salt2() != _salt2) { break; }
+        checksum = _walReader.frameChecksum(index, checksum);
+        if (checksum.s1 != frameHeader.checksum1() || checksum.s2 != frameHeader.checksum2()) { break; }
+
+        if (frameHeader.sizeInPage() == 0) { continue; }
+        for (size_t frame = _nextFrame; frame <= index; ++frame) { update.frames.push_back(frame); }
+        _nextFrame = index + 1;
+        _checksum = checksum;
+    }
+    return update;
+}
+
+bool WalFollower::matchesPosition() const
+{
+    if (_walReader.pageSize() != _pageSize || _walReader.frameCount() < _nextFrame) { return false; }
+    if (_nextFrame == 0)
+    {
+        return _checksum.s1 == _walReader.header().checksum1() && _checksum.s2 == _walReader.header().checksum2();
+    }
+    // the frame is only compared, the frames before it were checked when they were returned
+    auto frameHeader = _walReader.frameHeaderAt(_nextFrame - 1);
+    return _checksum.s1 == frameHeader.checksum1() && _checksum.s2 == frameHeader.checksum2();
+}
+
+bool WalFollower::save(const std::filesystem::path& path) const
+{
+    const State state{ stateMagic, version, _pageSize, _salt1, _salt2, _nextFrame, _walReader.frameOffset(_nextFrame),
+                       _checksum.s1, _checksum.s2 };
+
+    // a run that's killed while writing keeps the previous state
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(&state), sizeof(state))) { return false; }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    return !ec;
+}
+
+bool WalFollower::load(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) { return false; }
+
+    State state{};
+    if (!file.read(reinterpret_cast<char*>(&state), sizeof(state))) { return false; }
+    if (state.magic != stateMagic || state.version != version || state.pageSize == 0) { return false; }
+    // the offset only follows from the frame with the page size it was saved with
+    if (state.pageSize == _walReader.pageSize() && state.offset != _walReader.frameOffset(state.nextFrame)) { return false; }
+
+    _started = true;
+    _pageSize = state.pageSize;
+    _salt1 = state.salt1;
+    _salt2 = state.salt2;
+    _nextFrame = state.nextFrame;
+    _checksum = { state.checksum1, state.checksum2 };
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <filesystem>
+#include "WalFrameReader.h"
+#include "WalChecksum.h"
+
+namespace wal::readers {
+
+    // follows a WAL file that's still being written to. every poll returns the frames that were committed
+    // since the last one: frames with the header's salts and a valid checksum chain up to the last commit frame.
+    // frames after it (a transaction that's still being written) are checked again on the next poll, so a frame
+    // is only returned once. when sqlite starts the WAL over after a checkpoint (new salts in the header)
+    // following restarts from the first frame.
+    // the position can be saved to a state file so a later run goes on from there
+    class WalFollower
+    {
+        public:
+            struct Update
+            {
+                std::vector<size_t> frames;
+                bool reset = false;     // the WAL was started over, frame indexes from before are invalid
+            };
+
+            // the reader's file has to be refreshed by the caller before every poll
+            explicit WalFollower(WalFrameReader& walReader);
+            ~WalFollower() = default;
+
+            // reads the header again, returns no frames while the header is missing or torn
+            Update poll();
+
+            // index of the first frame that wasn't returned yet
+            size_t nextFrame() const { return _nextFrame; }
+
+            // write the position (after the last returned commit frame) to path, it's replaced only once
+            // the new state is completely written. returns false if it couldn't be written
+            bool save(const std::filesystem::path& path) const;
+
+            // go on from a saved position, the next poll starts over if the WAL isn't the one it was saved from
+            // anymore (other salts after a checkpoint, other page size or the frame before it changed).
+            // returns false if the file is missing or malformed
+            bool load(const std::filesystem::path& path);
+
+        private:
+            // true if the frames before _nextFrame are the ones the position was taken after
+            bool matchesPosition() const;
+
+            static constexpr uint32_t version = 1;
+
+            WalFrameReader& _walReader;
+            bool _started = false;
+            uint32_t _pageSize = 0;
+            uint32_t _salt1 = 0;
+            uint32_t _salt2 = 0;
+            size_t _nextFrame = 0;
+            WalChecksum::Value _checksum{};  // checksum of the frame before _nextFrame
+    };
+}
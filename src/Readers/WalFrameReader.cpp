@@ -0,0 +1,117 @@
+#include "WalFrameReader.h"
+#include <cstring>
+#include <bit>
+#include <algorithm>
+
+using namespace wal::readers;
+
+namespace {
+    constexpr uint32_t minPageSize = 512;
+    constexpr uint32_t maxPageSize = 65536;
+}
+
+WalFrameReader::WalFrameReader(const MappedFile& file):
+    _file(file)
+{
+    FrameHeader frameHeader;
+    _headerSize = _header.sizeOf();
+    _frameHeaderSize = frameHeader.sizeOf();
+}
+
+bool WalFrameReader::readHeader()
+{
+    if (_file.size() < _headerSize) { return false; }
+
+    std::memcpy(static_cast<char*>(_header), _file.data(), _headerSize);
+    _pageSize = _header.page_size();
+
+    return _pageSize >= minPageSize && _pageSize <= maxPageSize && std::has_single_bit(_pageSize);
+}
+
+size_t WalFrameReader::frameCount() const
+{
+    if (_pageSize == 0 || _file.size() < _headerSize) { return 0; }
+    return (_file.size() - _headerSize) / frameSize();
+}
+
+bool WalFrameReader::hasIncompleteFrame() const
+{
+    if (_pageSize == 0 || _file.size() < _headerSize) { return false; }
+    return (_file.size() - _headerSize) % frameSize() != 0;
+}
+
+WalFrameReader::Frame WalFrameReader::frameAt(size_t index) const
+{
+    size_t offset = _headerSize + index * frameSize();
+    if (index >= frameCount()) { throw std::out_of_range("frame index is out of range of the WAL file"); }
+
+    Frame frame{ frameHeaderAt(index), FixedRuntimeArray<uint8_t>::iterator(nullptr, 0), index, offset };
+
+    // the mapping is read only, readers only ever read through the iterator
+    auto page = const_cast<uint8_t*>(_file.data() + offset + _frameHeaderSize);
+    frame.data = FixedRuntimeArray<uint8_t>::iterator(page, _pageSize);
+    return frame;
+}
+
+FrameHeader WalFrameReader::frameHeaderAt(size_t index) const
+{
+    if (index >= frameCount()) { throw std::out_of_range("frame index is out of range of the WAL file"); }
+
+    FrameHeader frameHeader;
+    std::memcpy(static_cast<char*>(frameHeader), _file.data() + _headerSize + index * frameSize(), _frameHeaderSize);
+    return frameHeader;
+}
+
+bool WalFrameReader::isHeaderChecksumValid() const
+{
+    if (_header.header() != magicLittleEndian && _header.header() != magicBigEndian) { return false; }
+    if (_file.size() < _headerSize) { return false; }
+
+    auto checksum = WalChecksum::compute(_file.data(), headerChecksumBytes, bigEndianChecksum(), {});
+    return checksum.s1 == _header.checksum1() && checksum.s2 == _header.checksum2();
+}
+
+WalChecksum::Value WalFrameReader::frameChecksum(size_t index, WalChecksum::Value previous) const
+{
+    size_t offset = _headerSize + index * frameSize();
+    if (index >= frameCount()) { throw std::out_of_range("frame index is out of range of the WAL file"); }
+
+    bool bigEndian = bigEndianChecksum();
+    auto checksum = WalChecksum::compute(_file.data() + offset, frameHeaderChecksumBytes, bigEndian, previous);
+    return WalChecksum::compute(_file.data() + offset + _frameHeaderSize, _pageSize, bigEndian, checksum);
+}
+
+size_t WalFrameReader::validFrameCount() const
+{
+    if (!isHeaderChecksumValid()) { return 0; }
+
+    WalChecksum::Value checksum{ _header.checksum1(), _header.checksum2() };
+    const size_t count = frameCount();
+    for (size_t index = 0; index < count; ++index)
+    {
+        auto frameHeader = frameHeaderAt(index);
+
+        // a frame from an older generation of the WAL, sqlite stops here as well
+        if (frameHeader.salt1() != _header.salt1() || frameHeader.salt2() != _header.salt2()) { return index; }
+
+        checksum = frameChecksum(index, checksum);
+        if (checksum.s1 != frameHeader.checksum1() || checksum.s2 != frameHeader.checksum2()) { return index; }
+    }
+    return count;
+}
+
+std::vector<WalFrameReader::Transaction> WalFrameReader::transactions(size_t frameCount) const
+{
+    std::vector<Transaction> result;
+    frameCount = std::min(frameCount, this->frameCount());
+    size_t firstFrame = 0;
+    for (size_t index = 0; index < frameCount; ++index)
+    {
+        auto frameHeader = frameHeaderAt(index);
+        if (frameHeader.sizeInPage() == 0) { continue; }
+
+        result.push_back({ firstFrame, index, frameHeader.sizeInPage() });
+        firstFrame = index + 1;
+    }
+    return result;
+}
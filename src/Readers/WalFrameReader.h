@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "Utils/FixedRuntimeArray.h"
+#include "Utils/MappedFile.h"
+#include "WalHeaderReader.h"
+#include "FrameHeader.h"
+#include "WalChecksum.h"
+
+namespace wal::readers {
+
+    // walks the frames of a mapped WAL file, every frame's page is a view
+    // directly into the mapping so nothing is copied before decoding
+    class WalFrameReader
+    {
+        public:
+            // frames from firstFrame up to lastFrame (inclusive), lastFrame is the commit frame
+            struct Transaction
+            {
+                size_t firstFrame;
+                size_t lastFrame;
+                uint32_t databaseSize; // size of the database in pages after the commit
+            };
+
+            struct Frame
+            {
+                FrameHeader header;
+                // bounded to the page size of the WAL, reading past the page throws std::out_of_range
+                FixedRuntimeArray<uint8_t>::iterator data;
+                size_t index;
+                size_t offset; // offset of the frame header in the file
+            };
+
+            explicit WalFrameReader(const MappedFile& file);
+            ~WalFrameReader() = default;
+
+            // read & validate the WAL header, returns false if the file is too small or the header is malformed
+            bool readHeader();
+
+            const WalHeaderReader& header() const { return _header; }
+
+            uint32_t pageSize() const { return _pageSize; }
+
+            size_t fileSize() const { return _file.size(); }
+
+            // size of a frame header and it's page
+            size_t frameSize() const { return _frameHeaderSize + _pageSize; }
+
+            // offset of the frame's header in the file, the frame doesn't have to be in the file (yet)
+            size_t frameOffset(size_t index) const { return _headerSize + index * frameSize(); }
+
+            // number of complete frames in the file
+            size_t frameCount() const;
+
+            // true if the file ends with a partial frame
+            bool hasIncompleteFrame() const;
+
+            Frame frameAt(size_t index) const;
+
+            // only the frame header, without touching the frame's page
+            FrameHeader frameHeaderAt(size_t index) const;
+
+            // the lowest bit of the header magic selects big endian checksums
+            bool bigEndianChecksum() const { return _header.header() & 1; }
+
+            bool isHeaderChecksumValid() const;
+
+            // checksum of a frame, chained from the checksum of the frame before it (or the header's for the first frame)
+            WalChecksum::Value frameChecksum(size_t index, WalChecksum::Value previous) const;
+
+            // number of frames from the start of the file that have the header's salts and a valid checksum chain.
+            // like sqlite's recovery, everything after the first torn or stale frame is invalid
+            size_t validFrameCount() const;
+
+            // group the first frameCount frames into transactions, a frame with a non zero database size
+            // is a commit frame. frames after the last commit frame don't belong to any transaction
+            std::vector<Transaction> transactions(size_t frameCount) const;
+
+            static constexpr uint32_t magicLittleEndian = 0x377f0682;
+            static constexpr uint32_t magicBigEndian = 0x377f0683;
+
+        private:
+            // the frame header's checksum covers it's first 8 bytes (page number & commit size)
+            static constexpr size_t frameHeaderChecksumBytes = 8;
+            // the WAL header's checksum covers everything before the checksum itself
+            static constexpr size_t headerChecksumBytes = 24;
+
+            const MappedFile& _file;
+            WalHeaderReader _header;
+            uint32_t _pageSize = 0;
+            size_t _headerSize = 0;
+            size_t _frameHeaderSize = 0;
+    };
+}
@@ -4,8 +4,7 @@
 
 #define PROP(NAME) uint32_t NAME() const\
 {\
-    static auto tmp = converters::Endian::fromBig(_header.NAME);\
-    return tmp;\
+    return converters::Endian::fromBig(_header.NAME);\
 }
 
 namespace wal::readers {
@@ -0,0 +1,52 @@
+#include "WalPageMap.h"
+
+using namespace wal::readers;
+
+WalPageMap::WalPageMap(const WalFrameReader& walReader, const FrameIndex* index):
+    _walReader(walReader),
+    _index(index)
+{}
+
+uint32_t WalPageMap::pageNumberOf(size_t frameIndex) const
+{
+    return _index ? _index->entry(frameIndex).pageNumber : _walReader.frameHeaderAt(frameIndex).pageNumber();
+}
+
+bool WalPageMap::isSaltValid(size_t frameIndex) const
+{
+    if (_index) { return _index->entry(frameIndex).flags & FrameIndex::SaltValid; }
+    const auto frameHeader = _walReader.frameHeaderAt(frameIndex);
+    return frameHeader.salt1() == _walReader.header().salt1() && frameHeader.salt2() == _walReader.header().salt2();
+}
+
+void WalPageMap::build(const std::vector<size_t>& frames)
+{
+    _latest.clear();
+    _latest.reserve(frames.size());
+    std::unordered_map<uint32_t, size_t> stale;
+    for (auto frameIndex : frames)
+    {
+        if (isSaltValid(frameIndex)) { _latest.insert_or_assign(pageNumberOf(frameIndex), frameIndex); }
+        else { stale.insert_or_assign(pageNumberOf(frameIndex), frameIndex); }
+    }
+    for (const auto& [pageNumber, frameIndex] : stale) { _latest.emplace(pageNumber, frameIndex); }
+}
+
+std::optional<size_t> WalPageMap::latestFrame(uint32_t pageNumber) const
+{
+    auto it = _latest.find(pageNumber);
+    if (_latest.end() == it) { return std::nullopt; }
+    return it->second;
+}
+
+std::vector<size_t> WalPageMap::latestOnly(const std::vector<size_t>& frames) const
+{
+    std::vector<size_t> result;
+    result.reserve(_latest.size());
+    for (auto frameIndex : frames)
+    {
+        auto latest = latestFrame(pageNumberOf(frameIndex));
+        if (latest && latest.value() == frameIndex) { result.push_back(frameIndex); }
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include "WalFrameReader.h"
+#include "FrameIndex.h"
+
+namespace wal::readers {
+
+    // maps database page numbers to the newest frame holding that page (what sqlite's wal-index does)
+    class WalPageMap
+    {
+        public:
+            // with a frame index the frame headers aren't read
+            explicit WalPageMap(const WalFrameReader& walReader, const FrameIndex* index = nullptr);
+            ~WalPageMap() = default;
+
+            // map every page to the last of the given frames that holds it, frames are expected in file order.
+            // frames with salts of an older generation of the WAL hold older versions of their page, they are
+            // only used for pages that no frame with the header's salts holds
+            void build(const std::vector<size_t>& frames);
+
+            std::optional<size_t> latestFrame(uint32_t pageNumber) const;
+
+            // the given frames without the ones superseded by a later frame of the same page, order is kept
+            std::vector<size_t> latestOnly(const std::vector<size_t>& frames) const;
+
+            size_t size() const { return _latest.size(); }
+
+        private:
+            uint32_t pageNumberOf(size_t frameIndex) const;
+            bool isSaltValid(size_t frameIndex) const;
+
+            const WalFrameReader& _walReader;
+            const FrameIndex* _index;
+            std::unordered_map<uint32_t, size_t> _latest;
+    };
+}
@@ -0,0 +1,90 @@
+#include "FileWatcher.h"
+#include <thread>
+#include <array>
+
+#if defined(__linux__)
+#define WAL_HAS_INOTIFY 1
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+using namespace wal;
+
+#ifdef WAL_HAS_INOTIFY
+
+FileWatcher::FileWatcher(const std::filesystem::path& path):
+    _path(path),
+    _fd(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    watch();
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (_fd >= 0) { ::close(_fd); }
+}
+
+bool FileWatcher::wait(std::chrono::milliseconds timeout)
+{
+    // the file may have been created again since it was deleted
+    if (_watch < 0) { watch(); }
+    if (_watch < 0)
+    {
+        std::this_thread::sleep_for(timeout);
+        return true;
+    }
+
+    pollfd fd{ _fd, POLLIN, 0 };
+    int ready = ::poll(&fd, 1, static_cast<int>(timeout.count()));
+    if (ready < 0) { return errno != EINTR; }
+    if (ready == 0) { return true; }
+
+    // drain the events, only the fact that something happened matters
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    ssize_t length = 0;
+    while ((length = ::read(_fd, buffer.data(), buffer.size())) > 0)
+    {
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            // the file was deleted or moved away, a new one will have to be watched
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) { unwatch(); }
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+    return true;
+}
+
+void FileWatcher::watch()
+{
+    if (_fd < 0) { return; }
+    _watch = ::inotify_add_watch(_fd, _path.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF);
+}
+
+void FileWatcher::unwatch()
+{
+    if (_watch >= 0) { ::inotify_rm_watch(_fd, _watch); }
+    _watch = -1;
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::filesystem::path& path):
+    _path(path)
+{}
+
+FileWatcher::~FileWatcher() {}
+
+bool FileWatcher::wait(std::chrono::milliseconds timeout)
+{
+    std::this_thread::sleep_for(timeout);
+    return true;
+}
+
+void FileWatcher::watch() {}
+
+void FileWatcher::unwatch() {}
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+
+namespace wal {
+
+    // waits for a file to be written to. uses inotify where it's available and falls back to
+    // sleeping for the whole timeout (polling) when it isn't or the file can't be watched (i.e. it doesn't exist)
+    class FileWatcher
+    {
+        public:
+            explicit FileWatcher(const std::filesystem::path& path);
+            ~FileWatcher();
+
+            FileWatcher(const FileWatcher&) = delete;
+            FileWatcher& operator=(const FileWatcher&) = delete;
+
+            // returns when the file changed or the timeout passed, the caller checks what changed either way.
+            // returns early (false) if a signal interrupted the wait
+            bool wait(std::chrono::milliseconds timeout);
+
+        private:
+            void watch();
+            void unwatch();
+
+            std::filesystem::path _path;
+            int _fd = -1;       // the inotify instance
+            int _watch = -1;    // the watch of the file, -1 while it isn't watched
+    };
+}
@@ -2,6 +2,8 @@
 #include <memory>
 #include <iterator>
 #include <cstring>
+#include <vector>
+#include <stdexcept>
 #pragma once
 namespace wal {
     // simple size protected array
@@ -83,6 +85,12 @@ namespace wal {
                         return *(_ptr+index);
                     }
 
+                    // raw position, null once the iterator passed the end
+                    T* ptr() const { return _ptr; }
+
+                    // how many elements are left from the current position
+                    size_t remaining() const { return nullptr == _ptr ? 0 : _size - _count; }
+
                 private:
                     T* _ptr;
                     size_t _size;
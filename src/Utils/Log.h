@@ -1,26 +1,57 @@
 #include <iostream>
+#include <sstream>
+#include <mutex>
+#include <optional>
 #pragma once
 
 namespace wal {
 
+    // collects a single log line and writes it to the target stream in one go when destroyed,
+    // so lines written from different threads don't interleave
     class OsstreamBubbleWrap
     {
         public:
             OsstreamBubbleWrap(std::ostream& ostream, std::string_view prefix):
-                _ss(ostream.rdbuf()),
+                _target(ostream.rdbuf()),
                 _pf(prefix)
-            {}
+            {
+                // nothing will be written for a disabled level, so don't even build the line's stream
+                if (nullptr != _target) { _ss.emplace(); }
+            }
 
-            ~OsstreamBubbleWrap() { _ss << std::endl; }
+            ~OsstreamBubbleWrap()
+            {
+                if (!_ss) { return; }
+                *_ss << std::endl;
+                auto line = _ss->str();
+                std::lock_guard lock(writeMutex());
+                _target->sputn(line.data(), static_cast<std::streamsize>(line.size()));
+                _target->pubsync();
+            }
 
             template<typename T>
             std::ostream& operator<<(const T& obj)
             {
-                return _ss << _pf << obj ;
+                if (!_ss) { return nullStream(); }
+                return *_ss << _pf << obj ;
             }
 
         private:
-            std::ostream _ss;
+            // a stream without a buffer, the operators chained on it fail right away without formatting
+            static std::ostream& nullStream()
+            {
+                thread_local std::ostream stream(nullptr);
+                return stream;
+            }
+
+            static std::mutex& writeMutex()
+            {
+                static std::mutex mutex;
+                return mutex;
+            }
+
+            std::streambuf* _target;
+            std::optional<std::ostringstream> _ss;
             std::string _pf;
     };
 
@@ -43,6 +74,9 @@ namespace wal {
 
             void setLogLevel(const ReportLevel& level);
 
+            // lets callers skip building messages that would go to the null stream anyway
+            bool enabled(const ReportLevel& level) const { return _level >= level; }
+
             OsstreamBubbleWrap debug();
             OsstreamBubbleWrap info();
             OsstreamBubbleWrap err();
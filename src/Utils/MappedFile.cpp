@@ -0,0 +1,125 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <string>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAL_HAS_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace wal;
+
+MappedFile::MappedFile(const std::filesystem::path& path, AccessHint hint):
+    _path(path),
+    _hint(hint)
+{
+    std::error_code ec;
+    _writeTime = std::filesystem::last_write_time(_path, ec);
+    map();
+    advise(hint);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+bool MappedFile::refresh()
+{
+    // the time is taken before mapping, a write in between is seen on the next refresh
+    std::error_code ec;
+    auto size = std::filesystem::file_size(_path, ec);
+    if (ec) { return false; }
+    auto writeTime = std::filesystem::last_write_time(_path, ec);
+    if (ec || (size == _size && writeTime == _writeTime)) { return false; }
+
+    unmap();
+    _writeTime = writeTime;
+    map();
+    advise(_hint);
+    return true;
+}
+
+#ifdef WAL_HAS_MMAP
+
+void MappedFile::map()
+{
+    _fd = ::open(_path.c_str(), O_RDONLY);
+    if (_fd < 0) { throw std::runtime_error("Failed to open file " + _path.string()); }
+
+    struct stat st{};
+    if (::fstat(_fd, &st) != 0)
+    {
+        unmap();
+        throw std::runtime_error("Failed to stat file " + _path.string());
+    }
+
+    _size = static_cast<size_t>(st.st_size);
+    if (_size == 0) { return; } // nothing to map, data() stays null
+
+    void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (MAP_FAILED == addr)
+    {
+        unmap();
+        throw std::runtime_error("Failed to map file " + _path.string());
+    }
+    _data = static_cast<const uint8_t*>(addr);
+}
+
+void MappedFile::unmap()
+{
+    if (nullptr != _data) { ::munmap(const_cast<uint8_t*>(_data), _size); }
+    if (_fd >= 0) { ::close(_fd); }
+    _data = nullptr;
+    _size = 0;
+    _fd = -1;
+}
+
+void MappedFile::advise(AccessHint hint, size_t offset, size_t length) const
+{
+    if (nullptr == _data || offset >= _size) { return; }
+
+    // madvise needs a page aligned address
+    static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - (offset % pageSize);
+    if (length == 0 || offset + length > _size) { length = _size - offset; }
+    length += offset - alignedOffset;
+
+    int advice = (AccessHint::Sequential == hint ? MADV_SEQUENTIAL : MADV_RANDOM);
+    // this is only a hint, failing to apply it doesn't change the mapping
+    ::madvise(const_cast<uint8_t*>(_data) + alignedOffset, length, advice);
+}
+
+#else
+
+void MappedFile::map()
+{
+    std::ifstream file(_path, std::ios::binary | std::ios::ate);
+    if (!file) { throw std::runtime_error("Failed to open file " + _path.string()); }
+
+    _size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    if (_size == 0) { return; }
+
+    _buffer = std::make_unique<uint8_t[]>(_size);
+    if (!file.read(reinterpret_cast<char*>(_buffer.get()), _size))
+    {
+        throw std::runtime_error("Failed to read file " + _path.string());
+    }
+    _data = _buffer.get();
+}
+
+void MappedFile::unmap()
+{
+    _buffer.reset();
+    _data = nullptr;
+    _size = 0;
+}
+
+void MappedFile::advise(AccessHint, size_t, size_t) const {}
+
+#endif
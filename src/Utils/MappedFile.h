@@ -0,0 +1,52 @@
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#pragma once
+
+namespace wal {
+
+    // read only view of a whole file, backed by mmap where it's available
+    // so frames can be handed to the readers without copying them first.
+    // on platforms without mmap the file is read once into a single buffer
+    class MappedFile
+    {
+        public:
+            enum class AccessHint
+            {
+                Sequential,
+                Random
+            };
+
+            explicit MappedFile(const std::filesystem::path& path, AccessHint hint = AccessHint::Sequential);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const uint8_t* data() const { return _data; }
+
+            size_t size() const { return _size; }
+
+            // hint the kernel about the access pattern of the given range (whole file by default)
+            void advise(AccessHint hint, size_t offset = 0, size_t length = 0) const;
+
+            // map the file again if it's size or modification time changed since it was mapped (i.e. it's still
+            // being written to). returns true if it was mapped again, data() from before is invalid then.
+            // the old mapping is kept if the file can't be found (i.e. it was deleted), throws std::runtime_error
+            // if it was found but can't be mapped again (the file is empty until the next refresh)
+            bool refresh();
+
+        private:
+            void map();
+            void unmap();
+
+            std::filesystem::path _path;
+            AccessHint _hint;
+            std::filesystem::file_time_type _writeTime;
+            const uint8_t* _data = nullptr;
+            size_t _size = 0;
+            int _fd = -1;
+            std::unique_ptr<uint8_t[]> _buffer; // only used when mmap is not available
+    };
+}
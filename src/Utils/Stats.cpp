@@ -0,0 +1,132 @@
+#include "Stats.h"
+#include <sstream>
+#include <iomanip>
+
+using namespace wal;
+
+const std::array<std::string_view, Stats::counterCount> Stats::counterNames = {
+    "frames_read",
+    "frames_invalid_salt",
+    "frames_unknown_table",
+    "frames_interior",
+    "frames_other_page",
+    "frames_rowid_range",
+    "frames_malformed",
+    "pages_leaf_table",
+    "pages_leaf_index",
+    "pages_interior_table",
+    "pages_interior_index",
+    "pages_other",
+    "cells",
+    "page_bytes",
+    "rows_filtered",
+    "rows_emitted",
+    "rows_carved",
+    "formatter_errors"
+};
+
+const std::array<std::string_view, Stats::stageCount> Stats::stageNames = {
+    "frame_read",
+    "salt_check",
+    "page_header",
+    "pointer_array",
+    "record_read",
+    "filter",
+    "format",
+    "write",
+    "output"
+};
+
+void Stats::addPage(types::BTreeNodePageType type)
+{
+    switch (type)
+    {
+        case types::BTreeNodePageType::leafTable: add(Counter::PagesLeafTable); break;
+        case types::BTreeNodePageType::leafIndex: add(Counter::PagesLeafIndex); break;
+        case types::BTreeNodePageType::interiorTable: add(Counter::PagesInteriorTable); break;
+        case types::BTreeNodePageType::interiorIndex: add(Counter::PagesInteriorIndex); break;
+        default: add(Counter::PagesOther); break;
+    }
+}
+
+void Stats::addTime(Stage stage, std::chrono::steady_clock::duration elapsed)
+{
+    if (!_enabled) { return; }
+    auto& block = local();
+    const auto index = static_cast<size_t>(stage);
+    increment(block.nanoseconds[index], std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    increment(block.calls[index], 1);
+}
+
+uint64_t Stats::total(Counter counter) const
+{
+    return totals().counters[static_cast<size_t>(counter)];
+}
+
+Stats::Block& Stats::local()
+{
+    thread_local Block* block = nullptr;
+    if (nullptr == block)
+    {
+        std::lock_guard lock(_mutex);
+        _blocks.push_back(std::make_unique<Block>());
+        block = _blocks.back().get();
+    }
+    return *block;
+}
+
+Stats::Totals Stats::totals() const
+{
+    Totals result;
+    std::lock_guard lock(_mutex);
+    for (const auto& block : _blocks)
+    {
+        for (size_t i = 0; i < counterCount; ++i) { result.counters[i] += block->counters[i].load(std::memory_order_relaxed); }
+        for (size_t i = 0; i < stageCount; ++i)
+        {
+            result.nanoseconds[i] += block->nanoseconds[i].load(std::memory_order_relaxed);
+            result.calls[i] += block->calls[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+std::string Stats::summary() const
+{
+    const auto result = totals();
+    std::stringstream ss;
+    ss << "stats:\n";
+    for (size_t i = 0; i < counterCount; ++i)
+    {
+        ss << "    " << std::left << std::setw(24) << counterNames[i] << result.counters[i] << '\n';
+    }
+    // stages are summed over all threads, with --threads they add up to more than the run took
+    ss << "    " << std::left << std::setw(24) << "stage" << std::right << std::setw(12) << "calls"
+       << std::setw(14) << "total ms" << std::setw(12) << "avg ns" << '\n';
+    for (size_t i = 0; i < stageCount; ++i)
+    {
+        const auto calls = result.calls[i];
+        ss << "    " << std::left << std::setw(24) << stageNames[i] << std::right << std::setw(12) << calls
+           << std::setw(14) << std::fixed << std::setprecision(3) << result.nanoseconds[i] / 1e6
+           << std::setw(12) << (calls > 0 ? result.nanoseconds[i] / calls : 0) << '\n';
+    }
+    return ss.str();
+}
+
+std::string Stats::json() const
+{
+    const auto result = totals();
+    std::stringstream ss;
+    ss << "{\"counters\":{";
+    for (size_t i = 0; i < counterCount; ++i)
+    {
+        ss << (i > 0 ? "," : "") << '"' << counterNames[i] << "\":" << result.counters[i];
+    }
+    ss << "},\"stages\":{";
+    for (size_t i = 0; i < stageCount; ++i)
+    {
+        ss << (i > 0 ? "," : "") << '"' << stageNames[i] << "\":{\"calls\":" << result.calls[i] << ",\"ns\":" << result.nanoseconds[i] << '}';
+    }
+    ss << "}}";
+    return ss.str();
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Types.h"
+
+namespace wal {
+
+    // counters & cumulative timings of the parse stages (--stats). every thread counts into a block of it's own,
+    // so counting is a plain add without any sharing between threads, the blocks are only summed for the report.
+    // nothing is counted or timed while it's disabled, it's enabled before any thread starts decoding
+    class Stats
+    {
+        public:
+            enum class Counter : uint8_t
+            {
+                FramesRead,
+                FramesInvalidSalt,      // skipped with --valid-frames
+                FramesUnknownTable,     // skipped with --tables
+                FramesInterior,
+                FramesOtherPage,        // overflow/freelist pages & leaf pages of the kind that isn't output
+                FramesRowidRange,       // skipped as a whole by the rowid filters
+                FramesMalformed,
+                PagesLeafTable,
+                PagesLeafIndex,
+                PagesInteriorTable,
+                PagesInteriorIndex,
+                PagesOther,
+                Cells,
+                PageBytes,
+                RowsFiltered,           // dropped by --where
+                RowsEmitted,
+                RowsCarved,
+                FormatterErrors,
+                Count
+            };
+
+            enum class Stage : uint8_t
+            {
+                FrameRead,
+                SaltCheck,
+                PageHeader,
+                PointerArray,
+                RecordRead,
+                Filter,
+                Format,
+                Write,      // handing the row to the writer (sorting & deduping it for the sorted output)
+                Output,     // flushing the writer
+                Count
+            };
+
+            // adds the time until the end of the scope to a stage
+            class Timer
+            {
+                public:
+                    explicit Timer(Stage stage):
+                        _stage(stage),
+                        _running(Stats::get().enabled())
+                    {
+                        if (_running) { _start = std::chrono::steady_clock::now(); }
+                    }
+
+                    ~Timer()
+                    {
+                        if (_running) { Stats::get().addTime(_stage, std::chrono::steady_clock::now() - _start); }
+                    }
+
+                    Timer(const Timer&) = delete;
+                    Timer& operator=(const Timer&) = delete;
+
+                private:
+                    Stage _stage;
+                    bool _running;
+                    std::chrono::steady_clock::time_point _start;
+            };
+
+            static Stats& get()
+            {
+                static Stats instance;
+                return instance;
+            }
+
+            void enable() { _enabled = true; }
+
+            bool enabled() const { return _enabled; }
+
+            void add(Counter counter, uint64_t value = 1)
+            {
+                if (!_enabled) { return; }
+                increment(local().counters[static_cast<size_t>(counter)], value);
+            }
+
+            void addPage(types::BTreeNodePageType type);
+
+            void addTime(Stage stage, std::chrono::steady_clock::duration elapsed);
+
+            // sums of all threads, only meant to be read once the decoding threads are done
+            uint64_t total(Counter counter) const;
+
+            std::string summary() const;
+
+            std::string json() const;
+
+        private:
+            static constexpr size_t counterCount = static_cast<size_t>(Counter::Count);
+            static constexpr size_t stageCount = static_cast<size_t>(Stage::Count);
+
+            // only the owning thread writes a block, the atomics keep reading it for the report race free
+            struct Block
+            {
+                std::array<std::atomic<uint64_t>, counterCount> counters{};
+                std::array<std::atomic<uint64_t>, stageCount> nanoseconds{};
+                std::array<std::atomic<uint64_t>, stageCount> calls{};
+            };
+
+            struct Totals
+            {
+                std::array<uint64_t, counterCount> counters{};
+                std::array<uint64_t, stageCount> nanoseconds{};
+                std::array<uint64_t, stageCount> calls{};
+            };
+
+            Stats() = default;
+            ~Stats() = default;
+
+            // a single writer doesn't need a locked add
+            static void increment(std::atomic<uint64_t>& value, uint64_t amount)
+            {
+                value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            Block& local();
+
+            Totals totals() const;
+
+            static const std::array<std::string_view, counterCount> counterNames;
+            static const std::array<std::string_view, stageCount> stageNames;
+
+            bool _enabled = false;
+            mutable std::mutex _mutex;
+            std::vector<std::unique_ptr<Block>> _blocks;   // blocks of threads that ended are kept for the report
+    };
+}
@@ -0,0 +1,40 @@
+#include "ThreadPool.h"
+
+using namespace wal;
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0) { threads = 1; }
+    _workers.reserve(threads);
+    for (size_t i=0; i<threads; ++i)
+    {
+        _workers.emplace_back([this](){ workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (auto& worker : _workers) { worker.join(); }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(_mutex);
+            _condition.wait(lock, [this](){ return _stop || !_tasks.empty(); });
+            // finish whatever is queued before stopping
+            if (_tasks.empty()) { return; }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,52 @@
+#include <cstddef>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#pragma once
+
+namespace wal {
+
+    // fixed size pool of worker threads consuming a single task queue
+    class ThreadPool
+    {
+        public:
+            explicit ThreadPool(size_t threads);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            size_t size() const { return _workers.size(); }
+
+            // queue a task, the returned future holds the task's result (or the exception it threw)
+            template<typename F>
+            std::future<std::invoke_result_t<F>> submit(F&& task)
+            {
+                using RET = std::invoke_result_t<F>;
+                // std::function must be copyable, so the packaged task is shared
+                auto packaged = std::make_shared<std::packaged_task<RET()>>(std::forward<F>(task));
+                auto future = packaged->get_future();
+                {
+                    std::lock_guard lock(_mutex);
+                    _tasks.emplace([packaged](){ (*packaged)(); });
+                }
+                _condition.notify_one();
+                return future;
+            }
+
+        private:
+            void workerLoop();
+
+            std::vector<std::thread> _workers;
+            std::queue<std::function<void()>> _tasks;
+            std::mutex _mutex;
+            std::condition_variable _condition;
+            bool _stop = false;
+    };
+}
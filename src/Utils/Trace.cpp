@@ -0,0 +1,70 @@
+#include "Trace.h"
+#include <fstream>
+#include <algorithm>
+
+using namespace wal;
+
+void Trace::enable()
+{
+    _origin = std::chrono::steady_clock::now();
+    _enabled = true;
+}
+
+void Trace::record(const char* name, const char* argName, uint64_t arg,
+                   std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    if (!_enabled) { return; }
+    auto& buffer = local();
+    const auto count = buffer.count.load(std::memory_order_relaxed);
+    auto& event = buffer.events[count % bufferEvents];
+    event.name = name;
+    event.argName = argName;
+    event.arg = arg;
+    event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - _origin).count();
+    event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    // the event is complete before the count says it's there
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+Trace::Buffer& Trace::local()
+{
+    thread_local Buffer* buffer = nullptr;
+    if (nullptr == buffer)
+    {
+        std::lock_guard lock(_mutex);
+        _buffers.push_back(std::make_unique<Buffer>());
+        buffer = _buffers.back().get();
+        buffer->thread = _buffers.size();
+    }
+    return *buffer;
+}
+
+bool Trace::save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) { return false; }
+
+    // complete ("X") events with microsecond timestamps, the names are literals that don't need escaping
+    std::lock_guard lock(_mutex);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : _buffers)
+    {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+             << ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+        first = false;
+
+        const auto count = buffer->count.load(std::memory_order_acquire);
+        for (auto index = count - std::min<uint64_t>(count, bufferEvents); index < count; ++index)
+        {
+            const auto& event = buffer->events[index % bufferEvents];
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+                 << ",\"ts\":" << event.start / 1000 << '.' << event.start / 100 % 10 << event.start / 10 % 10 << event.start % 10
+                 << ",\"dur\":" << event.duration / 1000 << '.' << event.duration / 100 % 10 << event.duration / 10 % 10 << event.duration % 10;
+            if (nullptr != event.argName) { file << ",\"args\":{\"" << event.argName << "\":" << event.arg << '}'; }
+            file << '}';
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wal {
+
+    // records scoped events of the parse (--trace) and saves them in the chrome trace event format,
+    // to be opened in chrome://tracing or perfetto. every thread records into a ring buffer of it's own
+    // without any locking, when it's full the oldest events are overwritten. only the first event of
+    // a thread takes a lock to add it's buffer. while it's disabled a scope is a single check
+    class Trace
+    {
+        public:
+            // the events of a buffer, older ones are overwritten
+            static constexpr size_t bufferEvents = 1 << 16;
+
+            // records the time until the end of the scope as an event, name (and argName) have to be string literals
+            class Scope
+            {
+                public:
+                    explicit Scope(const char* name, const char* argName = nullptr, uint64_t arg = 0):
+                        _name(name),
+                        _argName(argName),
+                        _arg(arg),
+                        _running(Trace::get().enabled())
+                    {
+                        if (_running) { _start = std::chrono::steady_clock::now(); }
+                    }
+
+                    ~Scope()
+                    {
+                        if (_running) { Trace::get().record(_name, _argName, _arg, _start, std::chrono::steady_clock::now()); }
+                    }
+
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+
+                private:
+                    const char* _name;
+                    const char* _argName;
+                    uint64_t _arg;
+                    bool _running;
+                    std::chrono::steady_clock::time_point _start;
+            };
+
+            static Trace& get()
+            {
+                static Trace instance;
+                return instance;
+            }
+
+            // events are timed from here, it's enabled before any thread starts decoding
+            void enable();
+
+            bool enabled() const { return _enabled; }
+
+            void record(const char* name, const char* argName, uint64_t arg,
+                        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+            // only meant to be called once the recording threads are done, returns false if the file can't be written
+            bool save(const std::filesystem::path& path) const;
+
+        private:
+            struct Event
+            {
+                const char* name;
+                const char* argName;
+                uint64_t arg;
+                uint64_t start;     // nanoseconds since the trace was enabled
+                uint64_t duration;
+            };
+
+            struct Buffer
+            {
+                std::vector<Event> events = std::vector<Event>(bufferEvents);
+                std::atomic<uint64_t> count{0};     // every event ever recorded, the newest ones are in the buffer
+                size_t thread;
+            };
+
+            Trace() = default;
+            ~Trace() = default;
+
+            Buffer& local();
+
+            bool _enabled = false;
+            std::chrono::steady_clock::time_point _origin;
+            mutable std::mutex _mutex;
+            std::vector<std::unique_ptr<Buffer>> _buffers;   // buffers of threads that ended are kept until it's saved
+    };
+}
@@ -0,0 +1,89 @@
+#include "BatchInsertWriter.h"
+#include <string_view>
+
+using namespace wal::writers;
+
+namespace {
+    constexpr std::string_view insertToken = "INSERT INTO ";
+    // a multi-row statement fails as a whole on a constraint, the rows that a single-row replay would have
+    // rejected on their own (i.e. a second version of a primary key) are ignored instead
+    constexpr std::string_view batchInsertToken = "INSERT OR IGNORE INTO ";
+    // table & column names can't have parentheses, so the first one of these ends the column list
+    constexpr std::string_view valuesToken = ") VALUES ";
+}
+
+BatchInsertWriter::BatchInsertWriter(std::ostream& out, size_t batchSize, size_t maxBytes):
+    _out(out),
+    _batchSize(batchSize),
+    _maxBytes(maxBytes)
+{}
+
+void BatchInsertWriter::write(std::string&& row)
+{
+    if (row.empty()) { return; }
+    begin();
+
+    const auto valuesPos = row.find(valuesToken);
+    if (!row.starts_with(insertToken) || !row.ends_with(");") || std::string::npos == valuesPos)
+    {
+        endStatement();
+        _out << row << '\n';
+        return;
+    }
+
+    const std::string_view view = row;
+    const auto prefix = view.substr(0, valuesPos + valuesToken.size());
+    const auto values = view.substr(prefix.size(), view.size() - prefix.size() - 1); // without the ';'
+
+    constexpr size_t separatorSize = 2; // ",\n"
+    if (_rows > 0 && (_rows >= _batchSize || prefix != _prefix || _bytes + separatorSize + values.size() + 1 > _maxBytes))
+    {
+        endStatement();
+    }
+
+    if (0 == _rows)
+    {
+        _prefix.assign(prefix);
+        _out << batchInsertToken << prefix.substr(insertToken.size());
+        _bytes = _prefix.size() + batchInsertToken.size() - insertToken.size();
+    }
+    else
+    {
+        _out << ",\n";
+        _bytes += separatorSize;
+    }
+    _out << values;
+    _bytes += values.size();
+    ++_rows;
+}
+
+void BatchInsertWriter::writeHeader(const std::string& header)
+{
+    endStatement();
+    _out << header << '\n';
+}
+
+void BatchInsertWriter::flush()
+{
+    endStatement();
+    if (_inTransaction)
+    {
+        _out << "COMMIT;\n";
+        _inTransaction = false;
+    }
+    _out.flush();
+}
+
+void BatchInsertWriter::begin()
+{
+    if (_inTransaction) { return; }
+    _out << "BEGIN;\n";
+    _inTransaction = true;
+}
+
+void BatchInsertWriter::endStatement()
+{
+    if (0 == _rows) { return; }
+    _out << ";\n";
+    _rows = 0;
+}
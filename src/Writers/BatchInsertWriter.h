@@ -0,0 +1,40 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include "OutputWriter.h"
+
+namespace wal::writers {
+
+    // merges consecutive sql INSERT rows of the same table into multi-row statements:
+    //   INSERT OR IGNORE INTO foo (a, b) VALUES (1, 2),
+    //   (3, 4);
+    // a statement is ended after batchSize rows or before it would pass maxBytes (a single row that's bigger is
+    // written on it's own). like a replay of the single-row statements, a row that violates a constraint is
+    // skipped without failing the rest of it's statement. statements are wrapped in BEGIN/COMMIT, the transaction is committed on flush.
+    // rows that aren't a plain INSERT (i.e. carved rows with their comment) and headers end the current statement
+    // and are written as is
+    class BatchInsertWriter : public OutputWriter
+    {
+        public:
+            static constexpr size_t defaultMaxBytes = 1000000; // sqlite's default SQLITE_MAX_SQL_LENGTH
+
+            BatchInsertWriter(std::ostream& out, size_t batchSize, size_t maxBytes = defaultMaxBytes);
+            ~BatchInsertWriter() = default;
+
+            void write(std::string&& row) override;
+            void writeHeader(const std::string& header) override;
+            void flush() override;
+
+        private:
+            void begin();
+            void endStatement();
+
+            std::ostream& _out;
+            size_t _batchSize;
+            size_t _maxBytes;
+            std::string _prefix;    // "INSERT INTO <table> (<columns>) VALUES " of the open statement
+            size_t _rows = 0;       // rows in the open statement
+            size_t _bytes = 0;      // size of the open statement so far
+            bool _inTransaction = false;
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "OutputWriter.h"
+
+namespace wal::writers {
+
+    // keeps rows in memory in the order they were written, used to hand a batch of rows between threads
+    class BufferWriter : public OutputWriter
+    {
+        public:
+            BufferWriter() = default;
+            ~BufferWriter() = default;
+
+            void write(std::string&& row) override { _rows.emplace_back(std::move(row)); }
+            void flush() override {}
+
+            // forward all rows to another writer and clear this buffer
+            void moveTo(OutputWriter& out)
+            {
+                for (auto& row : _rows) { out.write(std::move(row)); }
+                _rows.clear();
+            }
+
+            const std::vector<std::string>& rows() const { return _rows; }
+
+        private:
+            std::vector<std::string> _rows;
+    };
+}
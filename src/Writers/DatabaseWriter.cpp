@@ -0,0 +1,136 @@
+#include "DatabaseWriter.h"
+#include <cstring>
+#include <stdexcept>
+#include <sqlite3.h>
+#include "Formatters/DatabaseFormatter.h"
+#include "Utils/Log.h"
+
+using namespace wal::writers;
+using ValueType = wal::formatters::DatabaseFormatter::ValueType;
+
+DatabaseWriter::DatabaseWriter(const std::filesystem::path& path,
+                               const std::string& createStatement,
+                               const std::string& insertStatement,
+                               size_t rowsPerTransaction):
+    _path(path),
+    _rowsPerTransaction(rowsPerTransaction > 0 ? rowsPerTransaction : defaultRowsPerTransaction)
+{
+    if (SQLITE_OK != sqlite3_open_v2(path.c_str(), &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr))
+    {
+        fail("Failed to open database");
+    }
+    try
+    {
+        // nothing has to survive a crash while loading, the output can be loaded again
+        execute("PRAGMA journal_mode=OFF");
+        execute("PRAGMA synchronous=OFF");
+        execute(createStatement);
+    }
+    catch(...)
+    {
+        close();
+        throw;
+    }
+    if (SQLITE_OK != sqlite3_prepare_v2(_db, insertStatement.c_str(), -1, &_insert, nullptr))
+    {
+        fail("Failed to prepare \"" + insertStatement + "\"");
+    }
+}
+
+DatabaseWriter::~DatabaseWriter()
+{
+    try { flush(); }
+    catch(const std::exception& e) { wal::Log::get().err() << e.what(); }
+    close();
+}
+
+void DatabaseWriter::write(std::string&& row)
+{
+    if (row.empty()) { return; }
+
+    int column = 0;
+    bool bound = formatters::DatabaseFormatter::readRow(row, [this, &column](ValueType type, std::string_view value)
+    {
+        ++column;
+        switch (type)
+        {
+            case ValueType::Integer:
+            {
+                int64_t integer = 0;
+                std::memcpy(&integer, value.data(), sizeof(integer));
+                sqlite3_bind_int64(_insert, column, integer);
+            }
+            break;
+            case ValueType::Real:
+            {
+                double real = 0;
+                std::memcpy(&real, value.data(), sizeof(real));
+                sqlite3_bind_double(_insert, column, real);
+            }
+            break;
+            // the row outlives the step, nothing has to be copied
+            case ValueType::Text: sqlite3_bind_text(_insert, column, value.data(), static_cast<int>(value.size()), SQLITE_STATIC); break;
+            case ValueType::Blob: sqlite3_bind_blob(_insert, column, value.data(), static_cast<int>(value.size()), SQLITE_STATIC); break;
+            default: sqlite3_bind_null(_insert, column); break;
+        }
+    });
+    if (!bound || column != sqlite3_bind_parameter_count(_insert))
+    {
+        wal::Log::get().err() << "malformed row for " << _path << ", skipping";
+        sqlite3_reset(_insert);
+        return;
+    }
+
+    if (!_inTransaction)
+    {
+        execute("BEGIN");
+        _inTransaction = true;
+    }
+
+    const int rc = sqlite3_step(_insert);
+    if (SQLITE_DONE == rc) { ++_written; }
+    else if (SQLITE_CONSTRAINT == (rc & 0xff))
+    {
+        ++_rejected;
+        wal::Log::get().info() << "row rejected by " << _path << ": " << sqlite3_errmsg(_db);
+    }
+    else
+    {
+        wal::Log::get().err() << "Failed to insert a row into " << _path << ": " << sqlite3_errmsg(_db);
+    }
+    sqlite3_reset(_insert);
+
+    if (++_rowsInTransaction >= _rowsPerTransaction) { flush(); }
+}
+
+void DatabaseWriter::flush()
+{
+    if (!_inTransaction) { return; }
+    _inTransaction = false;
+    _rowsInTransaction = 0;
+    execute("COMMIT");
+}
+
+void DatabaseWriter::execute(const std::string& sql)
+{
+    char* error = nullptr;
+    if (SQLITE_OK == sqlite3_exec(_db, sql.c_str(), nullptr, nullptr, &error)) { return; }
+    std::string message = error ? error : "unknown error";
+    sqlite3_free(error);
+    throw std::runtime_error("Failed to execute \"" + sql + "\" on " + _path.string() + ": " + message);
+}
+
+void DatabaseWriter::fail(const std::string& what)
+{
+    std::string message = what + " " + _path.string() + ": " + (_db ? sqlite3_errmsg(_db) : "out of memory");
+    close();
+    throw std::runtime_error(message);
+}
+
+void DatabaseWriter::close()
+{
+    sqlite3_finalize(_insert);
+    sqlite3_close(_db);
+    _insert = nullptr;
+    _db = nullptr;
+}
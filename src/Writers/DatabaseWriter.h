@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <filesystem>
+#include "OutputWriter.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace wal::writers {
+
+    // loads the rows of a DatabaseFormatter into an sqlite database: the table is created from the schema and
+    // rows are bound to a prepared insert statement inside large transactions. journaling and syncing are off
+    // while loading, a crash in the middle leaves a database that has to be loaded again.
+    // rows are expected in frame order, the insert statement replaces the row with the same primary key so the
+    // newest version of a row is the one that's kept. rows that violate another constraint of the table
+    // (i.e. NOT NULL or CHECK) are counted and skipped
+    class DatabaseWriter : public OutputWriter
+    {
+        public:
+            static constexpr size_t defaultRowsPerTransaction = 1000000;
+
+            // throws std::runtime_error if the database can't be opened or the table can't be created
+            DatabaseWriter(const std::filesystem::path& path,
+                           const std::string& createStatement,
+                           const std::string& insertStatement,
+                           size_t rowsPerTransaction = defaultRowsPerTransaction);
+            ~DatabaseWriter();
+
+            DatabaseWriter(const DatabaseWriter&) = delete;
+            DatabaseWriter& operator=(const DatabaseWriter&) = delete;
+
+            void write(std::string&& row) override;
+
+            // comments have no place in the database
+            void writeHeader(const std::string&) override {}
+
+            // commit the open transaction
+            void flush() override;
+
+            size_t rowsWritten() const { return _written; }
+            size_t rowsRejected() const { return _rejected; }
+
+        private:
+            void execute(const std::string& sql);
+            [[noreturn]] void fail(const std::string& what);
+            void close();
+
+            sqlite3* _db = nullptr;
+            sqlite3_stmt* _insert = nullptr;
+            std::filesystem::path _path;
+            size_t _rowsPerTransaction;
+            size_t _rowsInTransaction = 0;
+            bool _inTransaction = false;
+            size_t _written = 0;
+            size_t _rejected = 0;
+    };
+}
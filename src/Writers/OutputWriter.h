@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+namespace wal::writers {
+
+    // receives every formatted row, implementations decide when and how rows reach the output
+    class OutputWriter
+    {
+        public:
+            OutputWriter() = default;
+            virtual ~OutputWriter() = default;
+
+            virtual void write(std::string&& row) = 0;
+
+            // text that has to precede all rows (i.e. csv column names), written as is without ordering or dedupe
+            virtual void writeHeader(const std::string& header) { write(std::string(header)); }
+
+            // write out anything that is still held by the writer
+            virtual void flush() = 0;
+    };
+}
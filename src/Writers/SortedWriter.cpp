@@ -0,0 +1,30 @@
+#include "SortedWriter.h"
+
+using namespace wal::writers;
+
+void SortedWriter::write(std::string&& row)
+{
+    if (!row.empty()) { _rows.emplace(std::move(row)); }
+}
+
+void SortedWriter::writeHeader(const std::string& header)
+{
+    if (nullptr != _next) { _next->writeHeader(header); }
+    else { *_out << header << std::endl; }
+}
+
+void SortedWriter::flush()
+{
+    if (nullptr != _next)
+    {
+        while (!_rows.empty()) { _next->write(std::move(_rows.extract(std::prev(_rows.end())).value())); }
+        _next->flush();
+        return;
+    }
+
+    for (auto rit = _rows.rbegin(); rit != _rows.rend(); ++rit)
+    {
+        *_out << *rit << std::endl;
+    }
+    _rows.clear();
+}
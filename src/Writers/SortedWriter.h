@@ -0,0 +1,26 @@
+#pragma once
+#include <set>
+#include <ostream>
+#include "OutputWriter.h"
+
+namespace wal::writers {
+
+    // holds all rows until flush, duplicates are dropped and rows are printed in reverse sorted order
+    class SortedWriter : public OutputWriter
+    {
+        public:
+            explicit SortedWriter(std::ostream& out):_out(&out) {}
+            // hand the rows to another writer on flush instead of writing them out, next has to outlive this writer
+            explicit SortedWriter(OutputWriter& next):_next(&next) {}
+            ~SortedWriter() = default;
+
+            void write(std::string&& row) override;
+            void writeHeader(const std::string& header) override;
+            void flush() override;
+
+        private:
+            std::ostream* _out = nullptr;
+            OutputWriter* _next = nullptr;
+            std::set<std::string> _rows;
+    };
+}
@@ -0,0 +1,57 @@
+#include "StreamWriter.h"
+#include <bit>
+#include <functional>
+
+using namespace wal::writers;
+
+StreamWriter::StreamWriter(std::ostream& out, bool dedupe, size_t dedupeSlots):
+    StreamWriter(dedupe, dedupeSlots)
+{
+    _out = &out;
+}
+
+StreamWriter::StreamWriter(OutputWriter& next, bool dedupe, size_t dedupeSlots):
+    StreamWriter(dedupe, dedupeSlots)
+{
+    _next = &next;
+}
+
+StreamWriter::StreamWriter(bool dedupe, size_t dedupeSlots)
+{
+    if (dedupe && dedupeSlots > 0)
+    {
+        _seen.resize(std::bit_ceil(dedupeSlots), 0);
+        _mask = _seen.size() - 1;
+    }
+}
+
+void StreamWriter::write(std::string&& row)
+{
+    if (row.empty() || isDuplicate(row)) { return; }
+    if (nullptr != _next) { _next->write(std::move(row)); }
+    else { *_out << row << '\n'; }
+}
+
+void StreamWriter::writeHeader(const std::string& header)
+{
+    if (nullptr != _next) { _next->writeHeader(header); }
+    else { *_out << header << '\n'; }
+}
+
+void StreamWriter::flush()
+{
+    if (nullptr != _next) { _next->flush(); }
+    else { _out->flush(); }
+}
+
+bool StreamWriter::isDuplicate(const std::string& row)
+{
+    if (_seen.empty()) { return false; }
+
+    uint64_t hash = std::hash<std::string>{}(row);
+    auto& slot = _seen[hash & _mask];
+    hash |= 1; // zero marks an empty slot
+    if (slot == hash) { return true; }
+    slot = hash;
+    return false;
+}
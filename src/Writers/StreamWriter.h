@@ -0,0 +1,36 @@
+#pragma once
+#include <ostream>
+#include <vector>
+#include <cstdint>
+#include "OutputWriter.h"
+
+namespace wal::writers {
+
+    // writes rows as soon as they are produced, so memory doesn't grow with the size of the WAL.
+    // optionally drops repeated rows using a fixed size table of row hashes, this is a best effort
+    // dedupe: a row is only remembered until another row's hash lands on the same slot
+    class StreamWriter : public OutputWriter
+    {
+        public:
+            static constexpr size_t defaultDedupeSlots = 1 << 20; // 8MB of hashes
+
+            explicit StreamWriter(std::ostream& out, bool dedupe = false, size_t dedupeSlots = defaultDedupeSlots);
+            // hand the rows to another writer instead of writing them out, next has to outlive this writer
+            explicit StreamWriter(OutputWriter& next, bool dedupe = false, size_t dedupeSlots = defaultDedupeSlots);
+            ~StreamWriter() = default;
+
+            void write(std::string&& row) override;
+            void writeHeader(const std::string& header) override;
+            void flush() override;
+
+        private:
+            StreamWriter(bool dedupe, size_t dedupeSlots);
+
+            bool isDuplicate(const std::string& row);
+
+            std::ostream* _out = nullptr;
+            OutputWriter* _next = nullptr;
+            std::vector<uint64_t> _seen;
+            size_t _mask = 0;
+    };
+}
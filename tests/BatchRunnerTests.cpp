@@ -0,0 +1,104 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "Pipeline/BatchRunner.h"
+#include "Formatters/SchemaFormatter.h"
+#include "Formatters/Input/StringInput.h"
+#include "WalBuilder.h"
+
+using wal::pipeline::BatchRunner;
+
+namespace {
+    void writeFile(const std::filesystem::path& path, std::vector<uint8_t> bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+}
+
+TEST(BatchRunnerTests, InputFiles)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "wal-parser-BatchRunnerTests";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    writeFile(directory / "b.db-wal", {0x37, 0x7f, 0x06, 0x83});
+    writeFile(directory / "a.db-wal", {0x37, 0x7f, 0x06, 0x82});
+    writeFile(directory / "a.db-wal.idx", {'W', 'A', 'L', 'I'});
+    writeFile(directory / "c1.wal", {0x37, 0x7f, 0x06, 0x82});
+    writeFile(directory / "c2.wal", {0x37, 0x7f, 0x06, 0x82});
+
+    ASSERT_TRUE(BatchRunner::isPattern("./archive/*.db-wal"), "star is a glob");
+    ASSERT_TRUE(!BatchRunner::isPattern("./archive/a.db-wal"), "plain path");
+
+    auto files = BatchRunner::inputFiles(directory.string());
+    ASSERT_EQ(files.size(), size_t(4));
+    ASSERT_EQ(files.front().filename().string(), std::string("a.db-wal"));
+
+    files = BatchRunner::inputFiles((directory / "*.db-wal*").string());
+    ASSERT_EQ(files.size(), size_t(3));
+    files = BatchRunner::inputFiles((directory / "c[!1].wal").string());
+    ASSERT_EQ(files.size(), size_t(1));
+    ASSERT_EQ(files.front().filename().string(), std::string("c2.wal"));
+    files = BatchRunner::inputFiles((directory / "?.db-wal").string());
+    ASSERT_EQ(files.size(), size_t(2));
+    ASSERT_TRUE(BatchRunner::inputFiles((directory / "*.sql").string()).empty(), "nothing matches");
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(BatchRunnerTests, RunWritesFilesInOrder)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "wal-parser-BatchRunnerTests-run";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "out");
+
+    // two WALs, a file that isn't one between them
+    const std::vector<std::filesystem::path> files = { directory / "a.db-wal", directory / "b.db-wal", directory / "c.db-wal" };
+    {
+        TestUtils::WalBuilder a(files[0]);
+        a.header(1, 2);
+        a.frame(2, 2, TestUtils::leafTablePage({ 1, 2 }, a.pageSize()));
+        writeFile(files[1], {'n', 'o', 't', ' ', 'a', ' ', 'w', 'a', 'l'});
+        TestUtils::WalBuilder c(files[2]);
+        c.header(3, 4);
+        c.frame(2, 0, TestUtils::leafTablePage({ 3 }, c.pageSize()));
+        c.frame(3, 3, TestUtils::leafTablePage({ 4 }, c.pageSize()));
+    }
+
+    wal::formatters::SchemaFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>("CREATE TABLE t (id INTEGER PRIMARY KEY, v INTEGER);"));
+    formatter.prepare();
+    BatchRunner::Options options;
+    options.stream = true;
+
+    // every file is a block that starts with it's name, in the order of the files whatever finishes first
+    const std::string expected =
+        "-- file " + files[0].string() + "\n" +
+        "INSERT INTO t (id, v) VALUES (1, 1);\nINSERT INTO t (id, v) VALUES (2, 2);\n" +
+        "-- file " + files[2].string() + "\n" +
+        "INSERT INTO t (id, v) VALUES (3, 3);\nINSERT INTO t (id, v) VALUES (4, 4);\n";
+    for (size_t threads : { size_t(1), size_t(4) })
+    {
+        std::ostringstream out;
+        ASSERT_EQ(BatchRunner(formatter, options, threads).run(files, out), size_t(1));
+        ASSERT_EQ(out.str(), expected);
+    }
+
+    // with an output directory every WAL gets it's own file and nothing goes to the stream
+    options.outputDir = directory / "out";
+    options.extension = ".sql";
+    std::ostringstream out;
+    ASSERT_EQ(BatchRunner(formatter, options, 2).run(files, out), size_t(1));
+    ASSERT_TRUE(out.str().empty(), "nothing written to the stream");
+    auto read = [](const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    };
+    ASSERT_EQ(read(options.outputDir / "a.db-wal.sql"), std::string("INSERT INTO t (id, v) VALUES (1, 1);\nINSERT INTO t (id, v) VALUES (2, 2);\n"));
+    ASSERT_EQ(read(options.outputDir / "c.db-wal.sql"), std::string("INSERT INTO t (id, v) VALUES (3, 3);\nINSERT INTO t (id, v) VALUES (4, 4);\n"));
+
+    std::filesystem::remove_all(directory);
+}
@@ -35,3 +35,29 @@ TEST(BigEndianConvert,TestFloat64Convertion)
 
     ASSERT_TRUE(wal::converters::Endian::fromBig(beValue) == leValue, "failed to convert from big endian");
 }
+
+TEST(BigEndianConvert,TestLoadBigOddSizes)
+{
+    const uint8_t data[] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
+
+    ASSERT_EQ(wal::converters::Endian::loadBig<uint16_t>(data), uint16_t(0x0102));
+    ASSERT_EQ((wal::converters::Endian::loadBig<uint32_t, 3>(data)), uint32_t(0x010203));
+    ASSERT_EQ(wal::converters::Endian::loadBig<uint32_t>(data), uint32_t(0x01020304));
+    ASSERT_EQ((wal::converters::Endian::loadBig<uint64_t, 6>(data)), uint64_t(0x010203040506));
+    ASSERT_EQ(wal::converters::Endian::loadBig<uint64_t>(data), uint64_t(0x0102030405060708));
+}
+
+TEST(BigEndianConvert,TestLoadBigUnaligned)
+{
+    const uint8_t data[] = {0xff,0x00,0x00,0x00,0x05,0xff};
+
+    // starting at an odd address
+    ASSERT_EQ(wal::converters::Endian::loadBig<uint32_t>(data + 1), uint32_t(5));
+}
+
+TEST(BigEndianConvert,TestLoadBigFloat64)
+{
+    const uint8_t data[] = {0x40,0x09,0x21,0xfb,0x54,0x44,0x2d,0x18}; // pi
+
+    ASSERT_EQ(wal::converters::Endian::loadBigFloat64(data), 3.141592653589793);
+}
@@ -0,0 +1,103 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <sqlite3.h>
+#include "Formatters/DatabaseFormatter.h"
+#include "Formatters/Input/StringInput.h"
+#include "Writers/DatabaseWriter.h"
+
+using namespace wal::types;
+
+TEST(DatabaseWriterTests, LoadsFormattedRows)
+{
+    constexpr auto sql = "CREATE TABLE foo (id INTEGER PRIMARY KEY, name TEXT, val INTEGER, f REAL);";
+    wal::formatters::DatabaseFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>(sql));
+    formatter.prepare();
+    ASSERT_EQ(formatter.insertStatement(), std::string("INSERT OR REPLACE INTO foo (id, name, val, f) VALUES (?, ?, ?, ?)"));
+
+    wal::readers::RecordHeaderReader::RecordData row = {
+       {
+        {RecordSerialTypes::Null, {}},
+        {RecordSerialTypes::String, {0x61,0x00,0x62}},
+        {RecordSerialTypes::TwoBytesIntBE, {0xff,0xfe}},
+        {RecordSerialTypes::FloatBE, {0x40,0x09,0x21,0xf9,0xf0,0x1b,0x86,0x6e}}
+       },
+       42 //rowid
+    };
+
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-DatabaseWriterTests.db";
+    std::filesystem::remove(path);
+    {
+        wal::writers::DatabaseWriter writer(path, formatter.createStatement(), formatter.insertStatement());
+        writer.write(formatter.generateOutput(row));
+        // a carved row is preceded by it's (empty) comment
+        row.rowid = 43;
+        writer.write(formatter.comment("carved") + "\n" + formatter.generateOutput(row));
+        // the same primary key again replaces it
+        writer.write(formatter.generateOutput(row));
+        writer.flush();
+        ASSERT_EQ(writer.rowsWritten(), size_t(3));
+        ASSERT_EQ(writer.rowsRejected(), size_t(0));
+    }
+
+    sqlite3* db = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_TRUE(SQLITE_OK == sqlite3_open(path.c_str(), &db), "failed to open the database");
+    sqlite3_prepare_v2(db, "SELECT id, name, val, f FROM foo ORDER BY id", -1, &stmt, nullptr);
+    ASSERT_TRUE(SQLITE_ROW == sqlite3_step(stmt), "missing row");
+    ASSERT_EQ(sqlite3_column_int64(stmt, 0), 42);
+    ASSERT_EQ(sqlite3_column_bytes(stmt, 1), 3); // text is bound as is, with it's 0 byte
+    ASSERT_EQ(sqlite3_column_int64(stmt, 2), -2);
+    ASSERT_TRUE(sqlite3_column_double(stmt, 3) > 3.14 && sqlite3_column_double(stmt, 3) < 3.15, "real column");
+    ASSERT_TRUE(SQLITE_ROW == sqlite3_step(stmt), "missing carved row");
+    ASSERT_EQ(sqlite3_column_int64(stmt, 0), 43);
+    ASSERT_TRUE(SQLITE_DONE == sqlite3_step(stmt), "too many rows");
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    std::filesystem::remove(path);
+}
+
+TEST(DatabaseWriterTests, KeepsNewestVersionOfRow)
+{
+    constexpr auto sql = "CREATE TABLE foo (id INTEGER PRIMARY KEY, name TEXT NOT NULL);";
+    wal::formatters::DatabaseFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>(sql));
+    formatter.prepare();
+
+    auto version = [&formatter](std::vector<uint8_t> name, uint64_t rowid)
+    {
+        wal::readers::RecordHeaderReader::RecordData row = {
+           {
+            {RecordSerialTypes::Null, {}},
+            {name.empty() ? RecordSerialTypes::Null : RecordSerialTypes::String, name}
+           },
+           rowid
+        };
+        return formatter.generateOutput(row);
+    };
+
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-DatabaseWriterTests-update.db";
+    std::filesystem::remove(path);
+    {
+        wal::writers::DatabaseWriter writer(path, formatter.createStatement(), formatter.insertStatement());
+        // in frame order: the insert, the update that follows it and a row that breaks NOT NULL
+        writer.write(version({'i','n','s'}, 7));
+        writer.write(version({'u','p','d'}, 7));
+        writer.write(version({}, 8));
+        writer.flush();
+        ASSERT_EQ(writer.rowsWritten(), size_t(2));
+        ASSERT_EQ(writer.rowsRejected(), size_t(1));
+    }
+
+    sqlite3* db = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_TRUE(SQLITE_OK == sqlite3_open(path.c_str(), &db), "failed to open the database");
+    sqlite3_prepare_v2(db, "SELECT id, name FROM foo", -1, &stmt, nullptr);
+    ASSERT_TRUE(SQLITE_ROW == sqlite3_step(stmt), "missing row");
+    ASSERT_EQ(sqlite3_column_int64(stmt, 0), 7);
+    ASSERT_TRUE(std::string_view(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))) == "upd", "newest version is kept");
+    ASSERT_TRUE(SQLITE_DONE == sqlite3_step(stmt), "too many rows");
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    std::filesystem::remove(path);
+}
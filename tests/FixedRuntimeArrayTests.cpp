@@ -1,5 +1,7 @@
 #include "TestBase.h"
 #include "Utils/FixedRuntimeArray.h"
+#include <array>
+#include <algorithm>
 
 TEST(FixedRuntimeArray, sanityTest1)
 {
@@ -0,0 +1,144 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <limits>
+#include "Utils/MappedFile.h"
+#include "Utils/Stats.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/FrameIndex.h"
+#include "Formatters/SchemaFormatter.h"
+#include "Formatters/Input/StringInput.h"
+#include "Pipeline/FrameDecoder.h"
+#include "Writers/OutputWriter.h"
+#include "WalBuilder.h"
+
+using wal::Stats;
+using wal::pipeline::FrameDecoder;
+
+namespace {
+    class RowCollector : public wal::writers::OutputWriter
+    {
+        public:
+            void write(std::string&& row) override { rows.push_back(std::move(row)); }
+            void flush() override {}
+
+            std::vector<std::string> rows;
+    };
+
+    std::string row(int64_t rowid)
+    {
+        return "INSERT INTO t (id, v) VALUES (" + std::to_string(rowid) + ", " + std::to_string(rowid & 0x7f) + ");";
+    }
+}
+
+TEST(FrameDecoderTests, SkipsPagesOutsideRowidRange)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FrameDecoderTests.db-wal";
+    std::filesystem::remove(path);
+
+    // rowids of 1 to 3 bytes, the page bounds are 1-3, 127-20000 and none for the page without cells
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0, TestUtils::leafTablePage({ 1, 2, 3 }, builder.pageSize()));
+    builder.frame(3, 0, TestUtils::leafTablePage({ 127, 128, 300, 20000 }, builder.pageSize()));
+    builder.frame(4, 4, TestUtils::leafTablePage({}, builder.pageSize()));
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+
+    wal::formatters::SchemaFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>("CREATE TABLE t (id INTEGER PRIMARY KEY, v INTEGER);"));
+    formatter.prepare();
+
+    auto& stats = Stats::get();
+    stats.enable();
+    // rows of every frame and the number of pages skipped as a whole
+    auto decode = [&](int64_t minRowid, int64_t maxRowid, std::vector<std::string>& rows)
+    {
+        FrameDecoder::Options options;
+        options.minRowid = minRowid;
+        options.maxRowid = maxRowid;
+        FrameDecoder decoder(walReader, formatter, options);
+        RowCollector out;
+        const auto skipped = stats.total(Stats::Counter::FramesRowidRange);
+        for (size_t frame = 0; frame < walReader.frameCount(); ++frame) { decoder.decode(frame, out); }
+        rows = std::move(out.rows);
+        return stats.total(Stats::Counter::FramesRowidRange) - skipped;
+    };
+
+    std::vector<std::string> rows;
+    // a point match, the first page ends before it
+    ASSERT_EQ(decode(128, 128, rows), uint64_t(1));
+    ASSERT_TRUE(rows == std::vector<std::string>({ row(128) }), "single row");
+
+    // the range starts at the last rowid of the first page and ends at the first rowid of the second
+    ASSERT_EQ(decode(3, 127, rows), uint64_t(0));
+    ASSERT_TRUE(rows == std::vector<std::string>({ row(3), row(127) }), "bounds are inclusive");
+
+    // between the pages, both are skipped without reading their cells
+    ASSERT_EQ(decode(4, 126, rows), uint64_t(2));
+    ASSERT_TRUE(rows.empty(), "no rows between the pages");
+
+    // multi byte rowids inside a page
+    ASSERT_EQ(decode(129, 20000, rows), uint64_t(1));
+    ASSERT_TRUE(rows == std::vector<std::string>({ row(300), row(20000) }), "2 & 3 bytes rowids");
+    ASSERT_EQ(decode(20001, std::numeric_limits<int64_t>::max(), rows), uint64_t(2));
+    ASSERT_TRUE(rows.empty(), "after every rowid");
+
+    // without a range every row is decoded
+    ASSERT_EQ(decode(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), rows), uint64_t(0));
+    ASSERT_EQ(rows.size(), size_t(7));
+
+    std::filesystem::remove(path);
+}
+
+TEST(FrameDecoderTests, NegativeRowids)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FrameDecoderTests-negative.db-wal";
+    std::filesystem::remove(path);
+
+    // rowids are signed, a page's cells are sorted with the negative ones first. their varints take 9 bytes
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0, TestUtils::leafTablePage({ -300, -1, 5, 7 }, builder.pageSize()));
+    builder.frame(3, 3, TestUtils::leafTablePage({ 8, 9 }, builder.pageSize()));
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+
+    wal::formatters::SchemaFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>("CREATE TABLE t (id INTEGER PRIMARY KEY, v INTEGER);"));
+    formatter.prepare();
+
+    auto decode = [&](int64_t minRowid, int64_t maxRowid)
+    {
+        FrameDecoder::Options options;
+        options.minRowid = minRowid;
+        options.maxRowid = maxRowid;
+        FrameDecoder decoder(walReader, formatter, options);
+        RowCollector out;
+        for (size_t frame = 0; frame < walReader.frameCount(); ++frame) { decoder.decode(frame, out); }
+        return out.rows;
+    };
+
+    // the page that starts with a negative rowid isn't skipped
+    ASSERT_TRUE(decode(5, 5) == std::vector<std::string>({ row(5) }), "positive rowid after negative ones");
+    ASSERT_TRUE(decode(-1, -1) == std::vector<std::string>({ row(-1) }), "negative rowid");
+    ASSERT_TRUE(decode(-300, 5) == std::vector<std::string>({ row(-300), row(-1), row(5) }), "range across 0");
+    ASSERT_TRUE(decode(std::numeric_limits<int64_t>::min(), -2) == std::vector<std::string>({ row(-300) }), "before 0");
+    ASSERT_TRUE(decode(-299, -2).empty(), "between rowids of a page");
+    ASSERT_EQ(decode(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()).size(), size_t(6));
+
+    // the index bounds the pages the same way
+    wal::readers::FrameIndex index;
+    index.build(walReader);
+    ASSERT_EQ(index.entry(0).minRowid, int64_t(-300));
+    ASSERT_EQ(index.entry(0).maxRowid, int64_t(7));
+    ASSERT_TRUE(index.rowidFrames({ 0, 1 }, 5, 5) == std::vector<size_t>({ 0 }), "index keeps the page with negative rowids");
+    ASSERT_TRUE(index.rowidFrames({ 0, 1 }, -1000, -301).empty(), "index skips pages outside the range");
+
+    std::filesystem::remove(path);
+}
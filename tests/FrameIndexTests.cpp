@@ -0,0 +1,170 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/FrameIndex.h"
+#include "WalBuilder.h"
+
+using wal::readers::FrameIndex;
+using wal::types::BTreeNodePageType;
+
+namespace {
+    // leaf table pages (one with 2 bytes rowids, one without cells), an interior & an index page and a frame
+    // with stale salts. the checksum chain breaks at the stale frame, the first 4 frames are valid
+    void buildWal(TestUtils::WalBuilder& builder)
+    {
+        const auto pageSize = builder.pageSize();
+        builder.header(11, 12);
+        builder.frame(2, 0, TestUtils::leafTablePage({ 5, 9 }, pageSize));
+        builder.frame(3, 0, TestUtils::emptyPage(0x05, pageSize));
+        builder.frame(4, 0, TestUtils::emptyPage(0x0a, pageSize));
+        builder.frame(5, 5, TestUtils::leafTablePage({ 200, 300 }, pageSize));
+        builder.staleFrame(6, 0, TestUtils::leafTablePage({ 7 }, pageSize));
+        builder.frame(7, 7, TestUtils::leafTablePage({}, pageSize));
+    }
+
+    // change a field of a saved index's header in place, the header is in host byte order
+    template<typename T>
+    void patchIndex(const std::filesystem::path& path, size_t offset, T value)
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    constexpr size_t pageSizeOffset = 12;
+    constexpr size_t frameCountOffset = 32;
+
+    const std::vector<size_t> allFrames = { 0, 1, 2, 3, 4, 5 };
+}
+
+TEST(FrameIndexTests, SaveAndLoad)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FrameIndexTests.db-wal";
+    const auto indexPath = path.string() + ".idx";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    buildWal(builder);
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+
+    FrameIndex built;
+    built.build(walReader);
+    ASSERT_EQ(built.frameCount(), size_t(6));
+    ASSERT_EQ(built.validFrameCount(), size_t(4));
+    ASSERT_TRUE(built.save(indexPath), "save the index");
+
+    FrameIndex loaded;
+    ASSERT_TRUE(loaded.load(indexPath, walReader), "index of the same WAL is loaded");
+    ASSERT_EQ(loaded.frameCount(), built.frameCount());
+    ASSERT_EQ(loaded.validFrameCount(), built.validFrameCount());
+    for (size_t i = 0; i < loaded.frameCount(); ++i)
+    {
+        ASSERT_TRUE(std::memcmp(&loaded.entry(i), &built.entry(i), sizeof(FrameIndex::Entry)) == 0, "same entry after loading");
+    }
+
+    const auto& entry = loaded.entry(3);
+    ASSERT_EQ(entry.offset, uint64_t(walReader.frameOffset(3)));
+    ASSERT_EQ(entry.pageNumber, uint32_t(5));
+    ASSERT_EQ(entry.commitSize, uint32_t(5));
+    ASSERT_TRUE(BTreeNodePageType::leafTable == entry.pageType, "leaf table page");
+    ASSERT_EQ(entry.cellCount, uint16_t(2));
+    ASSERT_EQ(entry.flags, uint8_t(FrameIndex::SaltValid | FrameIndex::HasRowids));
+    ASSERT_EQ(entry.minRowid, int64_t(200));
+    ASSERT_EQ(entry.maxRowid, int64_t(300));
+    ASSERT_EQ(loaded.entry(4).flags, uint8_t(FrameIndex::HasRowids));
+    ASSERT_EQ(loaded.entry(5).flags, uint8_t(FrameIndex::SaltValid));
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(indexPath);
+}
+
+TEST(FrameIndexTests, LoadRejectsChangedWal)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FrameIndexTests-changed.db-wal";
+    const auto indexPath = path.string() + ".idx";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    buildWal(builder);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        ASSERT_TRUE(walReader.readHeader(), "WAL header");
+        FrameIndex index;
+        index.build(walReader);
+        ASSERT_TRUE(index.save(indexPath), "save the index");
+
+        // fields of the header that can't be changed in the WAL alone
+        const auto saved = std::filesystem::path(indexPath + ".saved");
+        std::filesystem::copy_file(indexPath, saved, std::filesystem::copy_options::overwrite_existing);
+        patchIndex<uint32_t>(indexPath, pageSizeOffset, 1024);
+        ASSERT_TRUE(!index.load(indexPath, walReader), "other page size");
+        std::filesystem::copy_file(saved, indexPath, std::filesystem::copy_options::overwrite_existing);
+        patchIndex<uint64_t>(indexPath, frameCountOffset, 7);
+        ASSERT_TRUE(!index.load(indexPath, walReader), "other frame count");
+        std::filesystem::copy_file(saved, indexPath, std::filesystem::copy_options::overwrite_existing);
+        ASSERT_TRUE(index.load(indexPath, walReader), "restored index");
+        std::filesystem::remove(saved);
+    }
+
+    // a checkpoint started the WAL over, the frames are still there
+    builder.header(21, 12);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        ASSERT_TRUE(walReader.readHeader(), "WAL header");
+        FrameIndex index;
+        ASSERT_TRUE(!index.load(indexPath, walReader), "other salts");
+    }
+
+    // the salts are back, a partial frame was written
+    builder.header(11, 12);
+    std::ofstream(path, std::ios::binary | std::ios::app).write("partial", 7);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        ASSERT_TRUE(walReader.readHeader(), "WAL header");
+        ASSERT_EQ(walReader.frameCount(), size_t(6));
+        FrameIndex index;
+        ASSERT_TRUE(!index.load(indexPath, walReader), "other file size");
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(indexPath);
+}
+
+TEST(FrameIndexTests, FiltersFrames)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FrameIndexTests-filter.db-wal";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    buildWal(builder);
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    FrameIndex index;
+    index.build(walReader);
+
+    ASSERT_TRUE(index.leafFrames(allFrames, false, false) == std::vector<size_t>({ 0, 3, 4, 5 }), "leaf table frames");
+    ASSERT_TRUE(index.leafFrames(allFrames, false, true) == std::vector<size_t>({ 0, 3, 5 }), "without stale salts");
+    ASSERT_TRUE(index.leafFrames(allFrames, true, false) == std::vector<size_t>({ 2 }), "leaf index frames");
+    ASSERT_TRUE(index.leafFrames({ 4, 0 }, false, false) == std::vector<size_t>({ 4, 0 }), "order is kept");
+
+    // pages that aren't leaf tables are kept, leaf tables without cells never match
+    constexpr auto minRowid = std::numeric_limits<int64_t>::min();
+    constexpr auto maxRowid = std::numeric_limits<int64_t>::max();
+    ASSERT_TRUE(index.rowidFrames(allFrames, 100, 250) == std::vector<size_t>({ 1, 2, 3 }), "range inside a page");
+    ASSERT_TRUE(index.rowidFrames(allFrames, 9, 9) == std::vector<size_t>({ 0, 1, 2 }), "max rowid is inclusive");
+    ASSERT_TRUE(index.rowidFrames(allFrames, 0, 5) == std::vector<size_t>({ 0, 1, 2 }), "min rowid is inclusive");
+    ASSERT_TRUE(index.rowidFrames(allFrames, 301, maxRowid) == std::vector<size_t>({ 1, 2 }), "after every rowid");
+    ASSERT_TRUE(index.rowidFrames(allFrames, minRowid, maxRowid) == std::vector<size_t>({ 0, 1, 2, 3, 4 }), "every rowid");
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,116 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Formatters/SchemaFormatter.h"
+#include "Formatters/Input/StringInput.h"
+#include "Pipeline/FrameDecoder.h"
+#include "Pipeline/FramePipeline.h"
+#include "Writers/BufferWriter.h"
+#include "WalBuilder.h"
+
+using wal::pipeline::FrameDecoder;
+using wal::pipeline::FramePipeline;
+
+namespace {
+    // chunks of frames for more tasks than the pipeline lets wait for the writer
+    constexpr size_t frameCount = FramePipeline::framesPerTask * 20 + 7;
+
+    // two rows per frame, rowids go up with the frame
+    void buildWal(const std::filesystem::path& path)
+    {
+        TestUtils::WalBuilder builder(path);
+        builder.header(1, 2);
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            const auto rowid = static_cast<int64_t>(frame * 2 + 1);
+            builder.frame(static_cast<uint32_t>(2 + frame % 100), frame + 1 == frameCount ? 101 : 0,
+                          TestUtils::leafTablePage({ rowid, rowid + 1 }, builder.pageSize()));
+        }
+    }
+
+    // fails on the row with the given rowid the way a bug in a formatter would, not with a FormatterException
+    class FailingFormatter : public wal::formatters::SchemaFormatter
+    {
+        public:
+            explicit FailingFormatter(int64_t failAt): _failAt(failAt) {}
+
+            using SchemaFormatter::generateOutput;
+            void generateOutput(const wal::readers::RecordHeaderReader::RecordData& record, std::string& out) override
+            {
+                if (record.rowid == _failAt) { throw std::runtime_error("formatter failed"); }
+                SchemaFormatter::generateOutput(record, out);
+            }
+
+        private:
+            int64_t _failAt;
+    };
+
+    std::vector<std::string> decodeAll(const wal::readers::WalFrameReader& walReader, wal::formatters::Formatter& formatter, size_t threads)
+    {
+        FrameDecoder decoder(walReader, formatter, FrameDecoder::Options{});
+        std::vector<size_t> frames(walReader.frameCount());
+        std::iota(frames.begin(), frames.end(), 0);
+        wal::writers::BufferWriter out;
+        FramePipeline(decoder, threads).run(frames, out);
+        return out.rows();
+    }
+}
+
+TEST(FramePipelineTests, ThreadsKeepFrameOrder)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FramePipelineTests.db-wal";
+    std::filesystem::remove(path);
+    buildWal(path);
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    ASSERT_EQ(walReader.frameCount(), frameCount);
+
+    wal::formatters::SchemaFormatter formatter;
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>("CREATE TABLE t (id INTEGER PRIMARY KEY, v INTEGER);"));
+    formatter.prepare();
+
+    const auto single = decodeAll(walReader, formatter, 1);
+    ASSERT_EQ(single.size(), frameCount * 2);
+    for (size_t i = 0; i < single.size(); ++i)
+    {
+        const auto rowid = i + 1;
+        ASSERT_TRUE(single[i] == "INSERT INTO t (id, v) VALUES (" + std::to_string(rowid) + ", " + std::to_string(rowid & 0x7f) + ");",
+                    "rows in frame order");
+    }
+    ASSERT_TRUE(decodeAll(walReader, formatter, 4) == single, "same rows in the same order on 4 threads");
+
+    std::filesystem::remove(path);
+}
+
+TEST(FramePipelineTests, WorkerExceptionReachesCaller)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-FramePipelineTests-failing.db-wal";
+    std::filesystem::remove(path);
+    buildWal(path);
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+
+    // a row in the middle of the WAL, chunks after it are still queued when it fails
+    FailingFormatter formatter(static_cast<int64_t>(frameCount));
+    formatter.setInput(std::make_unique<wal::formatters::inputs::StringInput>("CREATE TABLE t (id INTEGER PRIMARY KEY, v INTEGER);"));
+    formatter.prepare();
+
+    for (size_t threads : { size_t(1), size_t(4) })
+    {
+        bool thrown = false;
+        try { decodeAll(walReader, formatter, threads); }
+        catch(const std::runtime_error& e) { thrown = std::string(e.what()) == "formatter failed"; }
+        ASSERT_TRUE(thrown, "the worker's exception is rethrown by run");
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,180 @@
+#include "TestBase.h"
+#include "Readers/FreeSpaceCarver.h"
+#include "Readers/RecordHeaderReader.h"
+#include <vector>
+#include <cstring>
+
+using wal::readers::FreeSpaceCarver;
+
+namespace {
+    constexpr size_t pageSize = 512;
+
+    void put(std::vector<uint8_t>& page, size_t offset, std::vector<uint8_t> bytes)
+    {
+        std::memcpy(page.data() + offset, bytes.data(), bytes.size());
+    }
+}
+
+TEST(FreeSpaceCarverTests, CarveUnallocatedAndFreeBlocks)
+{
+    std::vector<uint8_t> data(pageSize, 0);
+    // leaf table, first freeblock at 440, 1 cell, content starts at 400
+    put(data, 0, { 0x0d, 0x01, 0xb8, 0x00, 0x01, 0x01, 0x90, 0x00 });
+    put(data, 8, { 0x01, 0xe0 }); // the live cell at 480
+    put(data, 480, { 0x09, 0x01, 0x03, 0x01, 0x17, 0x2a, 'h', 'e', 'l', 'l', 'o' });
+    // a deleted cell in the unallocated space, still complete
+    put(data, 300, { 0x09, 0x07, 0x03, 0x01, 0x17, 0x2b, 'w', 'o', 'r', 'l', 'd' });
+    // a freeblock of 30 bytes, it's header overwrote the cell prefix of the record in it
+    put(data, 440, { 0x00, 0x00, 0x00, 0x1e, 0x03, 0x01, 0x17, 0x2c, 'a', 'b', 'c', 'd', 'e' });
+
+    wal::FixedRuntimeArray<uint8_t> page(data);
+    auto it = page.begin();
+    wal::readers::BTreeReader btree;
+    btree.readHeader(it);
+    btree.readPointerArray(it);
+
+    std::vector<FreeSpaceCarver::Candidate> found;
+    FreeSpaceCarver carver(wal::types::BTreeNodePageType::leafTable);
+    carver.carve(data.data(), data.size(), 0, btree, found);
+
+    ASSERT_EQ(found.size(), size_t(2));
+    ASSERT_TRUE(found[0].region == FreeSpaceCarver::Region::Unallocated, "first record is in the unallocated space");
+    ASSERT_TRUE(found[0].confidence == FreeSpaceCarver::Confidence::High, "complete cell has high confidence");
+    ASSERT_EQ(found[0].cellOffset, size_t(300));
+    ASSERT_EQ(found[0].recordOffset, size_t(302));
+    ASSERT_EQ(found[0].rowid, int64_t(7));
+    ASSERT_TRUE(found[1].region == FreeSpaceCarver::Region::FreeBlock, "second record is in the freeblock");
+    ASSERT_TRUE(found[1].confidence == FreeSpaceCarver::Confidence::Medium, "record without cell prefix has medium confidence");
+    ASSERT_EQ(found[1].recordOffset, size_t(444));
+    ASSERT_EQ(found[1].payloadSize, uint64_t(9));
+
+    wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable);
+    auto recordIt = page.begin() + found[0].recordOffset;
+    reader.readPayload(recordIt, found[0].payloadSize, found[0].rowid);
+    const auto& record = reader.headerData();
+    ASSERT_EQ(record.rowid, int64_t(7));
+    ASSERT_EQ(record.headerData.size(), size_t(2));
+    ASSERT_EQ(record.headerData[0].asUInt32(), uint32_t(0x2b));
+    ASSERT_TRUE(record.headerData[1].asStringView() == "world", "carved text column");
+}
+
+TEST(FreeSpaceCarverTests, MatchRecordRejectsImplausibleHeaders)
+{
+    const std::vector<uint8_t> reserved = { 0x03, 0x0a, 0x01, 0x00 }; // serial type 10 is reserved
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(reserved.data(), reserved.size(), 1), size_t(0));
+
+    const std::vector<uint8_t> tooLong = { 0x03, 0x01, 0x1b, 0x00, 'a' }; // text of 7 bytes past the end
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(tooLong.data(), tooLong.size(), 1), size_t(0));
+
+    const std::vector<uint8_t> single = { 0x02, 0x01, 0x05 };
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(single.data(), single.size(), 1), size_t(3));
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(single.data(), single.size(), FreeSpaceCarver::minMediumConfidenceColumns), size_t(0));
+
+    const std::vector<uint8_t> nulls = { 0x04, 0x00, 0x00, 0x00 }; // every column is empty
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(nulls.data(), nulls.size(), 1), size_t(0));
+
+    const std::vector<uint8_t> twoColumns = { 0x03, 0x00, 0x01, 0x05 };
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(twoColumns.data(), twoColumns.size(), 1, 2), size_t(4));
+    ASSERT_EQ(FreeSpaceCarver::matchRecord(twoColumns.data(), twoColumns.size(), 1, 1), size_t(0));
+}
+
+TEST(FreeSpaceCarverTests, RebuildOverwrittenHeader)
+{
+    std::vector<uint8_t> data(pageSize, 0);
+    // leaf table without cells, content starts at 500
+    put(data, 0, { 0x0d, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf4, 0x00 });
+    // a freed cell of 12 bytes: payload size 10, rowid 5, header (4, null, int, text of 5) and the 6 data bytes.
+    // it's first 4 bytes are a freeblock header now
+    put(data, 488, { 0x00, 0x00, 0x00, 0x0c, 0x01, 0x17, 0x2d, 'x', 'y', 'z', 'z', 'y' });
+
+    wal::FixedRuntimeArray<uint8_t> page(data);
+    auto it = page.begin();
+    wal::readers::BTreeReader btree;
+    btree.readHeader(it);
+
+    std::vector<FreeSpaceCarver::Candidate> found;
+    FreeSpaceCarver carver(wal::types::BTreeNodePageType::leafTable, 3);
+    carver.carve(data.data(), data.size(), 0, btree, found);
+
+    ASSERT_EQ(found.size(), size_t(1));
+    ASSERT_TRUE(found[0].confidence == FreeSpaceCarver::Confidence::Low, "rebuilt header has low confidence");
+    ASSERT_EQ(found[0].cellOffset, size_t(488));
+    ASSERT_EQ(found[0].recordOffset, size_t(492));
+    ASSERT_EQ(found[0].payloadSize, uint64_t(10));
+    ASSERT_EQ(found[0].rebuiltHeaderSize, size_t(2));
+    ASSERT_EQ(found[0].rebuiltHeader[0], uint8_t(4));
+    ASSERT_EQ(found[0].rebuiltHeader[1], uint8_t(0));
+}
+
+TEST(FreeSpaceCarverTests, RebuildHeaderOfTwoBytesRowid)
+{
+    std::vector<uint8_t> data(pageSize, 0);
+    // leaf table without cells, content starts at 500
+    put(data, 0, { 0x0d, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf4, 0x00 });
+    // a freed cell of 13 bytes: payload size 10, rowid 300 (2 bytes), header (4, null, int, text of 5) and the
+    // 6 data bytes. the freeblock header overwrote the whole prefix and the header size, the serial types are intact
+    put(data, 487, { 0x00, 0x00, 0x00, 0x0d, 0x00, 0x01, 0x17, 0x2d, 'x', 'y', 'z', 'z', 'y' });
+
+    wal::FixedRuntimeArray<uint8_t> page(data);
+    auto it = page.begin();
+    wal::readers::BTreeReader btree;
+    btree.readHeader(it);
+
+    // the bytes fit a 2 bytes prefix with 3 or 4 columns too, the table's column count decides
+    for (size_t columns : { size_t(3), size_t(0) })
+    {
+        std::vector<FreeSpaceCarver::Candidate> found;
+        FreeSpaceCarver carver(wal::types::BTreeNodePageType::leafTable, columns);
+        carver.carve(data.data(), data.size(), 0, btree, found);
+
+        ASSERT_EQ(found.size(), size_t(1));
+        ASSERT_TRUE(found[0].confidence == FreeSpaceCarver::Confidence::Low, "rebuilt header has low confidence");
+        ASSERT_EQ(found[0].payloadSize, uint64_t(10));
+        ASSERT_EQ(found[0].rebuiltHeaderSize, size_t(1));
+        ASSERT_EQ(found[0].rebuiltHeader[0], uint8_t(4));
+
+        std::vector<uint8_t> record(found[0].rebuiltHeader.begin(), found[0].rebuiltHeader.begin() + found[0].rebuiltHeaderSize);
+        record.insert(record.end(), data.begin() + found[0].recordOffset, data.begin() + found[0].recordOffset + 9);
+        wal::FixedRuntimeArray<uint8_t> rebuilt(record);
+        auto recordIt = rebuilt.begin();
+        wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable);
+        reader.readPayload(recordIt, found[0].payloadSize, std::nullopt);
+        const auto& carved = reader.headerData();
+        ASSERT_TRUE(!carved.rowidKnown, "rowid of a rebuilt record is unknown");
+        ASSERT_EQ(carved.headerData.size(), size_t(3));
+        ASSERT_TRUE(carved.headerData[0].getType() == wal::types::RecordSerialTypes::Null, "rowid alias column");
+        ASSERT_EQ(carved.headerData[1].asUInt32(), uint32_t(0x2d));
+        ASSERT_TRUE(carved.headerData[2].asStringView() == "xyzzy", "text column");
+    }
+}
+
+TEST(FreeSpaceCarverTests, IgnoresStrayBytesAndWideRecords)
+{
+    std::vector<uint8_t> data(pageSize, 0);
+    // leaf table without cells, content starts at 400
+    put(data, 0, { 0x0d, 0x00, 0x00, 0x00, 0x00, 0x01, 0x90, 0x00 });
+    // a byte left from an old cell pointer followed by zeroed space, it reads as a header of 37 nulls
+    put(data, 300, { 0x26 });
+    // a complete deleted cell of 3 columns: payload size 6, rowid 9, header (4, null, int, int) and 2 data bytes
+    put(data, 350, { 0x06, 0x09, 0x04, 0x00, 0x01, 0x01, 0x2a, 0x2b });
+
+    wal::FixedRuntimeArray<uint8_t> page(data);
+    auto it = page.begin();
+    wal::readers::BTreeReader btree;
+    btree.readHeader(it);
+
+    // without the table's column count only the deleted cell is found
+    std::vector<FreeSpaceCarver::Candidate> found;
+    FreeSpaceCarver(wal::types::BTreeNodePageType::leafTable).carve(data.data(), data.size(), 0, btree, found);
+    ASSERT_EQ(found.size(), size_t(1));
+    ASSERT_EQ(found[0].cellOffset, size_t(350));
+    ASSERT_TRUE(found[0].confidence == FreeSpaceCarver::Confidence::High, "complete cell has high confidence");
+
+    // a table of 3 columns still has it, one of 2 columns can't
+    found.clear();
+    FreeSpaceCarver(wal::types::BTreeNodePageType::leafTable, 3).carve(data.data(), data.size(), 0, btree, found);
+    ASSERT_EQ(found.size(), size_t(1));
+    found.clear();
+    FreeSpaceCarver(wal::types::BTreeNodePageType::leafTable, 2).carve(data.data(), data.size(), 0, btree, found);
+    ASSERT_TRUE(found.empty(), "records with more columns than the table");
+}
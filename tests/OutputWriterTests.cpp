@@ -0,0 +1,91 @@
+#include "TestBase.h"
+#include <sstream>
+#include "Writers/SortedWriter.h"
+#include "Writers/StreamWriter.h"
+#include "Writers/BatchInsertWriter.h"
+
+TEST(OutputWriterTests, SortedWriterDedupesAndReverseSorts)
+{
+    std::stringstream out;
+    wal::writers::SortedWriter writer(out);
+    writer.write("b");
+    writer.write("a");
+    writer.write("c");
+    writer.write("a");
+    ASSERT_EQ(out.str(), std::string(""));
+    writer.flush();
+    ASSERT_EQ(out.str(), std::string("c\nb\na\n"));
+}
+
+TEST(OutputWriterTests, StreamWriterKeepsFrameOrder)
+{
+    std::stringstream out;
+    wal::writers::StreamWriter writer(out);
+    writer.write("b");
+    writer.write("a");
+    writer.write("b");
+    ASSERT_EQ(out.str(), std::string("b\na\nb\n"));
+}
+
+TEST(OutputWriterTests, StreamWriterDedupe)
+{
+    std::stringstream out;
+    wal::writers::StreamWriter writer(out, true /*dedupe*/);
+    writer.write("b");
+    writer.write("a");
+    writer.write("b");
+    writer.write("");
+    writer.write("a");
+    writer.write("c");
+    writer.flush();
+    ASSERT_EQ(out.str(), std::string("b\na\nc\n"));
+}
+
+TEST(OutputWriterTests, StreamWriterDedupeIsBounded)
+{
+    std::stringstream out;
+    // a single slot only remembers the last row
+    wal::writers::StreamWriter writer(out, true /*dedupe*/, 1);
+    writer.write("a");
+    writer.write("a");
+    writer.write("b");
+    writer.write("a");
+    ASSERT_EQ(out.str(), std::string("a\nb\na\n"));
+}
+
+TEST(OutputWriterTests, BatchInsertWriterMergesRows)
+{
+    std::stringstream out;
+    wal::writers::BatchInsertWriter batch(out, 2);
+    wal::writers::SortedWriter writer(batch);
+    writer.write("INSERT INTO a (x) VALUES (1);");
+    writer.write("INSERT INTO a (x) VALUES (2);");
+    writer.write("INSERT INTO a (x) VALUES (3);");
+    writer.write("INSERT INTO b (x, y) VALUES (\") VALUES (\", 4);");
+    writer.flush();
+    ASSERT_EQ(out.str(), std::string("BEGIN;\n"
+                                     "INSERT OR IGNORE INTO b (x, y) VALUES (\") VALUES (\", 4);\n"
+                                     "INSERT OR IGNORE INTO a (x) VALUES (3),\n(2);\n"
+                                     "INSERT OR IGNORE INTO a (x) VALUES (1);\n"
+                                     "COMMIT;\n"));
+}
+
+TEST(OutputWriterTests, BatchInsertWriterStatementLimit)
+{
+    std::stringstream out;
+    // room for the prefix and two rows
+    wal::writers::BatchInsertWriter writer(out, 100, 46);
+    writer.write("INSERT INTO a (x) VALUES (1);");
+    writer.write("INSERT INTO a (x) VALUES (2);");
+    writer.write("-- carved\nINSERT INTO a (x) VALUES (3);");
+    writer.write("INSERT INTO a (x) VALUES (4);");
+    writer.write("INSERT INTO a (x) VALUES (5);");
+    writer.write("INSERT INTO a (x) VALUES (6);");
+    writer.flush();
+    ASSERT_EQ(out.str(), std::string("BEGIN;\n"
+                                     "INSERT OR IGNORE INTO a (x) VALUES (1),\n(2);\n"
+                                     "-- carved\nINSERT INTO a (x) VALUES (3);\n"
+                                     "INSERT OR IGNORE INTO a (x) VALUES (4),\n(5);\n"
+                                     "INSERT OR IGNORE INTO a (x) VALUES (6);\n"
+                                     "COMMIT;\n"));
+}
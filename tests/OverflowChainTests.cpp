@@ -0,0 +1,48 @@
+#include "TestBase.h"
+#include "Readers/OverflowChain.h"
+#include "Readers/RecordHeaderReader.h"
+#include <vector>
+
+using wal::readers::OverflowChain;
+
+TEST(OverflowChainTests, LocalPayloadSize)
+{
+    // 4096 byte pages: a table cell holds up to 4061 bytes, at least 489 once the payload spills
+    ASSERT_EQ(OverflowChain::localPayloadSize(4061, 4096, true), size_t(4061));
+    ASSERT_EQ(OverflowChain::localPayloadSize(4062, 4096, true), size_t(489));
+    ASSERT_EQ(OverflowChain::localPayloadSize(5000, 4096, true), size_t(908));
+    // index cells spill earlier
+    ASSERT_EQ(OverflowChain::localPayloadSize(1002, 4096, false), size_t(1002));
+    ASSERT_EQ(OverflowChain::localPayloadSize(1003, 4096, false), size_t(489));
+    ASSERT_EQ(OverflowChain::localPayloadSize(5000, 4096, false), size_t(908));
+}
+
+TEST(OverflowChainTests, MissingOverflowPagesTruncate)
+{
+    // 512 byte pages, a 600 bytes payload keeps 92 bytes in the cell
+    constexpr size_t usableSize = 512;
+    constexpr size_t textSize = 597;
+    std::vector<uint8_t> cell = {
+        0x84, 0x58, // payload size 600
+        0x01,       // row id
+        0x03,       // header size
+        0x89, 0x37  // text of 597 bytes (13 + 2*597 = 1207)
+    };
+    for (size_t i=0; i<92-3; ++i) { cell.push_back('a'); }
+    cell.insert(cell.end(), {0x00, 0x00, 0x00, 0x07}); // first overflow page
+    while (cell.size() < usableSize) { cell.push_back(0); }
+
+    wal::FixedRuntimeArray<uint8_t> page(cell);
+    wal::readers::RecordHeaderReader::Overflow overflow;
+    overflow.usableSize = usableSize;
+    wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable, overflow);
+    wal::Log::get().setLogLevel(wal::Log::ReportLevel::None);
+
+    auto it = page.begin();
+    reader.read(it);
+    const auto& columns = reader.headerData().headerData;
+    ASSERT_EQ(columns.size(), size_t(1));
+    ASSERT_TRUE(columns[0].isTruncated(), "column should be truncated");
+    ASSERT_EQ(columns[0].asStringView().size(), size_t(92-3));
+    ASSERT_TRUE(columns[0].asStringView().size() < textSize, "only the part in the cell is read");
+}
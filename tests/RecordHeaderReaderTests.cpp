@@ -3,6 +3,20 @@
 #include "Readers/RecordHeaderReader.h"
 #include "Converters/FromData.h"
 #include "Converters/Endian.h"
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/PageSource.h"
+#include "WalBuilder.h"
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+    bool inPage(std::span<const uint8_t> column, const wal::FixedRuntimeArray<uint8_t>& page)
+    {
+        const uint8_t* begin = page.begin().ptr();
+        return column.data() >= begin && column.data() + column.size() <= begin + page.size();
+    }
+}
 
 TEST(RecordHeaderReaderTests, ReadHeaderTwo16UIntsLeftIndexNode)
 {
@@ -67,3 +81,163 @@ TEST(RecordHeaderReaderTests, ReadHeaderTwo16UIntsLeftTableNode)
     }
 
 }
+
+TEST(RecordHeaderReaderTests, PeekRowid)
+{
+    int64_t rowid = 0;
+    // payload size & rowid of a single byte
+    wal::FixedRuntimeArray<uint8_t> small = { 0x04, 0x05, 0x03, 0x00, 0x01, 0x05 };
+    ASSERT_TRUE(wal::readers::RecordHeaderReader::peekRowid(small.begin(), rowid), "single byte rowid");
+    ASSERT_EQ(rowid, int64_t(5));
+
+    // 2 & 3 bytes rowids after a 2 bytes payload size
+    wal::FixedRuntimeArray<uint8_t> twoBytes = { 0x81, 0x00, 0x82, 0x2c };
+    ASSERT_TRUE(wal::readers::RecordHeaderReader::peekRowid(twoBytes.begin(), rowid), "2 bytes rowid");
+    ASSERT_EQ(rowid, int64_t(300));
+    wal::FixedRuntimeArray<uint8_t> threeBytes = { 0x04, 0x81, 0x9c, 0x20 };
+    ASSERT_TRUE(wal::readers::RecordHeaderReader::peekRowid(threeBytes.begin(), rowid), "3 bytes rowid");
+    ASSERT_EQ(rowid, int64_t(20000));
+
+    // the 9th byte of a varint holds 8 bits, negative rowids always take 9 bytes
+    wal::FixedRuntimeArray<uint8_t> nineBytes = { 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    ASSERT_TRUE(wal::readers::RecordHeaderReader::peekRowid(nineBytes.begin(), rowid), "9 bytes rowid");
+    ASSERT_EQ(rowid, int64_t(-1));
+
+    // the rowid runs past the end of the page
+    wal::FixedRuntimeArray<uint8_t> truncated = { 0x04, 0x81, 0x9c };
+    ASSERT_TRUE(!wal::readers::RecordHeaderReader::peekRowid(truncated.begin(), rowid), "truncated rowid");
+    wal::FixedRuntimeArray<uint8_t> noRowid = { 0x04 };
+    ASSERT_TRUE(!wal::readers::RecordHeaderReader::peekRowid(noRowid.begin(), rowid), "missing rowid");
+}
+
+TEST(RecordHeaderReaderTests, InlineColumnsAreViews)
+{
+    wal::FixedRuntimeArray<uint8_t> data = {
+        0x17, // payload size
+        0x07, // row id
+        0x08, // header size
+        0x00, 0x01, 0x08, 0x09, 0x07, 0x17, 0x0e, // null, int8, 0, 1, float, text of 5, blob of 1
+        0xfe,
+        0x40, 0x09, 0x21, 0xf9, 0xf0, 0x1b, 0x86, 0x6e,
+        'h', 'e', 'l', 'l', 'o',
+        0xab,
+        0x55 // the next cell
+    };
+
+    wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable);
+    auto it = data.begin();
+    reader.read(it);
+    ASSERT_TRUE(it.ptr() == data.begin().ptr() + 25, "iterator is after the record");
+
+    const auto& record = reader.headerData();
+    ASSERT_EQ(record.rowid, int64_t(7));
+    const auto& columns = record.headerData;
+    ASSERT_EQ(columns.size(), size_t(7));
+    ASSERT_TRUE(columns[0].isNull(), "null column");
+    ASSERT_EQ(columns[1].asInt64(), int64_t(-2));
+    ASSERT_TRUE(columns[2].getType() == wal::types::RecordSerialTypes::Zero, "constant 0");
+    ASSERT_TRUE(columns[3].getType() == wal::types::RecordSerialTypes::One, "constant 1");
+    ASSERT_TRUE(columns[4].asFloat64() > 3.14 && columns[4].asFloat64() < 3.15, "float column");
+    ASSERT_TRUE(columns[5].asStringView() == "hello", "text column");
+    ASSERT_EQ(columns[6].asRawData().size(), size_t(1));
+    ASSERT_EQ(columns[6].asRawData()[0], uint8_t(0xab));
+
+    // nothing is copied, the columns point into the page
+    for (size_t i : { 1, 4, 5, 6 })
+    {
+        ASSERT_TRUE(inPage(columns[i].asRawData(), data) && !columns[i].isTruncated(), "column is a view into the page");
+    }
+    ASSERT_TRUE(columns[5].asRawData().data() == data.begin().ptr() + 19, "text starts after the float");
+}
+
+TEST(RecordHeaderReaderTests, OverflowColumnIsCopied)
+{
+    // 512 byte pages, a 601 bytes payload keeps 93 bytes in the cell and the other 508 fill one overflow page
+    constexpr uint32_t pageSize = 512;
+    constexpr size_t textSize = 596;
+    std::string text;
+    for (size_t i = 0; i < textSize; ++i) { text += static_cast<char>('a' + i % 26); }
+
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-RecordHeaderReaderTests.db-wal";
+    std::filesystem::remove(path);
+    std::vector<uint8_t> overflowPage(pageSize, 0); // next page 0, the chain ends here
+    std::copy(text.begin() + 88, text.end(), overflowPage.begin() + 4);
+    TestUtils::WalBuilder builder(path, pageSize);
+    builder.header(1, 2);
+    builder.frame(3, 3, overflowPage);
+
+    std::vector<uint8_t> cell = {
+        0x84, 0x59, // payload size 601
+        0x01,       // row id
+        0x04,       // header size
+        0x01,       // int8
+        0x89, 0x35, // text of 596 bytes (13 + 2*596 = 1205)
+        0x2a
+    };
+    cell.insert(cell.end(), text.begin(), text.begin() + 88);
+    cell.insert(cell.end(), { 0x00, 0x00, 0x00, 0x03 }); // first overflow page
+    cell.resize(pageSize, 0);
+    wal::FixedRuntimeArray<uint8_t> page(cell);
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    wal::readers::PageSource pages(walReader);
+    pages.build(walReader.frameCount());
+
+    wal::readers::RecordHeaderReader::Overflow overflow;
+    overflow.usableSize = pageSize;
+    overflow.pages = &pages;
+    overflow.frameIndex = 0;
+    wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable, overflow);
+    auto it = page.begin();
+    reader.read(it);
+
+    const auto& columns = reader.headerData().headerData;
+    ASSERT_EQ(columns.size(), size_t(2));
+    ASSERT_EQ(columns[0].asUInt8(), uint8_t(0x2a));
+    ASSERT_TRUE(inPage(columns[0].asRawData(), page), "column in the cell is a view into the page");
+    ASSERT_TRUE(!columns[1].isTruncated(), "overflow page was read");
+    ASSERT_TRUE(columns[1].asStringView() == text, "text from the cell and the overflow page");
+    ASSERT_TRUE(!inPage(columns[1].asRawData(), page), "overflowed column is copied out of the page");
+    ASSERT_TRUE(it.ptr() == page.begin().ptr() + 3 + 93 + 4, "iterator is after the overflow page number");
+
+    std::filesystem::remove(path);
+}
+
+TEST(RecordHeaderReaderTests, TruncatedRecordsThrow)
+{
+    wal::readers::RecordHeaderReader reader(wal::types::BTreeNodePageType::leafTable);
+
+    // the header is bigger than the payload
+    wal::FixedRuntimeArray<uint8_t> longHeader = { 0x03, 0x01, 0x0a, 0x01, 0x01 };
+    auto it = longHeader.begin();
+    bool thrown = false;
+    try { reader.read(it); }
+    catch(const std::out_of_range&) { thrown = true; }
+    ASSERT_TRUE(thrown, "header past the payload");
+
+    // the page ends inside the text column
+    wal::FixedRuntimeArray<uint8_t> shortPage = { 0x0c, 0x01, 0x02, 0x1b, 'a', 'b', 'c' };
+    it = shortPage.begin();
+    thrown = false;
+    try { reader.read(it); }
+    catch(const std::out_of_range&) { thrown = true; }
+    ASSERT_TRUE(thrown, "column past the end of the page");
+
+    // a serial type varint that runs past the header
+    wal::FixedRuntimeArray<uint8_t> brokenType = { 0x04, 0x01, 0x02, 0x81, 0x00, 0x00 };
+    it = brokenType.begin();
+    thrown = false;
+    try { reader.read(it); }
+    catch(const std::out_of_range&) { thrown = true; }
+    ASSERT_TRUE(thrown, "serial type past the header");
+
+    // the reader is still usable after a malformed record
+    wal::FixedRuntimeArray<uint8_t> valid = { 0x03, 0x09, 0x02, 0x01, 0x05 };
+    it = valid.begin();
+    reader.read(it);
+    ASSERT_EQ(reader.headerData().rowid, int64_t(9));
+    ASSERT_EQ(reader.headerData().headerData.size(), size_t(1));
+    ASSERT_EQ(reader.headerData().headerData[0].asUInt8(), uint8_t(5));
+}
@@ -103,6 +103,10 @@ TEST(SchemaFormatterTests,PrimaryKeyPattern1)
 
     constexpr auto expectedOutput = "INSERT INTO foo (col1, col2) VALUES (44, 2);";
     ASSERT_EQ(formatter->generateOutput(data), expectedOutput);
+
+    // a carved record that lost it's rowid
+    data.rowidKnown = false;
+    ASSERT_EQ(formatter->generateOutput(data), std::string("INSERT INTO foo (col1, col2) VALUES (NULL, 2);"));
 }
 
 
@@ -373,6 +377,82 @@ TEST(SchemaFormatterTests,allTypes)
     constexpr auto expectedOutput = "INSERT INTO foo "
     "(a, b, c, d, e, f, g, h, j, k, l, m, n, o, p, q, r, s, t, u, v, w, x, y, z, aa, ab) "
     "VALUES "
-    "(1, 2, 3, 4, 1280, 393216, 393216, 7, 8, \"AAAAAAAAAAAAAAI\", \"AAAAAAAAAAAAAAP\", \"AAAAAAAAAAAAAAQ\", \"AAAAAAAAAAAAAAR\", \"AAAAAAAAAAAAAAS\", \"AAAAAAAAAAAAAAT\", \"AAAAAAAAAAAAAAU\", \"AAAAAAAAAAAAAAU\", 0x0A0A0A0A0A0A0A0A0A0A0A0A0A0A0V, 7.26239e+16, 1.44681e+17, 2.16739e+17, 2.88797e+17, 16, 4.32912e+17, 1, 17, 18);";
+    "(1, 2, 3, 4, 5, 6, 6, 7, 8, \"AAAAAAAAAAAAAAI\", \"AAAAAAAAAAAAAAP\", \"AAAAAAAAAAAAAAQ\", \"AAAAAAAAAAAAAAR\", \"AAAAAAAAAAAAAAS\", \"AAAAAAAAAAAAAAT\", \"AAAAAAAAAAAAAAU\", \"AAAAAAAAAAAAAAU\", 0x0A0A0A0A0A0A0A0A0A0A0A0A0A0A0V, 8.20788e-304, 5.37912e-299, 3.52526e-294, 2.31031e-289, 16, 9.92272e-280, 1, 17, 18);";
     ASSERT_EQ(formatter->generateOutput(data), expectedOutput);
 }
+
+TEST(SchemaFormatterTests,ProjectedColumns)
+{
+    constexpr auto sql = "CREATE TABLE foo (col1 INTEGER PRIMARY KEY, col2 INTEGER, col3 INTEGER);";
+    auto formatter = wal::formatters::Factory::instance().getFormatter(wal::formatters::SchemaFormatter::id);
+    formatter->setInput(std::make_unique<wal::formatters::inputs::StringInput>(sql));
+    formatter->setProjection({"col3", "col1"});
+    formatter->prepare();
+
+    // col2 isn't projected, the reader hands it over as a null placeholder
+    wal::readers::RecordHeaderReader::RecordData data = {
+       {
+        {RecordSerialTypes::Null, {}},
+        {RecordSerialTypes::Null, {}},
+        {RecordSerialTypes::FourBytesIntBE, {0x00,0x00,0x00,0x03} }
+       },
+       7 //rowid
+    };
+
+    constexpr auto expectedOutput = "INSERT INTO foo (col3, col1) VALUES (3, 7);";
+    ASSERT_EQ(formatter->generateOutput(data), expectedOutput);
+
+    const auto& mask = formatter->projectionMask();
+    ASSERT_EQ(mask.size(), size_t(3));
+    ASSERT_TRUE(mask[0] && !mask[1] && mask[2], "col2 shouldn't be decoded");
+}
+
+TEST(SchemaFormatterTests,ProjectedUnknownColumn)
+{
+    constexpr auto sql = "CREATE TABLE foo (col1 INTEGER, col2 INTEGER);";
+    auto formatter = wal::formatters::Factory::instance().getFormatter(wal::formatters::SchemaFormatter::id);
+    formatter->setInput(std::make_unique<wal::formatters::inputs::StringInput>(sql));
+    formatter->setProjection({"col3"});
+
+    try { formatter->prepare(); }
+    catch (formatException& e)
+    {
+        ASSERT_EQ(wal::formatters::Formatter::unknownColumnError, e.code());
+        return;
+    }
+    FAILURE("prepare passed with an unknown column");
+}
+
+TEST(SchemaFormatterTests,ProjectionChangeRebuildsPrefix)
+{
+    constexpr auto sql = "CREATE TABLE foo (col1 INTEGER PRIMARY KEY, col2 INTEGER, col3 INTEGER);";
+    auto formatter = wal::formatters::Factory::instance().getFormatter(wal::formatters::SchemaFormatter::id);
+    formatter->setInput(std::make_unique<wal::formatters::inputs::StringInput>(sql));
+    formatter->setProjection({});
+
+    wal::readers::RecordHeaderReader::RecordData data = {
+       {
+        {RecordSerialTypes::Null, {}},
+        {RecordSerialTypes::FourBytesIntBE, {0x00,0x00,0x00,0x02} },
+        {RecordSerialTypes::FourBytesIntBE, {0x00,0x00,0x00,0x03} }
+       },
+       7 //rowid
+    };
+
+    // the same buffer is reused for every row
+    std::string out = "left from another row";
+    formatter->generateOutput(data, out);
+    ASSERT_EQ(out, std::string("INSERT INTO foo (col1, col2, col3) VALUES (7, 2, 3);"));
+
+    formatter->setProjection({"col2", "col1"});
+    formatter->generateOutput(data, out);
+    ASSERT_EQ(out, std::string("INSERT INTO foo (col2, col1) VALUES (2, 7);"));
+
+    formatter->setProjection({"col3"});
+    formatter->generateOutput(data, out);
+    ASSERT_EQ(out, std::string("INSERT INTO foo (col3) VALUES (3);"));
+
+    formatter->setProjection({});
+    formatter->generateOutput(data, out);
+    ASSERT_EQ(out, std::string("INSERT INTO foo (col1, col2, col3) VALUES (7, 2, 3);"));
+}
@@ -0,0 +1,37 @@
+#include "TestBase.h"
+#include <sstream>
+#include <sqlite3.h>
+#include "Writers/BatchInsertWriter.h"
+#include "Writers/SortedWriter.h"
+
+namespace {
+    long long replay(const std::string& sql)
+    {
+        sqlite3* db = nullptr;
+        sqlite3_open(":memory:", &db);
+        sqlite3_exec(db, "CREATE TABLE a (x INTEGER PRIMARY KEY, y TEXT);", nullptr, nullptr, nullptr);
+        const int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
+        long long rows = -1;
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, "SELECT count(*) FROM a", -1, &stmt, nullptr);
+        if (SQLITE_OK == rc && SQLITE_ROW == sqlite3_step(stmt)) { rows = sqlite3_column_int64(stmt, 0); }
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return rows;
+    }
+}
+
+TEST(SqlReplayTests, BatchedRowsWithRepeatedKeys)
+{
+    std::stringstream out;
+    wal::writers::BatchInsertWriter batch(out, 500);
+    wal::writers::SortedWriter writer(batch);
+    // every row has an older version with the same primary key
+    for (int i = 0; i < 10; ++i)
+    {
+        writer.write("INSERT INTO a (x, y) VALUES (" + std::to_string(i) + ", 'new');");
+        writer.write("INSERT INTO a (x, y) VALUES (" + std::to_string(i) + ", 'old');");
+    }
+    writer.flush();
+    ASSERT_EQ(replay(out.str()), 10);
+}
@@ -0,0 +1,28 @@
+#include "TestBase.h"
+#include <thread>
+#include <string>
+#include "Utils/Stats.h"
+
+using wal::Stats;
+
+TEST(StatsTests, SumsThreads)
+{
+    auto& stats = Stats::get();
+    const auto before = stats.total(Stats::Counter::RowsCarved);
+    stats.enable();
+
+    auto count = [&stats]()
+    {
+        for (int i = 0; i < 1000; ++i) { stats.add(Stats::Counter::RowsCarved); }
+        Stats::Timer timer(Stats::Stage::Output);
+    };
+    std::thread first(count);
+    std::thread second(count);
+    first.join();
+    second.join();
+    count();
+
+    ASSERT_EQ(stats.total(Stats::Counter::RowsCarved) - before, uint64_t(3000));
+    ASSERT_TRUE(stats.json().find("\"rows_carved\":") != std::string::npos, "counters are named in the json");
+    ASSERT_TRUE(stats.summary().find("output") != std::string::npos, "stages are in the summary");
+}
@@ -0,0 +1,174 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <string>
+#include <sqlite3.h>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/PageSource.h"
+#include "Readers/TableMap.h"
+#include "Formatters/TableFormatters.h"
+#include "Converters/Endian.h"
+#include "WalBuilder.h"
+
+namespace {
+    constexpr size_t rightMostChildOffset = 8;
+
+    void execute(sqlite3* db, const std::string& sql) { sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr); }
+
+    int64_t query(sqlite3* db, const std::string& sql)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        const int64_t value = SQLITE_ROW == sqlite3_step(stmt) ? sqlite3_column_int64(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    }
+
+    // a database with two tables, "a" was checkpointed into the database file and is big enough for an interior
+    // root page, "b" and an update of "a" are only in the WAL. the files are copied while the connection is open,
+    // closing it would checkpoint the WAL
+    struct Database
+    {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "wal-parser-TableMapTests.db";
+        std::filesystem::path walPath = path.string() + "-wal";
+        int64_t rootA = 0;
+        int64_t rootB = 0;
+        int64_t pageCount = 0;
+
+        Database()
+        {
+            const auto source = std::filesystem::temp_directory_path() / "wal-parser-TableMapTests-source.db";
+            std::filesystem::remove(source);
+            std::filesystem::remove(source.string() + "-wal");
+            sqlite3* db = nullptr;
+            sqlite3_open(source.c_str(), &db);
+            execute(db, "PRAGMA page_size=1024; PRAGMA journal_mode=WAL; PRAGMA wal_autocheckpoint=0;");
+            execute(db, "CREATE TABLE a (id INTEGER PRIMARY KEY, v TEXT);");
+            execute(db, "BEGIN;");
+            for (int i = 1; i <= 200; ++i) { execute(db, "INSERT INTO a (v) VALUES ('" + std::string(100, 'a') + "');"); }
+            execute(db, "COMMIT; PRAGMA wal_checkpoint(TRUNCATE);");
+            execute(db, "CREATE TABLE b (id INTEGER PRIMARY KEY, n INTEGER);");
+            execute(db, "INSERT INTO b (n) VALUES (1), (2), (3); UPDATE a SET v = 'x' WHERE id = 1;");
+            rootA = query(db, "SELECT rootpage FROM sqlite_schema WHERE name = 'a'");
+            rootB = query(db, "SELECT rootpage FROM sqlite_schema WHERE name = 'b'");
+            pageCount = query(db, "PRAGMA page_count");
+
+            std::filesystem::copy_file(source, path, std::filesystem::copy_options::overwrite_existing);
+            std::filesystem::copy_file(source.string() + "-wal", walPath, std::filesystem::copy_options::overwrite_existing);
+            sqlite3_close(db);
+            std::filesystem::remove(source);
+        }
+
+        ~Database()
+        {
+            std::filesystem::remove(path);
+            std::filesystem::remove(walPath);
+        }
+    };
+}
+
+TEST(TableMapTests, RoutesPagesToTables)
+{
+    Database database;
+    wal::MappedFile walFile(database.walPath);
+    wal::MappedFile databaseFile(database.path, wal::MappedFile::AccessHint::Random);
+    wal::readers::WalFrameReader walReader(walFile);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    const size_t frameCount = walReader.frameCount();
+    ASSERT_TRUE(frameCount > 0, "WAL has frames");
+
+    wal::readers::PageSource pages(walReader, &databaseFile);
+    pages.build(frameCount);
+    ASSERT_TRUE(pages.hasDatabase(), "database matches the WAL");
+
+    wal::readers::TableMap tableMap(pages);
+    tableMap.build(frameCount - 1);
+    ASSERT_EQ(tableMap.tables().size(), size_t(2));
+    ASSERT_TRUE(tableMap.tables()[0].name == "a" && tableMap.tables()[1].name == "b", "tables in sqlite_schema order");
+    ASSERT_EQ(int64_t(tableMap.tables()[0].rootPage), database.rootA);
+    ASSERT_EQ(int64_t(tableMap.tables()[1].rootPage), database.rootB);
+    // every page but sqlite_schema's belongs to one of the tables
+    ASSERT_EQ(int64_t(tableMap.pageCount()), database.pageCount - 1);
+    ASSERT_TRUE(!tableMap.tableOf(1), "page 1 is sqlite_schema");
+
+    // the root of "a" is an interior page, it's children are found through it
+    const uint8_t* root = pages.page(static_cast<uint32_t>(database.rootA), frameCount - 1);
+    ASSERT_TRUE(nullptr != root && 0x05 == root[0], "root of a is an interior table page");
+    const uint32_t child = wal::converters::Endian::loadBig<uint32_t>(root + rightMostChildOffset);
+    ASSERT_EQ(tableMap.tableOf(static_cast<uint32_t>(database.rootA)).value_or(99), size_t(0));
+    ASSERT_EQ(tableMap.tableOf(child).value_or(99), size_t(0));
+    ASSERT_EQ(tableMap.tableOf(static_cast<uint32_t>(database.rootB)).value_or(99), size_t(1));
+
+    wal::formatters::TableFormatters formatters(tableMap);
+    ASSERT_EQ(formatters.prepare(true), size_t(2));
+    ASSERT_TRUE(nullptr == formatters.forPage(1), "no formatter for sqlite_schema");
+    auto* formatterB = formatters.forPage(static_cast<uint32_t>(database.rootB));
+    ASSERT_TRUE(nullptr != formatterB, "formatter for b");
+    ASSERT_TRUE(formatterB->columnNames() == std::vector<std::string>({ "id", "n" }), "columns of b");
+    auto* formatterA = formatters.forPage(child);
+    ASSERT_TRUE(nullptr != formatterA, "formatter for a leaf of a");
+    ASSERT_TRUE(formatterA->columnNames() == std::vector<std::string>({ "id", "v" }), "columns of a");
+}
+
+TEST(TableMapTests, CacheMatchesState)
+{
+    Database database;
+    wal::MappedFile walFile(database.walPath);
+    wal::MappedFile databaseFile(database.path, wal::MappedFile::AccessHint::Random);
+    wal::readers::WalFrameReader walReader(walFile);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    const size_t frameCount = walReader.frameCount();
+
+    wal::readers::PageSource pages(walReader, &databaseFile);
+    pages.build(frameCount);
+    wal::readers::TableMap built(pages);
+    built.build(frameCount - 1);
+
+    const auto cachePath = std::filesystem::temp_directory_path() / "wal-parser-TableMapTests.pagemap";
+    const auto key = wal::readers::TableMap::stateKey(walReader, &databaseFile, frameCount);
+    ASSERT_TRUE(key != wal::readers::TableMap::stateKey(walReader, &databaseFile, frameCount - 1), "key covers the frames");
+    ASSERT_TRUE(key != wal::readers::TableMap::stateKey(walReader, nullptr, frameCount), "key covers the database");
+    ASSERT_TRUE(built.save(cachePath, key), "save the map");
+
+    wal::readers::TableMap loaded(pages);
+    ASSERT_TRUE(!loaded.load(cachePath, key + 1), "map of another state is rejected");
+    ASSERT_EQ(loaded.tables().size(), size_t(0));
+    ASSERT_TRUE(loaded.load(cachePath, key), "map of the same state is reused");
+    ASSERT_EQ(loaded.tables().size(), size_t(2));
+    ASSERT_TRUE(loaded.tables()[1].sql == built.tables()[1].sql, "schema of b");
+    ASSERT_EQ(loaded.pageCount(), built.pageCount());
+    for (uint32_t page = 1; page <= database.pageCount; ++page)
+    {
+        ASSERT_TRUE(loaded.tableOf(page) == built.tableOf(page), "same table for every page");
+    }
+    std::filesystem::remove(cachePath);
+}
+
+TEST(TableMapTests, MalformedSchemaPage)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-TableMapTests-malformed.db-wal";
+    std::filesystem::remove(path);
+
+    // sqlite_schema is a leaf page whose cell count runs it's pointer array past the end of the page
+    TestUtils::WalBuilder builder(path);
+    auto schema = TestUtils::emptyPage(0x0d, builder.pageSize());
+    std::fill(schema.begin() + 100, schema.begin() + 108, 0);
+    schema[100] = 0x0d;
+    schema[103] = 0xff;
+    schema[104] = 0xff;
+    builder.header(1, 2);
+    builder.frame(1, 1, schema);
+
+    wal::MappedFile walFile(path);
+    wal::readers::WalFrameReader walReader(walFile);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    wal::readers::PageSource pages(walReader);
+    pages.build(walReader.frameCount());
+
+    // the page is skipped, there are no tables
+    wal::readers::TableMap tableMap(pages);
+    tableMap.build(0);
+    ASSERT_TRUE(tableMap.tables().empty(), "no tables in a malformed sqlite_schema");
+
+    std::filesystem::remove(path);
+}
@@ -47,5 +47,5 @@ int main(int argc, char** argv)
         " Failed " << totalTestFails << " tests in " << totalSuiteFails << " Suites" <<
     std::endl;
     divider(100,'=');
-    return 0;
+    return totalTestFails > 0 ? 1 : 0;
 }
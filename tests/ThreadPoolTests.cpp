@@ -0,0 +1,31 @@
+#include "TestBase.h"
+#include <atomic>
+#include "Utils/ThreadPool.h"
+
+TEST(ThreadPoolTests, RunsAllTasks)
+{
+    std::atomic<int> counter = 0;
+    std::vector<std::future<int>> results;
+    {
+        wal::ThreadPool pool(3);
+        for (int i=0; i<100; ++i)
+        {
+            results.emplace_back(pool.submit([i, &counter](){ counter++; return i*2; }));
+        }
+        for (int i=0; i<100; ++i)
+        {
+            ASSERT_EQ(results[i].get(), i*2);
+        }
+    }
+    ASSERT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTests, ExceptionReachesFuture)
+{
+    wal::ThreadPool pool(2);
+    auto result = pool.submit([](){ throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try { result.get(); }
+    catch(const std::runtime_error&) { thrown = true; }
+    ASSERT_TRUE(thrown, "expected the task exception to be rethrown by the future");
+}
@@ -0,0 +1,42 @@
+#include "TestBase.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Utils/Trace.h"
+
+using wal::Trace;
+
+namespace {
+    size_t occurrences(const std::string& text, const std::string& part)
+    {
+        size_t count = 0;
+        for (auto pos = text.find(part); std::string::npos != pos; pos = text.find(part, pos + 1)) { ++count; }
+        return count;
+    }
+}
+
+TEST(TraceTests, SavesNewestEvents)
+{
+    auto& trace = Trace::get();
+    trace.enable();
+    {
+        Trace::Scope scope("trace test outer", "frame", 7);
+        // more than a buffer holds, the oldest ones are overwritten
+        for (size_t i = 0; i < Trace::bufferEvents + 10; ++i) { Trace::Scope inner("trace test inner"); }
+    }
+
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-TraceTests.json";
+    ASSERT_TRUE(trace.save(path), "trace is written");
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const auto json = ss.str();
+
+    ASSERT_TRUE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), "chrome trace object");
+    ASSERT_EQ(occurrences(json, "\"name\":\"trace test inner\""), Trace::bufferEvents - 1);
+    ASSERT_TRUE(json.find("\"name\":\"trace test outer\",\"ph\":\"X\"") != std::string::npos, "the newest event is kept");
+    ASSERT_TRUE(json.find("\"args\":{\"frame\":7}") != std::string::npos, "event argument");
+
+    std::filesystem::remove(path);
+}
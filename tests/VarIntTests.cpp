@@ -0,0 +1,58 @@
+#include "TestBase.h"
+#include "Converters/VarInt.h"
+#include <vector>
+
+using wal::converters::VarInt;
+
+TEST(VarIntTests, SingleVarInts)
+{
+    uint64_t value = 0;
+
+    const uint8_t oneByte[] = {0x7f};
+    ASSERT_EQ(VarInt::readVarInt(oneByte, sizeof(oneByte), value), size_t(1));
+    ASSERT_EQ(value, uint64_t(0x7f));
+
+    const uint8_t twoBytes[] = {0x81, 0x00};
+    ASSERT_EQ(VarInt::readVarInt(twoBytes, sizeof(twoBytes), value), size_t(2));
+    ASSERT_EQ(value, uint64_t(0x80));
+
+    // the 9-th byte contributes all of it's 8 bits
+    const uint8_t nineBytes[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    ASSERT_EQ(VarInt::readVarInt(nineBytes, sizeof(nineBytes), value), size_t(9));
+    ASSERT_EQ(value, uint64_t(0xffffffffffffffff));
+
+    // doesn't fit
+    ASSERT_EQ(VarInt::readVarInt(twoBytes, 1, value), size_t(0));
+}
+
+TEST(VarIntTests, BatchMatchesScalar)
+{
+    // long runs of single bytes (the block paths) broken by multi byte varints at different offsets
+    std::vector<uint8_t> data;
+    for (int i=0; i<100; ++i)
+    {
+        if (i % 37 == 5) { data.insert(data.end(), {0x83, 0xe8, 0x07}); }
+        else if (i % 23 == 22) { data.insert(data.end(), {0x81, 0x00}); }
+        else { data.push_back(static_cast<uint8_t>(i)); }
+    }
+
+    std::vector<uint64_t> expected;
+    for (size_t pos=0; pos<data.size();)
+    {
+        uint64_t value = 0;
+        pos += VarInt::readVarInt(data.data() + pos, data.size() - pos, value);
+        expected.push_back(value);
+    }
+
+    std::vector<uint64_t> result;
+    ASSERT_TRUE(VarInt::readVarInts(data.data(), data.size(), result), "batch decode failed");
+    ASSERT_EQ(result.size(), expected.size());
+    for (size_t i=0; i<expected.size(); ++i) { ASSERT_EQ(result[i], expected[i]); }
+}
+
+TEST(VarIntTests, BatchTruncated)
+{
+    const uint8_t data[] = {0x01, 0x02, 0x81};
+    std::vector<uint64_t> result;
+    ASSERT_TRUE(!VarInt::readVarInts(data, sizeof(data), result), "truncated varint should fail");
+}
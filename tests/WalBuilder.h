@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include "Readers/WalFrameReader.h"
+#include "Readers/WalChecksum.h"
+
+////////////////////// WAL files for tests /////////////////////////////////////
+namespace TestUtils {
+
+    inline void putBig(std::vector<uint8_t>& out, size_t offset, uint32_t value)
+    {
+        for (size_t i = 0; i < 4; ++i) { out[offset + i] = static_cast<uint8_t>(value >> (24 - 8 * i)); }
+    }
+
+    // sqlite's varint, values past 56 bits (i.e. negative rowids) take 9 bytes and the last one holds 8 bits
+    inline std::vector<uint8_t> varint(uint64_t value)
+    {
+        if (value >> 56)
+        {
+            std::vector<uint8_t> bytes(9, 0);
+            bytes[8] = static_cast<uint8_t>(value);
+            value >>= 8;
+            for (size_t i = 8; i-- > 0; value >>= 7) { bytes[i] = static_cast<uint8_t>(0x80 | (value & 0x7f)); }
+            return bytes;
+        }
+        std::vector<uint8_t> bytes(1, static_cast<uint8_t>(value & 0x7f));
+        while (value >>= 7) { bytes.insert(bytes.begin(), static_cast<uint8_t>(0x80 | (value & 0x7f))); }
+        return bytes;
+    }
+
+    // a leaf table page with a cell for every rowid, the record of each is a null rowid alias column and a
+    // 1 byte integer (rowid & 0x7f)
+    inline std::vector<uint8_t> leafTablePage(const std::vector<int64_t>& rowids, uint32_t pageSize)
+    {
+        std::vector<uint8_t> page(pageSize, 0);
+        page[0] = 0x0d;
+        page[3] = static_cast<uint8_t>(rowids.size() >> 8);
+        page[4] = static_cast<uint8_t>(rowids.size());
+        size_t content = pageSize;
+        for (size_t i = 0; i < rowids.size(); ++i)
+        {
+            std::vector<uint8_t> cell = { 0x04 }; // payload size
+            const auto rowid = varint(static_cast<uint64_t>(rowids[i]));
+            cell.insert(cell.end(), rowid.begin(), rowid.end());
+            cell.insert(cell.end(), { 0x03, 0x00, 0x01, static_cast<uint8_t>(rowids[i] & 0x7f) });
+            content -= cell.size();
+            std::copy(cell.begin(), cell.end(), page.begin() + content);
+            page[8 + 2 * i] = static_cast<uint8_t>(content >> 8);
+            page[9 + 2 * i] = static_cast<uint8_t>(content);
+        }
+        page[5] = static_cast<uint8_t>(content >> 8);
+        page[6] = static_cast<uint8_t>(content);
+        return page;
+    }
+
+    // a b-tree page without cells of the given type (i.e. 0x05 interior table, 0x0a leaf index)
+    inline std::vector<uint8_t> emptyPage(uint8_t type, uint32_t pageSize)
+    {
+        std::vector<uint8_t> page(pageSize, 0);
+        page[0] = type;
+        page[5] = static_cast<uint8_t>(pageSize >> 8);
+        page[6] = static_cast<uint8_t>(pageSize);
+        return page;
+    }
+
+    // writes a WAL with big endian checksums the way sqlite does, frame by frame
+    class WalBuilder
+    {
+        public:
+            explicit WalBuilder(const std::filesystem::path& path, uint32_t pageSize = 512): _path(path), _pageSize(pageSize) {}
+
+            uint32_t pageSize() const { return _pageSize; }
+
+            // starts the WAL over, frames after the header are left as they are
+            void header(uint32_t salt1, uint32_t salt2)
+            {
+                std::vector<uint8_t> header(32, 0);
+                putBig(header, 0, wal::readers::WalFrameReader::magicBigEndian);
+                putBig(header, 4, 3007000);
+                putBig(header, 8, _pageSize);
+                putBig(header, 16, salt1);
+                putBig(header, 20, salt2);
+                _checksum = wal::readers::WalChecksum::compute(header.data(), 24, true, {});
+                putBig(header, 24, _checksum.s1);
+                putBig(header, 28, _checksum.s2);
+                _salt1 = salt1;
+                _salt2 = salt2;
+                _frames = 0;
+                write(0, header);
+            }
+
+            // the page is filled with it's page number if it isn't given
+            void frame(uint32_t pageNumber, uint32_t commitSize, const std::vector<uint8_t>& page = {})
+            {
+                append(pageNumber, commitSize, page, _salt1, _salt2);
+            }
+
+            // a frame left from another generation of the WAL: other salts and a checksum that doesn't chain
+            void staleFrame(uint32_t pageNumber, uint32_t commitSize, const std::vector<uint8_t>& page = {})
+            {
+                const auto checksum = _checksum;
+                append(pageNumber, commitSize, page, _salt1 + 1, _salt2);
+                _checksum = checksum;
+            }
+
+        private:
+            void append(uint32_t pageNumber, uint32_t commitSize, const std::vector<uint8_t>& page, uint32_t salt1, uint32_t salt2)
+            {
+                std::vector<uint8_t> frame(24 + _pageSize, static_cast<uint8_t>(pageNumber));
+                if (!page.empty()) { std::copy(page.begin(), page.end(), frame.begin() + 24); }
+                putBig(frame, 0, pageNumber);
+                putBig(frame, 4, commitSize);
+                putBig(frame, 8, salt1);
+                putBig(frame, 12, salt2);
+                _checksum = wal::readers::WalChecksum::compute(frame.data(), 8, true, _checksum);
+                _checksum = wal::readers::WalChecksum::compute(frame.data() + 24, _pageSize, true, _checksum);
+                putBig(frame, 16, _checksum.s1);
+                putBig(frame, 20, _checksum.s2);
+                write(32 + _frames++ * frame.size(), frame);
+            }
+
+            void write(size_t offset, const std::vector<uint8_t>& data)
+            {
+                if (!std::filesystem::exists(_path)) { std::ofstream create(_path, std::ios::binary); }
+                std::fstream file(_path, std::ios::binary | std::ios::in | std::ios::out);
+                file.seekp(offset);
+                file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            }
+
+            std::filesystem::path _path;
+            uint32_t _pageSize;
+            wal::readers::WalChecksum::Value _checksum;
+            uint32_t _salt1 = 0;
+            uint32_t _salt2 = 0;
+            size_t _frames = 0;
+    };
+}
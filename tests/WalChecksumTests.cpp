@@ -0,0 +1,51 @@
+#include "TestBase.h"
+#include <array>
+#include <vector>
+#include "Readers/WalChecksum.h"
+
+using wal::readers::WalChecksum;
+
+TEST(WalChecksumTests, WalHeaderChecksum)
+{
+    // header of a WAL written by sqlite on a little endian machine (magic 0x377f0682)
+    const std::array<uint8_t, 32> header = {
+        0x37, 0x7f, 0x06, 0x82, 0x00, 0x2d, 0xe2, 0x18,
+        0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x8f, 0xbd, 0xb4, 0x7c, 0x97, 0xd8, 0x26, 0x95,
+        0x51, 0x9b, 0xc0, 0xa2, 0x9e, 0xaa, 0x70, 0xde };
+
+    auto checksum = WalChecksum::compute(header.data(), 24, false /*bigEndian*/, {});
+    ASSERT_EQ(checksum.s1, 0x519bc0a2u);
+    ASSERT_EQ(checksum.s2, 0x9eaa70deu);
+}
+
+TEST(WalChecksumTests, MatchesReferenceNativeAndBigEndian)
+{
+    std::vector<uint8_t> data(4096 + 512 + 8);
+    uint32_t seed = 12345;
+    for (auto& b : data)
+    {
+        seed = seed * 1103515245 + 12345;
+        b = static_cast<uint8_t>(seed >> 16);
+    }
+
+    for (size_t size : {8ul, 504ul, 512ul, 4096ul, 4104ul, data.size()})
+    {
+        for (bool bigEndian : {false, true})
+        {
+            WalChecksum::Value start{7, 11};
+            auto fast = WalChecksum::compute(data.data(), size, bigEndian, start);
+            auto reference = WalChecksum::computeReference(data.data(), size, bigEndian, start);
+            ASSERT_TRUE(fast == reference, "block checksum differs from the reference for size " + std::to_string(size));
+        }
+    }
+}
+
+TEST(WalChecksumTests, ChainingMatchesSinglePass)
+{
+    std::vector<uint8_t> data(1024 + 8, 0xAB);
+    auto first = WalChecksum::compute(data.data(), 8, true, {});
+    auto chained = WalChecksum::compute(data.data() + 8, 1024, true, first);
+    auto whole = WalChecksum::compute(data.data(), data.size(), true, {});
+    ASSERT_TRUE(chained == whole, "chained checksum differs from single pass");
+}
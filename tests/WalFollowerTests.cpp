@@ -0,0 +1,97 @@
+#include "TestBase.h"
+#include <filesystem>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/WalFollower.h"
+#include "WalBuilder.h"
+
+using TestUtils::WalBuilder;
+
+TEST(WalFollowerTests, ReturnsCommittedFramesOnce)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalFollowerTests.db-wal";
+    std::filesystem::remove(path);
+
+    WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0);
+    builder.frame(3, 4);
+    builder.frame(2, 0); // a transaction that isn't committed yet
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    wal::readers::WalFollower follower(walReader);
+
+    auto update = follower.poll();
+    ASSERT_EQ(update.frames.size(), size_t(2));
+    ASSERT_TRUE(!update.reset, "the first poll isn't a reset");
+    ASSERT_TRUE(follower.poll().frames.empty(), "nothing was committed since");
+
+    builder.frame(4, 4);
+    file.refresh();
+    update = follower.poll();
+    ASSERT_EQ(update.frames.size(), size_t(2));
+    ASSERT_EQ(update.frames.front(), size_t(2));
+    ASSERT_EQ(follower.nextFrame(), size_t(4));
+
+    // a checkpoint started the WAL over, the old frames after the new one have stale salts
+    builder.header(2, 7);
+    builder.frame(5, 5);
+    file.refresh();
+    update = follower.poll();
+    ASSERT_TRUE(update.reset, "new salts start the WAL over");
+    ASSERT_EQ(update.frames.size(), size_t(1));
+    ASSERT_EQ(update.frames.front(), size_t(0));
+    ASSERT_EQ(follower.nextFrame(), size_t(1));
+
+    std::filesystem::remove(path);
+}
+
+TEST(WalFollowerTests, ResumesFromSavedState)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalFollowerTests-resume.db-wal";
+    const auto statePath = std::filesystem::temp_directory_path() / "wal-parser-WalFollowerTests.state";
+    std::filesystem::remove(path);
+    std::filesystem::remove(statePath);
+
+    WalBuilder builder(path);
+    builder.header(3, 4);
+    builder.frame(2, 3);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        wal::readers::WalFollower follower(walReader);
+        ASSERT_EQ(follower.poll().frames.size(), size_t(1));
+        ASSERT_TRUE(follower.save(statePath), "state is written");
+    }
+
+    builder.frame(3, 0);
+    builder.frame(4, 4);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        wal::readers::WalFollower follower(walReader);
+        ASSERT_TRUE(walReader.readHeader() && follower.load(statePath), "state is read");
+        auto update = follower.poll();
+        ASSERT_TRUE(!update.reset, "same WAL");
+        ASSERT_EQ(update.frames.size(), size_t(2));
+        ASSERT_EQ(update.frames.front(), size_t(1));
+    }
+
+    // started over with the same number of frames, the saved position is of the old generation
+    builder.header(4, 9);
+    builder.frame(5, 5);
+    {
+        wal::MappedFile file(path);
+        wal::readers::WalFrameReader walReader(file);
+        wal::readers::WalFollower follower(walReader);
+        ASSERT_TRUE(walReader.readHeader() && follower.load(statePath), "state is read");
+        auto update = follower.poll();
+        ASSERT_TRUE(update.reset, "new salts start over");
+        ASSERT_EQ(update.frames.size(), size_t(1));
+        ASSERT_EQ(update.frames.front(), size_t(0));
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(statePath);
+}
@@ -0,0 +1,87 @@
+#include "TestBase.h"
+#include <filesystem>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/FrameIndex.h"
+#include "WalBuilder.h"
+
+using wal::readers::WalFrameReader;
+
+namespace {
+    bool sameTransactions(const std::vector<WalFrameReader::Transaction>& found,
+                          const std::vector<WalFrameReader::Transaction>& expected)
+    {
+        if (found.size() != expected.size()) { return false; }
+        for (size_t i = 0; i < found.size(); ++i)
+        {
+            if (found[i].firstFrame != expected[i].firstFrame ||
+                found[i].lastFrame != expected[i].lastFrame ||
+                found[i].databaseSize != expected[i].databaseSize)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(WalFrameReaderTests, GroupsFramesIntoTransactions)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalFrameReaderTests.db-wal";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0);
+    builder.frame(3, 3);
+    builder.frame(2, 3); // a transaction of a single frame
+    builder.frame(4, 0);
+    builder.frame(5, 5);
+    builder.frame(6, 0); // not committed
+
+    wal::MappedFile file(path);
+    WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    ASSERT_EQ(walReader.frameCount(), size_t(6));
+
+    wal::readers::FrameIndex index;
+    index.build(walReader);
+
+    const std::vector<WalFrameReader::Transaction> all = { { 0, 1, 3 }, { 2, 2, 3 }, { 3, 4, 5 } };
+    ASSERT_TRUE(sameTransactions(walReader.transactions(6), all), "the trailing frame isn't in a transaction");
+    ASSERT_TRUE(sameTransactions(index.transactions(6), all), "same transactions from the index");
+    // more frames than the WAL has
+    ASSERT_TRUE(sameTransactions(walReader.transactions(100), all), "frame count past the end");
+    ASSERT_TRUE(sameTransactions(index.transactions(100), all), "frame count past the end of the index");
+
+    // only the frames before frameCount, a commit frame after them ends no transaction
+    const std::vector<WalFrameReader::Transaction> first = { { 0, 1, 3 }, { 2, 2, 3 } };
+    ASSERT_TRUE(sameTransactions(walReader.transactions(4), first), "first 4 frames");
+    ASSERT_TRUE(sameTransactions(index.transactions(4), first), "first 4 frames of the index");
+    ASSERT_TRUE(walReader.transactions(1).empty(), "no commit frame yet");
+    ASSERT_TRUE(index.transactions(1).empty(), "no commit frame in the index yet");
+    ASSERT_TRUE(walReader.transactions(0).empty(), "no frames");
+
+    std::filesystem::remove(path);
+}
+
+TEST(WalFrameReaderTests, WalWithoutCommits)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalFrameReaderTests-uncommitted.db-wal";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0);
+    builder.frame(3, 0);
+
+    wal::MappedFile file(path);
+    WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    wal::readers::FrameIndex index;
+    index.build(walReader);
+    ASSERT_TRUE(walReader.transactions(walReader.frameCount()).empty(), "nothing is committed");
+    ASSERT_TRUE(index.transactions(index.frameCount()).empty(), "nothing is committed in the index");
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,89 @@
+#include "TestBase.h"
+#include <filesystem>
+#include "Utils/MappedFile.h"
+#include "Readers/WalFrameReader.h"
+#include "Readers/FrameIndex.h"
+#include "Readers/WalPageMap.h"
+#include "WalBuilder.h"
+
+TEST(WalPageMapTests, LatestFrameOfRepeatedPages)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalPageMapTests.db-wal";
+    std::filesystem::remove(path);
+
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0);
+    builder.frame(3, 3);
+    builder.frame(2, 0);
+    builder.frame(4, 0);
+    builder.frame(2, 4);
+    builder.frame(3, 4);
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    wal::readers::FrameIndex index;
+    index.build(walReader);
+
+    const std::vector<size_t> frames = { 0, 1, 2, 3, 4, 5 };
+    // from the frame headers and from the index
+    const std::vector<const wal::readers::FrameIndex*> indexes = { nullptr, &index };
+    for (const auto* frameIndex : indexes)
+    {
+        wal::readers::WalPageMap pageMap(walReader, frameIndex);
+        pageMap.build(frames);
+        ASSERT_EQ(pageMap.size(), size_t(3));
+        ASSERT_EQ(pageMap.latestFrame(2).value_or(99), size_t(4));
+        ASSERT_EQ(pageMap.latestFrame(3).value_or(99), size_t(5));
+        ASSERT_EQ(pageMap.latestFrame(4).value_or(99), size_t(3));
+        ASSERT_TRUE(!pageMap.latestFrame(5), "page isn't in the WAL");
+        ASSERT_TRUE(pageMap.latestOnly(frames) == std::vector<size_t>({ 3, 4, 5 }), "latest frames in file order");
+
+        // only up to the first commit
+        pageMap.build({ 0, 1 });
+        ASSERT_EQ(pageMap.latestFrame(2).value_or(99), size_t(0));
+        ASSERT_TRUE(pageMap.latestOnly({ 0, 1 }) == std::vector<size_t>({ 0, 1 }), "every page once");
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(WalPageMapTests, StaleSaltFrames)
+{
+    const auto path = std::filesystem::temp_directory_path() / "wal-parser-WalPageMapTests-stale.db-wal";
+    std::filesystem::remove(path);
+
+    // the WAL was started over by a checkpoint, frames after the new ones are left from before it
+    TestUtils::WalBuilder builder(path);
+    builder.header(1, 2);
+    builder.frame(2, 0);
+    builder.frame(3, 3);
+    builder.staleFrame(2, 0);
+    builder.staleFrame(4, 0);
+    builder.staleFrame(4, 4);
+
+    wal::MappedFile file(path);
+    wal::readers::WalFrameReader walReader(file);
+    ASSERT_TRUE(walReader.readHeader(), "WAL header");
+    wal::readers::FrameIndex index;
+    index.build(walReader);
+
+    const std::vector<size_t> frames = { 0, 1, 2, 3, 4 };
+    // from the frame headers and from the index
+    const std::vector<const wal::readers::FrameIndex*> indexes = { nullptr, &index };
+    for (const auto* frameIndex : indexes)
+    {
+        wal::readers::WalPageMap pageMap(walReader, frameIndex);
+        pageMap.build(frames);
+        ASSERT_EQ(pageMap.size(), size_t(3));
+        // a stale frame is older than every frame with the header's salts
+        ASSERT_EQ(pageMap.latestFrame(2).value_or(99), size_t(0));
+        ASSERT_EQ(pageMap.latestFrame(3).value_or(99), size_t(1));
+        // pages only stale frames hold keep their last one
+        ASSERT_EQ(pageMap.latestFrame(4).value_or(99), size_t(4));
+        ASSERT_TRUE(pageMap.latestOnly(frames) == std::vector<size_t>({ 0, 1, 4 }), "latest frames");
+    }
+
+    std::filesystem::remove(path);
+}
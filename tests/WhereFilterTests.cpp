@@ -0,0 +1,98 @@
+#include "TestBase.h"
+#include "Filters/WhereFilter.h"
+#include "Readers/RecordHeaderReader.h"
+#include <vector>
+#include <string>
+
+using namespace wal::types;
+using wal::filters::WhereFilter;
+
+namespace {
+    const std::vector<std::string> columns = { "id", "name", "val", "f" };
+
+    // id is the rowid alias, stored as null
+    wal::readers::RecordHeaderReader::RecordData row(std::vector<uint8_t> name, std::vector<uint8_t> val, uint64_t rowid)
+    {
+        return {
+            {
+                {RecordSerialTypes::Null, {}},
+                {RecordSerialTypes::String, wal::FixedRuntimeArray<uint8_t>(name)},
+                {RecordSerialTypes::TwoBytesIntBE, wal::FixedRuntimeArray<uint8_t>(val)},
+                {RecordSerialTypes::Null, {}}
+            },
+            rowid
+        };
+    }
+
+    bool parses(const std::string& expression)
+    {
+        try { WhereFilter filter(expression, columns, 0); }
+        catch (const WhereFilter::ParseException&) { return false; }
+        return true;
+    }
+}
+
+TEST(WhereFilterTests, Comparisons)
+{
+    auto abc = row({'a', 'b', 'c', 'd'}, {0x01, 0x2c}, 7); // val 300
+    auto neg = row({'x', 'y'}, {0xff, 0xfe}, 9);           // val -2
+
+    ASSERT_TRUE(WhereFilter("val > 100", columns, 0).matches(abc), "300 > 100");
+    ASSERT_TRUE(!WhereFilter("val > 100", columns, 0).matches(neg), "integers are signed");
+    ASSERT_TRUE(WhereFilter("val = -2", columns, 0).matches(neg), "negative literal");
+    ASSERT_TRUE(WhereFilter("100 < val", columns, 0).matches(abc), "literal on the left");
+    ASSERT_TRUE(WhereFilter("val = '300'", columns, 0).matches(abc), "numeric text literal compared as a number");
+    ASSERT_TRUE(WhereFilter("name LIKE 'AB%'", columns, 0).matches(abc), "like ignores case");
+    ASSERT_TRUE(WhereFilter("name NOT LIKE 'a_c'", columns, 0).matches(abc), "_ matches a single character");
+    ASSERT_TRUE(WhereFilter("id = 7 AND name >= 'abc'", columns, 0).matches(abc), "the rowid alias column is the rowid");
+    ASSERT_TRUE(WhereFilter("rowid = 9 or (val > 100 and name = 'zz')", columns, 0).matches(neg), "rowid name and precedence");
+}
+
+TEST(WhereFilterTests, NullsAndColumns)
+{
+    auto abc = row({'a'}, {0x00, 0x01}, 1);
+
+    ASSERT_TRUE(WhereFilter("f IS NULL", columns, 0).matches(abc), "null column");
+    ASSERT_TRUE(!WhereFilter("f > 1", columns, 0).matches(abc), "comparing null is never true");
+    ASSERT_TRUE(!WhereFilter("NOT f > 1", columns, 0).matches(abc), "not null is still null");
+    ASSERT_TRUE(WhereFilter("f > 1 OR val = 1", columns, 0).matches(abc), "null or true");
+
+    WhereFilter filter("val > 1 AND (name = 'a' OR val < 0) AND id > 0", columns, 0);
+    ASSERT_EQ(filter.columns().size(), size_t(2));
+    ASSERT_EQ(filter.columns()[0], size_t(2));
+    ASSERT_EQ(filter.columns()[1], size_t(1));
+}
+
+TEST(WhereFilterTests, ColumnTypes)
+{
+    // every integer size is sign extended, reals are compared with integers, short columns are null
+    const std::vector<std::string> numbers = { "i3", "i6", "one", "r", "short" };
+    wal::readers::RecordHeaderReader::RecordData record = {
+        {
+            {RecordSerialTypes::ThreeBytesIntBE, {0xff, 0xff, 0xfd}},
+            {RecordSerialTypes::SixBytesIntBE, {0x00, 0x01, 0x00, 0x00, 0x00, 0x00}},
+            {RecordSerialTypes::One, {}},
+            {RecordSerialTypes::FloatBE, {0x40, 0x09, 0x21, 0xf9, 0xf0, 0x1b, 0x86, 0x6e}},
+            {RecordSerialTypes::FourBytesIntBE, {0x00, 0x01}}
+        },
+        1
+    };
+
+    ASSERT_TRUE(WhereFilter("i3 = -3", numbers).matches(record), "3 bytes negative integer");
+    ASSERT_TRUE(WhereFilter("i6 = 4294967296", numbers).matches(record), "6 bytes integer");
+    ASSERT_TRUE(WhereFilter("one = 1", numbers).matches(record), "constant 1");
+    ASSERT_TRUE(WhereFilter("r > 3 AND r < 3.2", numbers).matches(record), "real column");
+    ASSERT_TRUE(WhereFilter("short IS NULL", numbers).matches(record), "truncated integer is null");
+}
+
+TEST(WhereFilterTests, MalformedExpressions)
+{
+    ASSERT_TRUE(parses("\"name\" = 'it''s'"), "quoted name and escaped quote");
+    ASSERT_TRUE(!parses(""), "empty expression");
+    ASSERT_TRUE(!parses("missing = 1"), "unknown column");
+    ASSERT_TRUE(!parses("val >"), "missing literal");
+    ASSERT_TRUE(!parses("val = NULL"), "comparing with NULL");
+    ASSERT_TRUE(!parses("(val = 1"), "unbalanced parentheses");
+    ASSERT_TRUE(!parses("name = 'abc"), "unterminated string");
+    ASSERT_TRUE(!parses("val = 1 val = 2"), "trailing tokens");
+}